@@ -47,6 +47,11 @@
 
 ads1293 ADS1293(DRDY_PIN, CS_PIN);
 
+// Frames are read in the DRDY interrupt and queued here until loop() prints
+// them, so slow serial output does not cause dropped samples.
+ADS1293::Samples ring[16];
+ADS1293::Samples frames[16];
+
 void setup()
 {
 	Serial.begin(115200);
@@ -75,22 +80,21 @@ void setup()
 	ADS1293.configureChannelConfig(ChannelConfig::Default3Lead);
 	ADS1293.applyGlobalConfig(GlobalConfig::Start);
 
-	delay(10);
+	ADS1293.startAcquisition(ring, 16);
 }
 
 void loop()
 {
-	if (digitalRead(DRDY_PIN) == LOW)
+	size_t n = ADS1293.readFrames(frames, 16);
+	for (size_t i = 0; i < n; ++i)
 	{
-		auto samples = ADS1293.getECGData();
-		if (samples.ok)
+		if (frames[i].ok)
 		{
-			Serial.print(samples.ch1);
+			Serial.print(frames[i].ch1);
 			Serial.print(',');
-			Serial.print(samples.ch2);
+			Serial.print(frames[i].ch2);
 			Serial.print(',');
-			Serial.println(samples.ch3);
+			Serial.println(frames[i].ch3);
 		}
 	}
-	delay(10);
 }
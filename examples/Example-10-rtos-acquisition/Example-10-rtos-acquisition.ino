@@ -0,0 +1,164 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Protocentral ADS1293 Arduino example — acquisition task on a dedicated core
+//
+//  Author: Ashwin Whitchurch, Protocentral Electronics
+//  SPDX-FileCopyrightText: 2025 Protocentral Electronics
+//  SPDX-License-Identifier: MIT
+//
+//  ESP32: acquires 3-lead ECG at 1600 SPS in a high-priority task pinned to
+//  core 1 (see protocentral_ads1293_task.h). A consumer task on core 0,
+//  where WiFi/BLE would run, drains the queue in blocks and streams the
+//  frames in the compact binary format of Example 5. Once a second it also
+//  prints the queue statistics as text, which the Example 5 decoder skips:
+//
+//    stats,<acquired>,<dropped>,<queue high-water>/<depth>,<stack free>
+//
+//  A high-water mark close to the depth means the consumer stalls for
+//  nearly as long as the queue can cover; make the ring deeper.
+//
+//  On boards without a task backend (e.g. AVR) start() fails and the sketch
+//  says so.
+//
+//  Hardware connections (ESP32 VSPI):
+//
+//  | Signal | ESP32 (VSPI default) |
+//  |-------:|:--------------------:|
+//  | MISO   | 19                   |
+//  | MOSI   | 23                   |
+//  | SCLK   | 18                   |
+//  | CS     | 4                    |
+//  | VCC    | +5V                  |
+//  | GND    | GND                  |
+//  | DRDY   | 2                    |
+//
+//  For full documentation and examples, see:
+//    https://github.com/Protocentral/protocentral-ads1293-arduino
+//
+/////////////////////////////////////////////////////////////////////////////////////////
+
+#include "protocentral_ads1293.h"
+#include "protocentral_ads1293_profile.h"
+#include "protocentral_ads1293_stream.h"
+#include "protocentral_ads1293_task.h"
+#include <SPI.h>
+
+#define DRDY_PIN 2
+#define CS_PIN 4
+
+#if defined(__AVR__)
+#define RING_DEPTH 16
+#else
+#define RING_DEPTH 256 // 160 ms at 1600 SPS
+#endif
+
+#define FRAMES_PER_PACKET 8
+
+// Optional SPI pin overrides
+#if !defined(SCK_PIN)
+#if defined(ARDUINO_ARCH_ESP32)
+#define SCK_PIN 18
+#define MISO_PIN 19
+#define MOSI_PIN 23
+#else
+#define SCK_PIN 13
+#define MISO_PIN 12
+#define MOSI_PIN 11
+#endif
+#endif
+
+ads1293 ADS1293(DRDY_PIN, CS_PIN);
+
+// The routing of begin3LeadECG() at 1600 SPS: R1 = R2 = 4, R3 = 4,
+// 102.4 kHz / 64 = 1600 SPS. START_CON locks the rate registers, so the
+// rate is part of the configuration rather than set after it.
+typedef ADS1293Profile<
+	ADS1293FlexChannel<1, 2, 1>,
+	ADS1293FlexChannel<2, 3, 1>,
+	ADS1293CommonModeDetect<0x07>,
+	ADS1293RightLegDrive<4>,
+	ADS1293Oscillator<>,
+	ADS1293AfeChannels<0x03>,
+	ADS1293DecimationR2<4>,
+	ADS1293DecimationR3<1, 4>,
+	ADS1293DecimationR3<2, 4>,
+	ADS1293DataReadySource<DRDYSource::Ch1Ecg>,
+	ADS1293LoopReadback<0x03>,
+	ADS1293Start<>>
+	ThreeLead1600;
+ADS1293AcquisitionTask acquisition;
+ADS1293::Samples ring[RING_DEPTH];
+uint8_t packet[ADS1293StreamEncoder::packetSize(FRAMES_PER_PACKET, 3)];
+ADS1293StreamEncoder encoder(Serial, packet, sizeof(packet), 0x07);
+
+ADS1293::Samples frames[32];
+uint32_t reportedDrops = 0;
+uint32_t lastStatsMs = 0;
+bool started = false;
+
+void printStats() {
+	Serial.print(F("stats,"));
+	Serial.print(acquisition.framesAcquired());
+	Serial.print(',');
+	Serial.print(acquisition.framesDropped());
+	Serial.print(',');
+	Serial.print(acquisition.queueHighWater());
+	Serial.print('/');
+	Serial.print(RING_DEPTH);
+	Serial.print(',');
+	Serial.println(acquisition.stackHighWater());
+}
+
+// Drain what is queued, waiting up to `timeoutMs` for the first frame. All
+// serial output comes from here, so packets and text never interleave.
+void consume(uint32_t timeoutMs) {
+	const size_t n = acquisition.read(frames, 32, timeoutMs);
+	encoder.add(frames, n);
+
+	// Dropped frames become a sequence gap.
+	const uint32_t dropped = acquisition.framesDropped();
+	if (dropped != reportedDrops) {
+		encoder.skipFrames(static_cast<uint16_t>(dropped - reportedDrops));
+		reportedDrops = dropped;
+	}
+	if (millis() - lastStatsMs >= 1000) {
+		lastStatsMs = millis();
+		printStats();
+	}
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+void consumerTask(void *) {
+	for (;;)
+		consume(100);
+}
+#endif
+
+void setup() {
+	Serial.begin(921600);
+#if defined(ARDUINO_ARCH_ESP32)
+	ADS1293.begin(SCK_PIN, MISO_PIN, MOSI_PIN);
+#else
+	ADS1293.begin();
+#endif
+	ADS1293.applyProfile<ThreeLead1600>();
+
+	ADS1293AcquisitionTask::Config cfg;
+	cfg.core = 1;
+	started = acquisition.start(ADS1293, ring, RING_DEPTH, cfg);
+	if (!started) {
+		Serial.println(F("acquisition task not available on this board"));
+		return;
+	}
+#if defined(ARDUINO_ARCH_ESP32)
+	xTaskCreatePinnedToCore(consumerTask, "consumer", 4096, nullptr, 5, nullptr, 0);
+#endif
+}
+
+void loop() {
+#if !defined(ARDUINO_ARCH_ESP32)
+	// Without a consumer task, consume here.
+	if (started)
+		consume(10);
+#endif
+}
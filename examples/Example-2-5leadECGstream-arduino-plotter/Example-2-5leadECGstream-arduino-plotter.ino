@@ -26,6 +26,7 @@
 /////////////////////////////////////////////////////////////////////////////////////////
 
 #include "protocentral_ads1293.h"
+#include "protocentral_ads1293_profile.h"
 #include <SPI.h>
 
 #define DRDY_PIN 2
@@ -46,6 +47,29 @@
 
 ads1293 ADS1293(DRDY_PIN, CS_PIN);
 
+// Datasheet 5-lead routing (CH1 = IN2 - IN1, CH2 = IN3 - IN1, CH3 = IN5 -
+// IN6 against the Wilson terminal, RLD on IN4), slowed to 100 SPS for the
+// plotter: 102400 / (R1 4 * R2 4 * R3 64).
+typedef ADS1293Profile<
+	ADS1293FlexChannel<1, 2, 1>,
+	ADS1293FlexChannel<2, 3, 1>,
+	ADS1293FlexChannel<3, 5, 6>,
+	ADS1293CommonModeDetect<0x07>,
+	ADS1293RightLegDrive<4>,
+	ADS1293Set<Register::WILSON_EN1, 0x01>,
+	ADS1293Set<Register::WILSON_EN2, 0x02>,
+	ADS1293Set<Register::WILSON_EN3, 0x03>,
+	ADS1293Set<Register::WILSON_CN, 0x01>,
+	ADS1293Oscillator<>,
+	ADS1293DecimationR2<4>,
+	ADS1293DecimationR3<1, 64>,
+	ADS1293DecimationR3<2, 64>,
+	ADS1293DecimationR3<3, 64>,
+	ADS1293DataReadySource<DRDYSource::Ch1Ecg>,
+	ADS1293LoopReadback<0x07>,
+	ADS1293Start<>>
+	FiveLead100Sps;
+
 void setup()
 {
 	Serial.begin(115200);
@@ -55,24 +79,10 @@ void setup()
 	ADS1293.begin();
 #endif
 
-	// Configure device for 5-lead ECG
-	ADS1293.configureChannel1(FlexCh1Mode::Default);
-	ADS1293.configureChannel2(FlexCh2Mode::Default);
-	ADS1293.configureChannel3(FlexCh3Mode::Default);
-	ADS1293.enableCommonModeDetection(CMDetMode::Enabled);
-	ADS1293.configureRLD(RLDMode::Default);
-	ADS1293.configureRef(RefMode::Default);
-	ADS1293.configureAFEShutdown(AFEShutdownMode::AFE_On);
-
-	ADS1293.setChannelGain(1, ADS1293::PgaGain::G8);
-	ADS1293.setChannelGain(2, ADS1293::PgaGain::G8);
-	ADS1293.setChannelGain(3, ADS1293::PgaGain::G8);
-
-	ADS1293.setSamplingRate(ADS1293::SamplingRate::SPS_100);
-	ADS1293.configureDRDYSource(DRDYSource::Default);
-	ADS1293.configureChannelConfig(ChannelConfig::Default5Lead);
-	ADS1293.applyGlobalConfig(GlobalConfig::Start);
-	delay(10);
+	// Configure device for 5-lead ECG at 100 SPS in three SPI bursts. The
+	// register image is built and checked at compile time and kept in flash.
+	// startup() returns once the first settled frame is ready.
+	ADS1293.startup<FiveLead100Sps>();
 }
 
 void loop()
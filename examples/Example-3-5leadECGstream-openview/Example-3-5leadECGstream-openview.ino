@@ -96,18 +96,13 @@ void sendDataThroughUart(int32_t ecgCh1, int32_t ecgCh2, int32_t ecgCh3) {
 	}
 }
 
-// Helper: convert 24-bit unsigned raw value to signed 32-bit using two's-complement
-static int32_t raw24_to_int24(uint32_t raw24) {
-	raw24 &= 0xFFFFFFu;
-	if (raw24 & 0x800000u) {
-		return static_cast<int32_t>(raw24 | 0xFF000000u);
-	}
-	return static_cast<int32_t>(raw24);
-}
+// Latest frame published by the DRDY interrupt. The library double-buffers
+// raw frames, so loop() can encode this one in place while the next frame is
+// being clocked in.
+const uint8_t *volatile latestFrame = nullptr;
 
-// Helper: build a 24-bit raw value from three bytes (MSB, mid, LSB)
-static uint32_t raw24_from_bytes(uint8_t msb, uint8_t mid, uint8_t lsb) {
-	return (static_cast<uint32_t>(msb) << 16) | (static_cast<uint32_t>(mid) << 8) | static_cast<uint32_t>(lsb);
+void onFrame(const uint8_t *frame, void *) {
+	latestFrame = frame;
 }
 
 // Uncomment to enable debug register/sample dumps on startup
@@ -137,29 +132,29 @@ void setup() {
 	ADS1293.configureDRDYSource(DRDYSource::Default);
 	ADS1293.configureChannelConfig(ChannelConfig::Default5Lead);
 	ADS1293.applyGlobalConfig(GlobalConfig::Start);
-	delay(10);
 
 #if defined(ENABLE_DEBUG)
 	ADS1293.dumpDebug(Serial);
 #endif
+
+	ADS1293.onFrameReady(onFrame);
+	ADS1293.startAcquisition(nullptr, 0);
 }
 
 void loop() {
-	if (digitalRead(DRDY_PIN) == LOW) {
-		// Use convenience overload to get all three channels in one call
-		auto samples = ADS1293.getECGData();
-		if (samples.ok) {
-				// Read raw 24-bit values from the device, sign-extend to int32_t,
-				// and send as 32-bit little-endian (LSB first) in the packet payload.
-				uint32_t raw1 = 0, raw2 = 0, raw3 = 0;
-				if (ADS1293.getRaw24(1, raw1) && ADS1293.getRaw24(2, raw2) && ADS1293.getRaw24(3, raw3)) {
-					int32_t s1 = raw24_to_int24(raw1);
-					int32_t s2 = raw24_to_int24(raw2);
-					int32_t s3 = raw24_to_int24(raw3);
-					sendDataThroughUart(s1, s2, s3);
-				}
-		}
+#if defined(ARDUINO_ARCH_ESP32)
+	// ESP32 reads frames outside the interrupt; this services pending DRDY edges.
+	ADS1293.readFrames(nullptr, 0);
+#endif
+	noInterrupts();
+	const uint8_t *frame = latestFrame;
+	latestFrame = nullptr;
+	interrupts();
+
+	if (frame) {
+		// Send sign-extended samples as 32-bit little-endian (LSB first).
+		int32_t s1, s2, s3;
+		ADS1293::decodeFrame(frame, s1, s2, s3);
+		sendDataThroughUart(s1, s2, s3);
 	}
-	delay(10);
 }
-
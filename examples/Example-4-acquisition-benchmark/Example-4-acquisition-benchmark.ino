@@ -0,0 +1,174 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Protocentral ADS1293 Arduino example — acquisition hot-path benchmark
+//
+//  Author: Ashwin Whitchurch, Protocentral Electronics
+//  SPDX-FileCopyrightText: 2025 Protocentral Electronics
+//  SPDX-License-Identifier: MIT
+//
+//  Times each stage of the per-frame acquisition path on the target and
+//  prints one CSV line per stage, so results can be collected by a script
+//  and compared across library versions or boards:
+//
+//    stage,iterations,ns_per_frame,max_sps
+//
+//  Stages:
+//    read     getECGData(): one 9-byte SPI frame read at the configured clock
+//    decode   decodeFrame(): 3 x 24-bit assembly and sign extension
+//    convert  rawToVoltage() on all three channels
+//    microvolts  toMicrovolts() on all three channels (fixed point; an
+//             alternative to convert, not part of total)
+//    encode   OpenView packet encode (as in Example 3) into a RAM buffer
+//    total    read + decode + convert + encode
+//
+//  max_sps is the frame rate a single stage could sustain if it had the CPU
+//  to itself; compare it against the configured sampling rate (e.g. 1600).
+//
+//  Hardware connections (Arduino UNO / ESP32 VSPI):
+//
+//  | Signal | Arduino UNO | ESP32 (VSPI default) |
+//  |-------:|:-----------:|:--------------------:|
+//  | MISO   | 12          | 19                   |
+//  | MOSI   | 11          | 23                   |
+//  | SCLK   | 13          | 18                   |
+//  | CS     | 4           | 4                    |
+//  | VCC    | +5V         | +5V                  |
+//  | GND    | GND         | GND                  |
+//  | DRDY   | 2           | 2                    |
+//
+//  For full documentation and examples, see:
+//    https://github.com/Protocentral/protocentral-ads1293-arduino
+//
+/////////////////////////////////////////////////////////////////////////////////////////
+
+#include "protocentral_ads1293.h"
+#include <SPI.h>
+
+#define DRDY_PIN 2
+#define CS_PIN 4
+
+// SPI clock used for the read stage. The ADS1293 accepts up to 20 MHz.
+#define BENCH_SPI_CLOCK 4000000
+
+#define ITERATIONS 1000
+
+// Optional SPI pin overrides
+#if !defined(SCK_PIN)
+#if defined(ARDUINO_ARCH_ESP32)
+#define SCK_PIN 18
+#define MISO_PIN 19
+#define MOSI_PIN 23
+#else
+#define SCK_PIN 13
+#define MISO_PIN 12
+#define MOSI_PIN 11
+#endif
+#endif
+
+ads1293 ADS1293(DRDY_PIN, CS_PIN, &SPI, BENCH_SPI_CLOCK);
+
+// Sinks keep the compiler from optimizing the measured work away.
+volatile int32_t sinkI;
+volatile float sinkF;
+volatile uint8_t sinkB;
+
+uint8_t packet[19];
+
+static void encodeOpenView(uint8_t *out, int32_t c1, int32_t c2, int32_t c3) {
+	const int32_t ch[3] = {c1, c2, c3};
+	out[0] = 0x0A;
+	out[1] = 0xFA;
+	out[2] = 12;
+	out[3] = 0;
+	out[4] = 0x02;
+	for (int c = 0; c < 3; ++c) {
+		for (int b = 0; b < 4; ++b) {
+			out[5 + c * 4 + b] = static_cast<uint8_t>((ch[c] >> (8 * b)) & 0xFF);
+		}
+	}
+	out[17] = 0;
+	out[18] = 0x0B;
+}
+
+static void report(const char *stage, uint32_t elapsedUs) {
+	uint32_t ns = static_cast<uint32_t>((static_cast<uint64_t>(elapsedUs) * 1000u) / ITERATIONS);
+	uint32_t maxSps = ns ? static_cast<uint32_t>(1000000000ull / ns) : 0;
+	Serial.print(stage);
+	Serial.print(',');
+	Serial.print(ITERATIONS);
+	Serial.print(',');
+	Serial.print(ns);
+	Serial.print(',');
+	Serial.println(maxSps);
+}
+
+void runBenchmark() {
+	uint8_t raw[ADS1293::FRAME_BYTES] = {0x12, 0x34, 0x56, 0xFE, 0xDC, 0xBA, 0x80, 0x00, 0x01};
+	int32_t a = 0, b = 0, c = 0;
+	uint32_t t0, tRead, tDecode, tConvert, tMicrovolts, tEncode;
+
+	t0 = micros();
+	for (int i = 0; i < ITERATIONS; ++i) {
+		ADS1293.getECGData(a, b, c);
+		sinkI = a;
+	}
+	tRead = micros() - t0;
+
+	t0 = micros();
+	for (int i = 0; i < ITERATIONS; ++i) {
+		raw[8] = static_cast<uint8_t>(i);
+		ADS1293::decodeFrame(raw, a, b, c);
+		sinkI = a + b + c;
+	}
+	tDecode = micros() - t0;
+
+	t0 = micros();
+	for (int i = 0; i < ITERATIONS; ++i) {
+		sinkF = ADS1293::rawToVoltage(a + i) + ADS1293::rawToVoltage(b) + ADS1293::rawToVoltage(c);
+	}
+	tConvert = micros() - t0;
+
+	t0 = micros();
+	for (int i = 0; i < ITERATIONS; ++i) {
+		sinkI = ADS1293.toMicrovolts(1, a + i) + ADS1293.toMicrovolts(2, b) + ADS1293.toMicrovolts(3, c);
+	}
+	tMicrovolts = micros() - t0;
+
+	t0 = micros();
+	for (int i = 0; i < ITERATIONS; ++i) {
+		encodeOpenView(packet, a + i, b, c);
+		sinkB = packet[5];
+	}
+	tEncode = micros() - t0;
+
+	Serial.println(F("stage,iterations,ns_per_frame,max_sps"));
+	report("read", tRead);
+	report("decode", tDecode);
+	report("convert", tConvert);
+	report("microvolts", tMicrovolts);
+	report("encode", tEncode);
+	report("total", tRead + tDecode + tConvert + tEncode);
+	Serial.print(F("bus_ns_per_frame,"));
+	Serial.println(ADS1293.measureFrameBusTime());
+}
+
+void setup() {
+	Serial.begin(115200);
+#if defined(ARDUINO_ARCH_ESP32)
+	ADS1293.begin(SCK_PIN, MISO_PIN, MOSI_PIN);
+#else
+	ADS1293.begin();
+#endif
+	ADS1293.begin3LeadECG();
+	runBenchmark();
+}
+
+void loop() {
+	// Re-run when any character is received on the serial port.
+	if (Serial.available()) {
+		while (Serial.available()) {
+			Serial.read();
+		}
+		runBenchmark();
+	}
+}
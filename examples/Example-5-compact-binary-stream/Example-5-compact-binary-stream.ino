@@ -0,0 +1,101 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Protocentral ADS1293 Arduino example — compact binary stream
+//
+//  Author: Ashwin Whitchurch, Protocentral Electronics
+//  SPDX-FileCopyrightText: 2025 Protocentral Electronics
+//  SPDX-License-Identifier: MIT
+//
+//  Streams 5-lead ECG at 400 SPS using the library's compact packet format
+//  (see protocentral_ads1293_stream.h): 16 frames per packet with 24-bit
+//  samples, a frame sequence counter and a CRC-16, written with one
+//  Serial.write() per packet. This needs about 3.8 kB/s, which fits a
+//  115200-baud link with room to spare. Frames dropped on the device side
+//  show up as sequence gaps in ADS1293StreamDecoder::framesLost().
+//
+//  Hardware connections (Arduino UNO / ESP32 VSPI):
+//
+//  | Signal | Arduino UNO | ESP32 (VSPI default) |
+//  |-------:|:-----------:|:--------------------:|
+//  | MISO   | 12          | 19                   |
+//  | MOSI   | 11          | 23                   |
+//  | SCLK   | 13          | 18                   |
+//  | CS     | 4           | 4                    |
+//  | VCC    | +5V         | +5V                  |
+//  | GND    | GND         | GND                  |
+//  | DRDY   | 2           | 2                    |
+//
+//  For full documentation and examples, see:
+//    https://github.com/Protocentral/protocentral-ads1293-arduino
+//
+/////////////////////////////////////////////////////////////////////////////////////////
+
+#include "protocentral_ads1293.h"
+#include "protocentral_ads1293_stream.h"
+#include <SPI.h>
+
+#define DRDY_PIN 2
+#define CS_PIN 4
+
+#define FRAMES_PER_PACKET 16
+
+// Optional SPI pin overrides
+#if !defined(SCK_PIN)
+#if defined(ARDUINO_ARCH_ESP32)
+#define SCK_PIN 18
+#define MISO_PIN 19
+#define MOSI_PIN 23
+#else
+#define SCK_PIN 13
+#define MISO_PIN 12
+#define MOSI_PIN 11
+#endif
+#endif
+
+ads1293 ADS1293(DRDY_PIN, CS_PIN);
+
+ADS1293::Samples ring[32];
+ADS1293::Samples frames[16];
+
+uint8_t packet[ADS1293StreamEncoder::packetSize(FRAMES_PER_PACKET, 3)];
+ADS1293StreamEncoder encoder(Serial, packet, sizeof(packet), 0x07);
+uint32_t reportedOverruns = 0;
+
+void setup()
+{
+	Serial.begin(115200);
+#if defined(ARDUINO_ARCH_ESP32)
+	ADS1293.begin(SCK_PIN, MISO_PIN, MOSI_PIN);
+#else
+	ADS1293.begin();
+#endif
+
+	// Configure device for 5-lead ECG
+	ADS1293.configureChannel1(FlexCh1Mode::Default);
+	ADS1293.configureChannel2(FlexCh2Mode::Default);
+	ADS1293.configureChannel3(FlexCh3Mode::Default);
+	ADS1293.enableCommonModeDetection(CMDetMode::Enabled);
+	ADS1293.configureRLD(RLDMode::Default);
+	ADS1293.configureRef(RefMode::Default);
+	ADS1293.configureAFEShutdown(AFEShutdownMode::AFE_On);
+	ADS1293.setSamplingRate(ADS1293::SamplingRate::SPS_400);
+	ADS1293.configureDRDYSource(DRDYSource::Default);
+	ADS1293.configureChannelConfig(ChannelConfig::Default5Lead);
+	ADS1293.applyGlobalConfig(GlobalConfig::Start);
+
+	ADS1293.startAcquisition(ring, 32);
+}
+
+void loop()
+{
+	size_t n = ADS1293.readFrames(frames, 16);
+	encoder.add(frames, n);
+
+	// Frames dropped because the ring filled up become a sequence gap.
+	uint32_t overruns = ADS1293.overrunCount();
+	if (overruns != reportedOverruns)
+	{
+		encoder.skipFrames(static_cast<uint16_t>(overruns - reportedOverruns));
+		reportedOverruns = overruns;
+	}
+}
@@ -0,0 +1,244 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Protocentral ADS1293 Arduino example — on-device QRS detection and heart rate
+//
+//  Author: Ashwin Whitchurch, Protocentral Electronics
+//  SPDX-FileCopyrightText: 2025 Protocentral Electronics
+//  SPDX-License-Identifier: MIT
+//
+//  Runs the integer Pan-Tompkins detector (ADS1293QrsDetector) on lead I at
+//  1600 SPS and prints one line per beat instead of the raw waveform:
+//
+//    beat,<sample index>,<RR ms>,<HR bpm>,<averaged HR bpm>
+//
+//  At start-up, and whenever a character is received, a self-test feeds the
+//  detector a synthetic ECG with known R-peak positions (varying RR, baseline
+//  wander and noise) and prints accuracy and cost:
+//
+//    selftest,beats,detected,false_positives,missed,ns_per_sample
+//
+//  Hardware connections (Arduino UNO / ESP32 VSPI):
+//
+//  | Signal | Arduino UNO | ESP32 (VSPI default) |
+//  |-------:|:-----------:|:--------------------:|
+//  | MISO   | 12          | 19                   |
+//  | MOSI   | 11          | 23                   |
+//  | SCLK   | 13          | 18                   |
+//  | CS     | 4           | 4                    |
+//  | VCC    | +5V         | +5V                  |
+//  | GND    | GND         | GND                  |
+//  | DRDY   | 2           | 2                    |
+//
+//  For full documentation and examples, see:
+//    https://github.com/Protocentral/protocentral-ads1293-arduino
+//
+/////////////////////////////////////////////////////////////////////////////////////////
+
+#include "protocentral_ads1293.h"
+#include "protocentral_ads1293_profile.h"
+#include "protocentral_ads1293_qrs.h"
+#include <SPI.h>
+
+#define DRDY_PIN 2
+#define CS_PIN 4
+
+#define SAMPLE_RATE_HZ 1600
+#define SELFTEST_SECONDS 20
+
+// Optional SPI pin overrides
+#if !defined(SCK_PIN)
+#if defined(ARDUINO_ARCH_ESP32)
+#define SCK_PIN 18
+#define MISO_PIN 19
+#define MOSI_PIN 23
+#else
+#define SCK_PIN 13
+#define MISO_PIN 12
+#define MOSI_PIN 11
+#endif
+#endif
+
+ads1293 ADS1293(DRDY_PIN, CS_PIN);
+
+// The routing of begin3LeadECG() at SAMPLE_RATE_HZ: R1 = R2 = R3 = 4,
+// 102.4 kHz / 64 = 1600 SPS. START_CON locks the rate registers, so the
+// rate is part of the configuration rather than set after it.
+typedef ADS1293Profile<
+	ADS1293FlexChannel<1, 2, 1>,
+	ADS1293FlexChannel<2, 3, 1>,
+	ADS1293CommonModeDetect<0x07>,
+	ADS1293RightLegDrive<4>,
+	ADS1293Oscillator<>,
+	ADS1293AfeChannels<0x03>,
+	ADS1293DecimationR2<4>,
+	ADS1293DecimationR3<1, 4>,
+	ADS1293DecimationR3<2, 4>,
+	ADS1293DataReadySource<DRDYSource::Ch1Ecg>,
+	ADS1293LoopReadback<0x03>,
+	ADS1293Start<>>
+	ThreeLead1600;
+ADS1293QrsDetector detector;
+
+ADS1293::Samples ring[32];
+ADS1293::Samples frames[32];
+
+// ---------------------------------------------------------------------------
+// Synthetic ECG: triangular QRS and T waves on a wandering baseline, in ADC
+// codes (about 20000 codes per mV), generated with integer arithmetic only.
+
+const uint16_t rrPatternMs[] = {800, 760, 700, 640, 600, 640, 700, 780, 1000, 900};
+
+struct Synth {
+	uint32_t n = 0;
+	uint32_t lastBeat = 0;
+	uint32_t nextBeat = SAMPLE_RATE_HZ / 2;
+	uint8_t rrIndex = 0;
+	uint32_t rng = 12345;
+};
+
+static int32_t triangle(int32_t dist, int32_t halfWidth, int32_t peak) {
+	if (dist < 0)
+		dist = -dist;
+	return dist >= halfWidth ? 0 : peak - peak * dist / halfWidth;
+}
+
+// Returns the next sample; sets `beat` when this sample is an R peak.
+static int32_t synthSample(Synth &s, bool &beat) {
+	const int32_t ms = SAMPLE_RATE_HZ / 1000;
+	beat = s.n == s.nextBeat;
+	if (beat) {
+		s.lastBeat = s.n;
+		s.nextBeat = s.n + static_cast<uint32_t>(rrPatternMs[s.rrIndex]) * ms;
+		s.rrIndex = (s.rrIndex + 1) % (sizeof(rrPatternMs) / sizeof(rrPatternMs[0]));
+	}
+	const int32_t sinceLast = static_cast<int32_t>(s.n - s.lastBeat);
+	const int32_t toNext = static_cast<int32_t>(s.nextBeat - s.n);
+
+	int32_t v = 0;
+	v += triangle(sinceLast, 20 * ms, 20000) + triangle(toNext, 20 * ms, 20000); // R, 1 mV
+	v += triangle(sinceLast - 30 * ms, 15 * ms, -5000);                         // S
+	v += triangle(sinceLast - 280 * ms, 80 * ms, 7000);                         // T
+	v += triangle(toNext - 160 * ms, 40 * ms, 3000);                            // P
+	// 0.33 Hz baseline wander, +-0.5 mV
+	const int32_t period = 3 * SAMPLE_RATE_HZ;
+	v += triangle(static_cast<int32_t>(s.n % period) - period / 2, period / 2, 20000) - 10000;
+	// +-0.05 mV noise (xorshift32)
+	s.rng ^= s.rng << 13;
+	s.rng ^= s.rng >> 17;
+	s.rng ^= s.rng << 5;
+	v += static_cast<int32_t>(s.rng % 2001) - 1000;
+	++s.n;
+	return v + 300000; // electrode offset
+}
+
+void runSelfTest() {
+	const uint32_t total = static_cast<uint32_t>(SELFTEST_SECONDS) * SAMPLE_RATE_HZ;
+	const uint32_t tolerance = 50u * SAMPLE_RATE_HZ / 1000u; // 50 ms
+	const uint32_t learn = 2500u * SAMPLE_RATE_HZ / 1000u;   // learning + filter delay
+
+	// Pass 1: generator alone, to subtract its cost from the timing.
+	Synth gen;
+	volatile int32_t sink = 0;
+	bool beat;
+	uint32_t t0 = micros();
+	for (uint32_t i = 0; i < total; ++i)
+		sink = synthSample(gen, beat);
+	const uint32_t genUs = micros() - t0;
+	(void)sink;
+
+	// Pass 2: generator + detector, matching detections against the truth.
+	Synth s;
+	uint32_t truth[8] = {};
+	bool matched[8] = {};
+	uint8_t head = 0;
+	uint32_t beats = 0, detected = 0, falsePositives = 0, missed = 0;
+	detector.configure(static_cast<float>(SAMPLE_RATE_HZ));
+	t0 = micros();
+	for (uint32_t i = 0; i < total; ++i) {
+		const int32_t x = synthSample(s, beat);
+		if (beat) {
+			if (truth[head] >= learn && !matched[head])
+				++missed;
+			truth[head] = i;
+			matched[head] = false;
+			head = (head + 1) & 7;
+			if (i >= learn)
+				++beats;
+		}
+		ADS1293QrsDetector::Beat b;
+		if (detector.process(x, &b)) {
+			bool hit = false;
+			for (uint8_t k = 0; k < 8; ++k) {
+				const uint32_t d = b.sample > truth[k] ? b.sample - truth[k] : truth[k] - b.sample;
+				if (!matched[k] && truth[k] >= learn && d <= tolerance) {
+					matched[k] = hit = true;
+					break;
+				}
+			}
+			if (hit)
+				++detected;
+			else if (b.sample >= learn)
+				++falsePositives;
+		}
+	}
+	const uint32_t bothUs = micros() - t0;
+	const uint32_t detUs = bothUs > genUs ? bothUs - genUs : 0;
+
+	Serial.println(F("selftest,beats,detected,false_positives,missed,ns_per_sample"));
+	Serial.print(F("selftest,"));
+	Serial.print(beats);
+	Serial.print(',');
+	Serial.print(detected);
+	Serial.print(',');
+	Serial.print(falsePositives);
+	Serial.print(',');
+	Serial.print(missed);
+	Serial.print(',');
+	Serial.println(static_cast<uint32_t>(static_cast<uint64_t>(detUs) * 1000u / total));
+
+	detector.configure(static_cast<float>(SAMPLE_RATE_HZ));
+}
+
+// ---------------------------------------------------------------------------
+
+void printBeat(const ADS1293QrsDetector::Beat &beat, void *) {
+	Serial.print(F("beat,"));
+	Serial.print(beat.sample);
+	Serial.print(',');
+	Serial.print(beat.rrMs);
+	Serial.print(',');
+	Serial.print(beat.heartRate);
+	Serial.print(',');
+	Serial.println(detector.heartRate());
+}
+
+void setup() {
+	Serial.begin(115200);
+
+#if defined(ARDUINO_ARCH_ESP32)
+	ADS1293.begin(SCK_PIN, MISO_PIN, MOSI_PIN);
+#else
+	ADS1293.begin();
+#endif
+	ADS1293.applyProfile<ThreeLead1600>();
+
+	runSelfTest();
+	detector.onBeat(printBeat);
+
+	ADS1293.startAcquisition(ring, 32);
+}
+
+void loop() {
+	size_t n = ADS1293.readFrames(frames, 32);
+	detector.processBlock(frames, n, 0);
+
+	if (Serial.available()) {
+		while (Serial.available())
+			Serial.read();
+		ADS1293.stopAcquisition();
+		detector.onBeat(nullptr);
+		runSelfTest();
+		detector.onBeat(printBeat);
+		ADS1293.startAcquisition(ring, 32);
+	}
+}
@@ -0,0 +1,128 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Protocentral ADS1293 Arduino example — startup time per profile
+//
+//  Author: Ashwin Whitchurch, Protocentral Electronics
+//  SPDX-FileCopyrightText: 2025 Protocentral Electronics
+//  SPDX-License-Identifier: MIT
+//
+//  Starts the device from each ready-made configuration profile and prints
+//  one CSV line per run with the time from the startup() call to each step:
+//
+//    profile,odr_hz,ready_us,configured_us,first_sample_us,settled_sample_us
+//
+//  ready       the device answered on SPI (REVID)
+//  configured  the profile was written and conversions started
+//  first       the first DRDY
+//  settled     the first frame past the filter settling time
+//
+//  The device is put back in standby between runs, so each run measures a
+//  reconfiguration with the clock already running. The first run after
+//  power-up also includes the crystal start-up time. "3-lead-unmasked" is
+//  the 3-lead profile with the initial DRDY masking turned off: its first
+//  frame arrives one output period after start, ahead of the settled one.
+//
+//  Hardware connections (Arduino UNO / ESP32 VSPI):
+//
+//  | Signal | Arduino UNO | ESP32 (VSPI default) |
+//  |-------:|:-----------:|:--------------------:|
+//  | MISO   | 12          | 19                   |
+//  | MOSI   | 11          | 23                   |
+//  | SCLK   | 13          | 18                   |
+//  | CS     | 4           | 4                    |
+//  | VCC    | +5V         | +5V                  |
+//  | GND    | GND         | GND                  |
+//  | DRDY   | 2           | 2                    |
+//
+//  For full documentation and examples, see:
+//    https://github.com/Protocentral/protocentral-ads1293-arduino
+//
+/////////////////////////////////////////////////////////////////////////////////////////
+
+#include "protocentral_ads1293.h"
+#include "protocentral_ads1293_profile.h"
+#include <SPI.h>
+
+#define DRDY_PIN 2
+#define CS_PIN 4
+
+// Optional SPI pin overrides
+#if !defined(SCK_PIN)
+#if defined(ARDUINO_ARCH_ESP32)
+#define SCK_PIN 18
+#define MISO_PIN 19
+#define MOSI_PIN 23
+#else
+#define SCK_PIN 13
+#define MISO_PIN 12
+#define MOSI_PIN 11
+#endif
+#endif
+
+ads1293 ADS1293(DRDY_PIN, CS_PIN, &SPI, 4000000);
+
+typedef ADS1293Profile<
+	ADS1293FlexChannel<1, 2, 1>,
+	ADS1293FlexChannel<2, 3, 1>,
+	ADS1293CommonModeDetect<0x07>,
+	ADS1293RightLegDrive<4>,
+	ADS1293Oscillator<>,
+	ADS1293AfeChannels<0x03>,
+	ADS1293DecimationR2<5>,
+	ADS1293DecimationR3<1, 6>,
+	ADS1293DecimationR3<2, 6>,
+	ADS1293DataReadySource<DRDYSource::Ch1Ecg>,
+	ADS1293DataReadyMasking<false>,
+	ADS1293LoopReadback<0x03>,
+	ADS1293Start<>>
+	ThreeLeadUnmasked;
+
+static void run(const char *name, const uint8_t *image) {
+	ADS1293::StartupTiming t;
+	ADS1293::Samples first;
+	const bool ok = ADS1293.startup(image, &first, &t);
+	Serial.print(name);
+	Serial.print(',');
+	if (ok) {
+		Serial.print(ADS1293.getOutputDataRate(1), 1);
+		Serial.print(',');
+		Serial.print(t.readyUs);
+		Serial.print(',');
+		Serial.print(t.configuredUs);
+		Serial.print(',');
+		Serial.print(t.firstSampleUs);
+		Serial.print(',');
+		Serial.println(t.settledSampleUs);
+	} else {
+		Serial.println(F("timeout"));
+	}
+	ADS1293.applyGlobalConfig(GlobalConfig::Standby);
+}
+
+void runBenchmark() {
+	Serial.println(F("profile,odr_hz,ready_us,configured_us,first_sample_us,settled_sample_us"));
+	run("3-lead", ADS1293Profiles::ThreeLead::image());
+	run("3-lead-unmasked", ThreeLeadUnmasked::image());
+	run("5-lead", ADS1293Profiles::FiveLead::image());
+	run("self-test", ADS1293Profiles::SelfTest::image());
+	run("high-rate", ADS1293Profiles::HighRate::image());
+}
+
+void setup() {
+	Serial.begin(115200);
+#if defined(ARDUINO_ARCH_ESP32)
+	ADS1293.begin(SCK_PIN, MISO_PIN, MOSI_PIN);
+#else
+	ADS1293.begin();
+#endif
+	runBenchmark();
+}
+
+void loop() {
+	// Re-run when any character is received on the serial port.
+	if (Serial.available()) {
+		while (Serial.available())
+			Serial.read();
+		runBenchmark();
+	}
+}
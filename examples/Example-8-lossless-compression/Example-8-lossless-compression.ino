@@ -0,0 +1,198 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Protocentral ADS1293 Arduino example — lossless compression
+//
+//  Author: Ashwin Whitchurch, Protocentral Electronics
+//  SPDX-FileCopyrightText: 2025 Protocentral Electronics
+//  SPDX-License-Identifier: MIT
+//
+//  Runs the lossless codec (see protocentral_ads1293_codec.h) over a
+//  simulated 3-lead ECG and over frames recorded from the device, and prints
+//  one CSV line per source:
+//
+//    source,frames,bytes,bytes_per_frame,percent_of_raw,ns_per_frame,cycles_per_frame
+//
+//  percent_of_raw compares against the 12 bytes per frame of raw int32
+//  triples (as sent by Example 3). The time covers ADS1293CodecEncoder::add()
+//  including the block coding, not the generation or the SPI reads; the
+//  coded packets go to a sink that discards them. Cycles are derived from
+//  the time and F_CPU.
+//
+//  Hardware connections (Arduino UNO / ESP32 VSPI):
+//
+//  | Signal | Arduino UNO | ESP32 (VSPI default) |
+//  |-------:|:-----------:|:--------------------:|
+//  | MISO   | 12          | 19                   |
+//  | MOSI   | 11          | 23                   |
+//  | SCLK   | 13          | 18                   |
+//  | CS     | 4           | 4                    |
+//  | VCC    | +5V         | +5V                  |
+//  | GND    | GND         | GND                  |
+//  | DRDY   | 2           | 2                    |
+//
+//  For full documentation and examples, see:
+//    https://github.com/Protocentral/protocentral-ads1293-arduino
+//
+/////////////////////////////////////////////////////////////////////////////////////////
+
+#include "protocentral_ads1293.h"
+#include "protocentral_ads1293_codec.h"
+#include "protocentral_ads1293_profile.h"
+#include <SPI.h>
+
+#define DRDY_PIN 2
+#define CS_PIN 4
+
+#define SIMULATED_FRAMES 4000
+#define RECORDED_FRAMES 2000
+#define SIM_RATE_HZ 400.0f
+
+// Optional SPI pin overrides
+#if !defined(SCK_PIN)
+#if defined(ARDUINO_ARCH_ESP32)
+#define SCK_PIN 18
+#define MISO_PIN 19
+#define MOSI_PIN 23
+#else
+#define SCK_PIN 13
+#define MISO_PIN 12
+#define MOSI_PIN 11
+#endif
+#endif
+
+ads1293 ADS1293(DRDY_PIN, CS_PIN);
+
+// The routing of begin3LeadECG() at 400 SPS: R1 = R2 = 4, R3 = 16,
+// 102.4 kHz / 256 = 400 SPS. START_CON locks the rate registers, so the
+// rate is part of the configuration rather than set after it.
+typedef ADS1293Profile<
+	ADS1293FlexChannel<1, 2, 1>,
+	ADS1293FlexChannel<2, 3, 1>,
+	ADS1293CommonModeDetect<0x07>,
+	ADS1293RightLegDrive<4>,
+	ADS1293Oscillator<>,
+	ADS1293AfeChannels<0x03>,
+	ADS1293DecimationR2<4>,
+	ADS1293DecimationR3<1, 16>,
+	ADS1293DecimationR3<2, 16>,
+	ADS1293DataReadySource<DRDYSource::Ch1Ecg>,
+	ADS1293LoopReadback<0x03>,
+	ADS1293Start<>>
+	ThreeLead400;
+
+// Counts and discards the coded packets.
+class NullPrint : public Print {
+public:
+	size_t write(uint8_t) override { return 1; }
+	size_t write(const uint8_t *, size_t size) override { return size; }
+};
+
+NullPrint sink;
+uint8_t packet[ADS1293CodecEncoder::packetSize(ADS1293CodecEncoder::ENCODER_FRAMES, 3)];
+ADS1293::Samples frames[ADS1293CodecEncoder::ENCODER_FRAMES];
+
+// Simulated leads I and II, in ADC codes: P, QRS and T waves at 70 bpm on a
+// slow baseline wander, plus a few codes of noise. Lead III = II - I.
+static uint32_t noiseState = 1;
+
+static int32_t noise() {
+	noiseState = noiseState * 1664525ul + 1013904223ul;
+	return static_cast<int32_t>((noiseState >> 24) & 0x0F) - 8;
+}
+
+static float wave(float phase, float center, float width, float amplitude) {
+	const float d = (phase - center) / width;
+	return amplitude * expf(-0.5f * d * d);
+}
+
+static void simulate(uint32_t index, ADS1293::Samples &s) {
+	const float t = index / SIM_RATE_HZ;
+	const float phase = fmodf(t, 0.857f);
+	const float qrs = wave(phase, 0.30f, 0.008f, -1500.0f) + wave(phase, 0.32f, 0.010f, 12000.0f) +
+					  wave(phase, 0.34f, 0.008f, -3000.0f);
+	const float lead1 = wave(phase, 0.15f, 0.02f, 1500.0f) + qrs + wave(phase, 0.60f, 0.04f, 3000.0f) +
+						800.0f * sinf(1.885f * t);
+	const float lead2 = 1.3f * lead1 + 0.2f * qrs + 600.0f * sinf(1.885f * t + 1.0f);
+	s.ch1 = static_cast<int32_t>(lead1) + noise();
+	s.ch2 = static_cast<int32_t>(lead2) + noise();
+	s.ch3 = s.ch2 - s.ch1 + noise() / 4;
+	s.ok = true;
+}
+
+static void report(const char *source, const ADS1293CodecEncoder &encoder, uint32_t elapsedUs) {
+	const uint32_t n = encoder.framesEncoded();
+	const float ns = n ? elapsedUs * 1000.0f / n : 0.0f;
+	Serial.print(source);
+	Serial.print(',');
+	Serial.print(n);
+	Serial.print(',');
+	Serial.print(encoder.bytesWritten());
+	Serial.print(',');
+	Serial.print(n ? static_cast<float>(encoder.bytesWritten()) / n : 0.0f, 2);
+	Serial.print(',');
+	Serial.print(n ? 100.0f * encoder.bytesWritten() / (12.0f * n) : 0.0f, 1);
+	Serial.print(',');
+	Serial.print(ns, 0);
+	Serial.print(',');
+	Serial.println(ns * (F_CPU / 1.0e9f), 0);
+}
+
+void runSimulated() {
+	ADS1293CodecEncoder encoder(sink, packet, sizeof(packet));
+	const uint8_t block = encoder.framesPerBlock();
+	uint32_t elapsed = 0;
+	for (uint32_t i = 0; i < SIMULATED_FRAMES; i += block) {
+		for (uint8_t f = 0; f < block; ++f)
+			simulate(i + f, frames[f]);
+		const uint32_t t0 = micros();
+		encoder.add(frames, block);
+		elapsed += micros() - t0;
+	}
+	report("simulated", encoder, elapsed);
+}
+
+void runRecorded() {
+	ADS1293CodecEncoder encoder(sink, packet, sizeof(packet));
+	uint32_t elapsed = 0;
+	uint32_t recorded = 0;
+	const uint32_t start = millis();
+	while (recorded < RECORDED_FRAMES && millis() - start < 30000) {
+		ADS1293::Samples s;
+		if (ADS1293.readFrames(&s, 1) != 1)
+			continue;
+		const uint32_t t0 = micros();
+		encoder.add(s);
+		elapsed += micros() - t0;
+		++recorded;
+	}
+	const uint32_t t0 = micros();
+	encoder.flush();
+	elapsed += micros() - t0;
+	report("recorded", encoder, elapsed);
+}
+
+void runBenchmark() {
+	Serial.println(F("source,frames,bytes,bytes_per_frame,percent_of_raw,ns_per_frame,cycles_per_frame"));
+	runSimulated();
+	runRecorded();
+}
+
+void setup() {
+	Serial.begin(115200);
+#if defined(ARDUINO_ARCH_ESP32)
+	ADS1293.begin(SCK_PIN, MISO_PIN, MOSI_PIN);
+#else
+	ADS1293.begin();
+#endif
+	ADS1293.applyProfile<ThreeLead400>();
+	runBenchmark();
+}
+
+void loop() {
+	// Re-run when any character is received on the serial port.
+	if (Serial.available()) {
+		while (Serial.available())
+			Serial.read();
+		runBenchmark();
+	}
+}
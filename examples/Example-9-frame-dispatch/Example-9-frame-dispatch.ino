@@ -0,0 +1,164 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Protocentral ADS1293 Arduino example — several consumers of one stream
+//
+//  Author: Ashwin Whitchurch, Protocentral Electronics
+//  SPDX-FileCopyrightText: 2025 Protocentral Electronics
+//  SPDX-License-Identifier: MIT
+//
+//  Acquires 3-lead ECG at 400 SPS and feeds three independent consumers from
+//  one ADS1293Dispatcher (see protocentral_ads1293_dispatch.h):
+//
+//    - a QRS detector, as a push sink called with each block of new frames;
+//    - a plotter, as a push sink printing every 4th frame of lead I and II;
+//    - a slow "logger", as a pull sink that reads at its own pace (here once
+//      a second) and prints how many frames it got, how many it lost by
+//      falling behind and how often the device lost frames before them:
+//
+//        log,<frames>,<dropped>,<max backlog>,<missed>
+//
+//  The history buffer holds 512 frames (1.28 s), so the logger keeps up;
+//  shrink it to 256 to see the logger drop frames while the plot and the
+//  detector carry on unaffected. On AVR the history is 32 frames and the
+//  logger always drops.
+//
+//  Hardware connections (Arduino UNO / ESP32 VSPI):
+//
+//  | Signal | Arduino UNO | ESP32 (VSPI default) |
+//  |-------:|:-----------:|:--------------------:|
+//  | MISO   | 12          | 19                   |
+//  | MOSI   | 11          | 23                   |
+//  | SCLK   | 13          | 18                   |
+//  | CS     | 4           | 4                    |
+//  | VCC    | +5V         | +5V                  |
+//  | GND    | GND         | GND                  |
+//  | DRDY   | 2           | 2                    |
+//
+//  For full documentation and examples, see:
+//    https://github.com/Protocentral/protocentral-ads1293-arduino
+//
+/////////////////////////////////////////////////////////////////////////////////////////
+
+#include "protocentral_ads1293.h"
+#include "protocentral_ads1293_dispatch.h"
+#include "protocentral_ads1293_profile.h"
+#include "protocentral_ads1293_qrs.h"
+#include <SPI.h>
+
+#define DRDY_PIN 2
+#define CS_PIN 4
+
+// AVR has 2 KB of RAM; the history there is much shorter.
+#if defined(__AVR__)
+#define HISTORY_FRAMES 32
+#else
+#define HISTORY_FRAMES 512
+#endif
+
+// Optional SPI pin overrides
+#if !defined(SCK_PIN)
+#if defined(ARDUINO_ARCH_ESP32)
+#define SCK_PIN 18
+#define MISO_PIN 19
+#define MOSI_PIN 23
+#else
+#define SCK_PIN 13
+#define MISO_PIN 12
+#define MOSI_PIN 11
+#endif
+#endif
+
+ads1293 ADS1293(DRDY_PIN, CS_PIN);
+
+// The routing of begin3LeadECG() at 400 SPS: R1 = R2 = 4, R3 = 16,
+// 102.4 kHz / 256 = 400 SPS. START_CON locks the rate registers, so the
+// rate is part of the configuration rather than set after it.
+typedef ADS1293Profile<
+	ADS1293FlexChannel<1, 2, 1>,
+	ADS1293FlexChannel<2, 3, 1>,
+	ADS1293CommonModeDetect<0x07>,
+	ADS1293RightLegDrive<4>,
+	ADS1293Oscillator<>,
+	ADS1293AfeChannels<0x03>,
+	ADS1293DecimationR2<4>,
+	ADS1293DecimationR3<1, 16>,
+	ADS1293DecimationR3<2, 16>,
+	ADS1293DataReadySource<DRDYSource::Ch1Ecg>,
+	ADS1293LoopReadback<0x03>,
+	ADS1293Start<>>
+	ThreeLead400;
+ADS1293QrsDetector detector;
+
+ADS1293::Samples ring[16];
+ADS1293::Samples history[HISTORY_FRAMES];
+ADS1293Dispatcher dispatcher(ADS1293, history, HISTORY_FRAMES);
+
+int8_t logger = -1;
+uint32_t lastLogMs = 0;
+
+void detect(const ADS1293::Samples *frames, size_t count, void *) {
+	detector.processBlock(frames, count, 0);
+}
+
+void plot(const ADS1293::Samples *frames, size_t count, void *) {
+	for (size_t i = 0; i < count; ++i) {
+		if (frames[i].index % 4 != 0)
+			continue;
+		Serial.print(frames[i].ch1);
+		Serial.print(',');
+		Serial.println(frames[i].ch2);
+	}
+}
+
+void printBeat(const ADS1293QrsDetector::Beat &beat, void *) {
+	Serial.print(F("beat,"));
+	Serial.println(beat.heartRate);
+}
+
+// Pull sink: consume everything that is waiting, block by block, straight
+// from the shared history.
+void serviceLogger() {
+	uint32_t frames = 0;
+	const ADS1293::Samples *block;
+	size_t n;
+	while ((n = dispatcher.peek(logger, block)) != 0) {
+		// e.g. write `block` to an SD card here
+		frames += n;
+		dispatcher.consume(logger, n);
+	}
+	Serial.print(F("log,"));
+	Serial.print(frames);
+	Serial.print(',');
+	Serial.print(dispatcher.dropped(logger));
+	Serial.print(',');
+	Serial.print(dispatcher.maxBacklog());
+	Serial.print(',');
+	Serial.println(dispatcher.missed(logger));
+}
+
+void setup() {
+	Serial.begin(115200);
+#if defined(ARDUINO_ARCH_ESP32)
+	ADS1293.begin(SCK_PIN, MISO_PIN, MOSI_PIN);
+#else
+	ADS1293.begin();
+#endif
+	ADS1293.applyProfile<ThreeLead400>();
+
+	detector.configure(ADS1293::SamplingRate::SPS_400);
+	detector.onBeat(printBeat);
+	dispatcher.subscribe(detect);
+	dispatcher.subscribe(plot);
+	logger = dispatcher.subscribe();
+
+	ADS1293.startAcquisition(ring, 16);
+}
+
+void loop() {
+	dispatcher.poll();
+
+	if (millis() - lastLogMs >= 1000) {
+		lastLogMs = millis();
+		serviceLogger();
+	}
+}
@@ -0,0 +1,145 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Host tests - synthetic and recorded ECG waveforms
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//
+// SyntheticEcg produces a lead-II-like waveform as a sum of Gaussian P, Q,
+// R, S and T waves per beat, with RR variability, white noise, mains
+// interference and baseline wander, in ADC codes (1 mV = CODES_PER_MV).
+// It marks the sample nearest each R peak so detectors can be scored.
+//
+// loadRecording() reads a recorded waveform from CSV: one sample per line,
+// optionally followed by ",1" on samples annotated as R peaks. Lines
+// starting with '#' are ignored.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+struct EcgSignal {
+  double heartRate = 72.0; // beats per minute
+  double rrJitter = 0.05;  // +- fraction of the RR interval
+  double noiseMv = 0.0;    // white noise, RMS
+  double mainsMv = 0.0;    // mains amplitude
+  double mainsHz = 50.0;
+  double wanderMv = 0.0;   // baseline wander amplitude at 0.3 Hz
+  uint32_t seed = 1;
+};
+
+class SyntheticEcg {
+public:
+  static constexpr double CODES_PER_MV = 20000.0;
+
+  SyntheticEcg(double fs, const EcgSignal &signal) : fs_(fs), sig_(signal), rng_(signal.seed ? signal.seed : 1)
+  {
+    beat_[0] = -1.0;
+    beat_[1] = 0.4;
+    beat_[2] = beat_[1] + nextRr();
+    nextR_ = static_cast<uint32_t>(lround(beat_[1] * fs_));
+  }
+
+  // Next sample; `rPeak` is set on the sample nearest an R peak.
+  int32_t next(bool *rPeak = nullptr)
+  {
+    const double t = n_ / fs_;
+    if (t > beat_[2] - 0.5 * (beat_[2] - beat_[1]))
+      advanceBeat();
+    if (rPeak)
+      *rPeak = n_ == nextR_;
+    if (n_ == nextR_)
+      nextR_ = static_cast<uint32_t>(lround(beat_[2] * fs_));
+
+    double mv = 0.0;
+    for (uint8_t i = 0; i < 3; ++i)
+      mv += beatShape(t - beat_[i], i ? beat_[i] - beat_[i - 1] : 0.8);
+    mv += sig_.mainsMv * sin(2.0 * PI * sig_.mainsHz * t);
+    mv += sig_.wanderMv * sin(2.0 * PI * 0.3 * t + 1.0);
+    if (sig_.noiseMv > 0.0)
+      mv += sig_.noiseMv * gaussian();
+    ++n_;
+    return static_cast<int32_t>(lround(mv * CODES_PER_MV));
+  }
+
+private:
+  static constexpr double PI = 3.14159265358979323846;
+
+  double fs_;
+  EcgSignal sig_;
+  uint32_t rng_;
+  uint32_t n_ = 0;
+  double beat_[3]; // previous, current and next R-peak times (s)
+  uint32_t nextR_ = 0;
+
+  static double wave(double t, double a, double mu, double sigma)
+  {
+    const double d = (t - mu) / sigma;
+    return a * exp(-0.5 * d * d);
+  }
+
+  // One beat in mV, `t` relative to its R peak.
+  static double beatShape(double t, double rr)
+  {
+    if (t < -0.4 || t > 0.8)
+      return 0.0;
+    const double qt = 0.3 * sqrt(rr);
+    return wave(t, 0.15, -0.18, 0.025) + wave(t, -0.12, -0.03, 0.01) + wave(t, 1.2, 0.0, 0.011) +
+           wave(t, -0.25, 0.03, 0.01) + wave(t, 0.3, qt, 0.05);
+  }
+
+  double uniform()
+  {
+    rng_ = rng_ * 1664525u + 1013904223u;
+    return (rng_ >> 8) * (1.0 / 16777216.0);
+  }
+
+  double gaussian()
+  {
+    const double u = uniform() + 1.0e-12;
+    return sqrt(-2.0 * log(u)) * cos(2.0 * PI * uniform());
+  }
+
+  double nextRr()
+  {
+    return 60.0 / sig_.heartRate * (1.0 + sig_.rrJitter * (2.0 * uniform() - 1.0));
+  }
+
+  void advanceBeat()
+  {
+    beat_[0] = beat_[1];
+    beat_[1] = beat_[2];
+    beat_[2] = beat_[1] + nextRr();
+  }
+};
+
+struct EcgRecording {
+  std::vector<int32_t> samples;
+  std::vector<uint32_t> rPeaks; // annotated sample indices, may be empty
+};
+
+static inline bool loadRecording(const char *path, EcgRecording &rec)
+{
+  FILE *f = fopen(path, "r");
+  if (!f)
+    return false;
+  char line[128];
+  while (fgets(line, sizeof(line), f))
+  {
+    if (line[0] == '#' || line[0] == '\n')
+      continue;
+    char *end = nullptr;
+    const long v = strtol(line, &end, 10);
+    if (end == line)
+      continue;
+    if (*end == ',' && atoi(end + 1) == 1)
+      rec.rPeaks.push_back(static_cast<uint32_t>(rec.samples.size()));
+    rec.samples.push_back(static_cast<int32_t>(v));
+  }
+  fclose(f);
+  return !rec.samples.empty();
+}
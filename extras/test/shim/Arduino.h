@@ -0,0 +1,107 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Host test shim - the subset of the Arduino core the library uses
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//
+// Time, pins and interrupts are virtual and driven by shim.h: micros() and
+// millis() read a simulated clock, digitalWrite()/digitalRead() go to the
+// attached simulated devices and attachInterrupt() handlers are called when
+// a device raises an edge.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define DEC 10
+#define HEX 16
+#define F(x) x
+#define PROGMEM
+#define digitalPinToInterrupt(p) (p)
+#define NOT_AN_INTERRUPT -1
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+unsigned long micros();
+unsigned long millis();
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+void noInterrupts();
+void interrupts();
+void yield();
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size)
+  {
+    size_t n = 0;
+    while (size--)
+      n += write(*buffer++);
+    return n;
+  }
+
+  size_t print(const char *s) { return write(reinterpret_cast<const uint8_t *>(s), strlen(s)); }
+  size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+  size_t print(unsigned long v, int base = DEC) { return printf32(base == HEX ? "%lX" : "%lu", v); }
+  size_t print(long v, int base = DEC) { return printf32(base == HEX ? "%lX" : "%ld", v); }
+  size_t print(unsigned int v, int base = DEC) { return print(static_cast<unsigned long>(v), base); }
+  size_t print(int v, int base = DEC) { return print(static_cast<long>(v), base); }
+  size_t print(unsigned char v, int base = DEC) { return print(static_cast<unsigned long>(v), base); }
+  size_t print(double v, int digits = 2)
+  {
+    char buf[40];
+    snprintf(buf, sizeof(buf), "%.*f", digits, v);
+    return print(buf);
+  }
+  size_t println() { return print("\r\n"); }
+  template <typename T>
+  size_t println(T v) { return print(v) + println(); }
+  template <typename T>
+  size_t println(T v, int format) { return print(v, format) + println(); }
+
+private:
+  template <typename T>
+  size_t printf32(const char *fmt, T v)
+  {
+    char buf[24];
+    snprintf(buf, sizeof(buf), fmt, v);
+    return print(buf);
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+};
+
+// Serial writes to stdout; nothing is ever received.
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  int availableForWrite() { return 64; }
+  size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+  size_t write(const uint8_t *buffer, size_t size) override { return fwrite(buffer, 1, size, stdout); }
+  using Print::write;
+  explicit operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,67 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Host test shim - SPIClass
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//
+// The base class answers every byte with 0xFF; a simulated bus derives from
+// it and overrides transfer(). beginTransaction()/endTransaction() hold the
+// shim lock (so a test thread cannot interleave with a transaction) and
+// keep interrupts registered with usingInterrupt() pending until the
+// transaction ends, as the AVR and SAMD cores do.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Arduino.h"
+
+#define MSBFIRST 1
+#define LSBFIRST 0
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+#define SPI_HAS_TRANSACTION 1
+#define SPI_HAS_NOTUSINGINTERRUPT 1
+
+class SPISettings {
+public:
+  SPISettings(uint32_t clock = 4000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0)
+      : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+  uint32_t clock;
+  uint8_t bitOrder;
+  uint8_t dataMode;
+};
+
+class SPIClass {
+public:
+  virtual ~SPIClass() {}
+  virtual void begin() {}
+  virtual void end() {}
+  virtual void beginTransaction(SPISettings settings);
+  virtual void endTransaction();
+  virtual uint8_t transfer(uint8_t data)
+  {
+    (void)data;
+    return 0xFF;
+  }
+  virtual void transfer(void *buf, size_t count)
+  {
+    uint8_t *p = static_cast<uint8_t *>(buf);
+    for (size_t i = 0; i < count; ++i)
+      p[i] = transfer(p[i]);
+  }
+
+  void usingInterrupt(uint8_t interrupt);
+  void notUsingInterrupt(uint8_t interrupt);
+  bool usesInterrupt(uint8_t interrupt) const noexcept { return interrupt < 64 && (interrupts_ >> interrupt) & 1u; }
+  bool inTransaction() const noexcept { return depth_ != 0; }
+  const SPISettings &settings() const noexcept { return settings_; }
+
+private:
+  SPISettings settings_;
+  uint64_t interrupts_ = 0;
+  uint8_t depth_ = 0;
+};
+
+extern SPIClass SPI;
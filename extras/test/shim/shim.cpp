@@ -0,0 +1,375 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Host test shim - virtual clock, pins and interrupts
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include "shim.h"
+#include "SPI.h"
+
+HardwareSerial Serial;
+SPIClass SPI;
+
+namespace {
+
+const uint8_t MAX_INTERRUPTS = 64;
+const uint8_t MAX_DEVICES = 8;
+const uint8_t MAX_BUSES = 4;
+
+struct State {
+	uint64_t now = 0;
+	uint32_t callCostNs = 250;
+	uint32_t microsOffset = 0;
+	bool advancing = false;
+
+	shim::Device *devices[MAX_DEVICES] = {};
+	SPIClass *openBuses[MAX_BUSES] = {};
+
+	void (*handlers[MAX_INTERRUPTS])(void) = {};
+	uint64_t pending = 0;
+	bool enabled = true;
+	bool inHandler = false;
+	uint32_t inTransaction = 0;
+	uint32_t delivered = 0;
+};
+
+State &state()
+{
+	static State s;
+	return s;
+}
+
+void notifyDevices(uint64_t now)
+{
+	State &s = state();
+	for (uint8_t i = 0; i < MAX_DEVICES; ++i)
+		if (s.devices[i])
+			s.devices[i]->clockAdvanced(now);
+}
+
+uint64_t nextEvent()
+{
+	State &s = state();
+	uint64_t next = UINT64_MAX;
+	for (uint8_t i = 0; i < MAX_DEVICES; ++i)
+	{
+		if (!s.devices[i])
+			continue;
+		const uint64_t t = s.devices[i]->nextEventNs();
+		if (t < next)
+			next = t;
+	}
+	return next;
+}
+
+bool anyTransactionOpen()
+{
+	State &s = state();
+	for (uint8_t i = 0; i < MAX_BUSES; ++i)
+		if (s.openBuses[i])
+			return true;
+	return false;
+}
+
+bool maskedByTransaction(uint8_t interrupt)
+{
+	State &s = state();
+	for (uint8_t i = 0; i < MAX_BUSES; ++i)
+		if (s.openBuses[i] && s.openBuses[i]->usesInterrupt(interrupt))
+			return true;
+	return false;
+}
+
+void deliverPending()
+{
+	State &s = state();
+	while (s.pending && s.enabled && !s.inHandler && !anyTransactionOpen())
+	{
+		uint8_t n = 0;
+		while (!((s.pending >> n) & 1u))
+			++n;
+		s.pending &= ~(static_cast<uint64_t>(1) << n);
+		void (*handler)(void) = s.handlers[n];
+		if (!handler)
+			continue;
+		s.inHandler = true;
+		++s.delivered;
+		handler();
+		s.inHandler = false;
+	}
+}
+
+} // namespace
+
+namespace shim {
+
+std::recursive_mutex &lock()
+{
+	static std::recursive_mutex m;
+	return m;
+}
+
+void attachDevice(Device *device)
+{
+	std::lock_guard<std::recursive_mutex> guard(lock());
+	State &s = state();
+	for (uint8_t i = 0; i < MAX_DEVICES; ++i)
+	{
+		if (!s.devices[i])
+		{
+			s.devices[i] = device;
+			return;
+		}
+	}
+}
+
+void detachDevice(Device *device)
+{
+	std::lock_guard<std::recursive_mutex> guard(lock());
+	State &s = state();
+	for (uint8_t i = 0; i < MAX_DEVICES; ++i)
+		if (s.devices[i] == device)
+			s.devices[i] = nullptr;
+}
+
+uint64_t nowNs()
+{
+	std::lock_guard<std::recursive_mutex> guard(lock());
+	return state().now;
+}
+
+void advanceNs(uint64_t ns)
+{
+	std::lock_guard<std::recursive_mutex> guard(lock());
+	State &s = state();
+	const uint64_t target = s.now + ns;
+	if (s.advancing)
+	{
+		// A handler run from a device event: the outer loop catches up.
+		s.now = target;
+		return;
+	}
+	s.advancing = true;
+	for (;;)
+	{
+		const uint64_t next = nextEvent();
+		if (next > target)
+			break;
+		if (next > s.now)
+			s.now = next;
+		notifyDevices(s.now);
+		if (nextEvent() <= next)
+			break; // the device did not move on; avoid spinning
+	}
+	if (target > s.now)
+		s.now = target;
+	notifyDevices(s.now);
+	s.advancing = false;
+}
+
+void setCallCostNs(uint32_t ns)
+{
+	std::lock_guard<std::recursive_mutex> guard(lock());
+	state().callCostNs = ns;
+}
+
+void setMicrosOffset(uint32_t us)
+{
+	std::lock_guard<std::recursive_mutex> guard(lock());
+	state().microsOffset = us;
+}
+
+void raiseInterrupt(uint8_t interrupt)
+{
+	std::lock_guard<std::recursive_mutex> guard(lock());
+	State &s = state();
+	if (interrupt >= MAX_INTERRUPTS || !s.handlers[interrupt])
+		return;
+	// A handler or interrupts-off section would hold the edge on a real
+	// core too; only an open transaction that did not register it is wrong.
+	if (s.enabled && !s.inHandler && anyTransactionOpen() && !maskedByTransaction(interrupt))
+		++s.inTransaction;
+	s.pending |= static_cast<uint64_t>(1) << interrupt;
+	deliverPending();
+}
+
+bool interruptAttached(uint8_t interrupt)
+{
+	std::lock_guard<std::recursive_mutex> guard(lock());
+	return interrupt < MAX_INTERRUPTS && state().handlers[interrupt];
+}
+
+uint32_t interruptsInTransaction()
+{
+	std::lock_guard<std::recursive_mutex> guard(lock());
+	return state().inTransaction;
+}
+
+bool transactionOpen()
+{
+	std::lock_guard<std::recursive_mutex> guard(lock());
+	return anyTransactionOpen();
+}
+
+uint32_t interruptsDelivered()
+{
+	std::lock_guard<std::recursive_mutex> guard(lock());
+	return state().delivered;
+}
+
+void reset()
+{
+	std::lock_guard<std::recursive_mutex> guard(lock());
+	State &s = state();
+	s.now = 0;
+	s.callCostNs = 250;
+	s.microsOffset = 0;
+	for (uint8_t i = 0; i < MAX_INTERRUPTS; ++i)
+		s.handlers[i] = nullptr;
+	s.pending = 0;
+	s.enabled = true;
+	s.inTransaction = 0;
+	s.delivered = 0;
+}
+
+void transactionBegun(SPIClass *bus)
+{
+	State &s = state();
+	for (uint8_t i = 0; i < MAX_BUSES; ++i)
+	{
+		if (!s.openBuses[i])
+		{
+			s.openBuses[i] = bus;
+			return;
+		}
+	}
+}
+
+void transactionEnded(SPIClass *bus)
+{
+	State &s = state();
+	for (uint8_t i = 0; i < MAX_BUSES; ++i)
+		if (s.openBuses[i] == bus)
+			s.openBuses[i] = nullptr;
+	deliverPending();
+}
+
+} // namespace shim
+
+// --- Arduino API ---
+
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+	std::lock_guard<std::recursive_mutex> guard(shim::lock());
+	State &s = state();
+	for (uint8_t i = 0; i < MAX_DEVICES; ++i)
+		if (s.devices[i])
+			s.devices[i]->pinWritten(pin, value);
+}
+
+int digitalRead(uint8_t pin)
+{
+	std::lock_guard<std::recursive_mutex> guard(shim::lock());
+	State &s = state();
+	shim::advanceNs(s.callCostNs);
+	int value = HIGH; // unconnected inputs read as pulled up
+	for (uint8_t i = 0; i < MAX_DEVICES; ++i)
+		if (s.devices[i] && s.devices[i]->pinRead(pin, value))
+			break;
+	return value;
+}
+
+void delay(unsigned long ms)
+{
+	shim::advanceNs(static_cast<uint64_t>(ms) * 1000000u);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	shim::advanceNs(static_cast<uint64_t>(us) * 1000u);
+}
+
+unsigned long micros()
+{
+	std::lock_guard<std::recursive_mutex> guard(shim::lock());
+	State &s = state();
+	shim::advanceNs(s.callCostNs);
+	return static_cast<uint32_t>(s.microsOffset + s.now / 1000u);
+}
+
+unsigned long millis()
+{
+	std::lock_guard<std::recursive_mutex> guard(shim::lock());
+	State &s = state();
+	shim::advanceNs(s.callCostNs);
+	return static_cast<uint32_t>(s.microsOffset / 1000u + s.now / 1000000u);
+}
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int)
+{
+	std::lock_guard<std::recursive_mutex> guard(shim::lock());
+	if (interrupt < MAX_INTERRUPTS)
+		state().handlers[interrupt] = isr;
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+	std::lock_guard<std::recursive_mutex> guard(shim::lock());
+	State &s = state();
+	if (interrupt >= MAX_INTERRUPTS)
+		return;
+	s.handlers[interrupt] = nullptr;
+	s.pending &= ~(static_cast<uint64_t>(1) << interrupt);
+}
+
+void noInterrupts()
+{
+	std::lock_guard<std::recursive_mutex> guard(shim::lock());
+	state().enabled = false;
+}
+
+void interrupts()
+{
+	std::lock_guard<std::recursive_mutex> guard(shim::lock());
+	state().enabled = true;
+	deliverPending();
+}
+
+void yield()
+{
+	shim::advanceNs(1000);
+}
+
+// --- SPIClass ---
+
+void SPIClass::beginTransaction(SPISettings settings)
+{
+	shim::lock().lock();
+	settings_ = settings;
+	if (depth_++ == 0)
+		shim::transactionBegun(this);
+}
+
+void SPIClass::endTransaction()
+{
+	if (depth_ && --depth_ == 0)
+		shim::transactionEnded(this);
+	shim::lock().unlock();
+}
+
+void SPIClass::usingInterrupt(uint8_t interrupt)
+{
+	if (interrupt < 64)
+		interrupts_ |= static_cast<uint64_t>(1) << interrupt;
+}
+
+void SPIClass::notUsingInterrupt(uint8_t interrupt)
+{
+	if (interrupt < 64)
+		interrupts_ &= ~(static_cast<uint64_t>(1) << interrupt);
+}
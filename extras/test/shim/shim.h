@@ -0,0 +1,82 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Host test shim - virtual clock, pins and interrupts
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//
+// Tests and simulated devices drive the Arduino API through this interface:
+//  - time only moves when something advances it: advanceNs()/advanceUs(),
+//    delay(), SPI traffic (8 SCLK periods per byte) and a fixed cost for
+//    every micros(), millis() and digitalRead() call, so busy-wait loops in
+//    the driver terminate and results are reproducible;
+//  - a Device sees every pin write and read and schedules its own events;
+//    the clock stops at each event time, so edges are raised on time even
+//    when a test advances by a large step;
+//  - raiseInterrupt() calls the handler attached to that interrupt, unless
+//    interrupts are off, a handler is already running or an SPI transaction
+//    is open. The edge is then held and delivered as soon as that ends.
+//    Edges held by an open transaction that did not register the interrupt
+//    with usingInterrupt() are counted by interruptsInTransaction(): on a
+//    real core that handler would have run in the middle of the transfer.
+//
+// Everything is serialized by one recursive lock, so a pthread backend can
+// run against the same simulated device as the test's main thread.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Arduino.h"
+#include <mutex>
+
+class SPIClass;
+
+namespace shim {
+
+class Device {
+public:
+  virtual ~Device() {}
+  virtual void pinWritten(uint8_t pin, uint8_t value)
+  {
+    (void)pin;
+    (void)value;
+  }
+  // Return true and set `value` for pins the device drives.
+  virtual bool pinRead(uint8_t pin, int &value)
+  {
+    (void)pin;
+    (void)value;
+    return false;
+  }
+  // Absolute time of the next scheduled event, or UINT64_MAX.
+  virtual uint64_t nextEventNs() const { return UINT64_MAX; }
+  virtual void clockAdvanced(uint64_t nowNs) { (void)nowNs; }
+};
+
+void attachDevice(Device *device);
+void detachDevice(Device *device);
+
+uint64_t nowNs();
+void advanceNs(uint64_t ns);
+inline void advanceUs(uint64_t us) { advanceNs(us * 1000u); }
+// Cost of one micros()/millis()/digitalRead() call (default 250 ns).
+void setCallCostNs(uint32_t ns);
+// micros() = offset + elapsed, to exercise the 32-bit wrap.
+void setMicrosOffset(uint32_t us);
+
+void raiseInterrupt(uint8_t interrupt);
+bool interruptAttached(uint8_t interrupt);
+uint32_t interruptsInTransaction();
+uint32_t interruptsDelivered();
+// True while a transaction is open on any bus (e.g. on another thread).
+bool transactionOpen();
+
+// Clear the clock, handlers, pending edges and counters. Devices stay.
+void reset();
+
+std::recursive_mutex &lock();
+
+// Called by SPIClass.
+void transactionBegun(SPIClass *bus);
+void transactionEnded(SPIClass *bus);
+
+} // namespace shim
@@ -0,0 +1,584 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Host test simulator - behavioural ADS1293
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ads1293_sim.h"
+
+namespace {
+
+const uint8_t CONFIG = 0x00;
+const uint8_t OSC_CN = 0x12;
+const uint8_t AFE_RES = 0x13;
+const uint8_t AFE_SHDN_CN = 0x14;
+const uint8_t FLEX_VBAT_CN = 0x05;
+const uint8_t LOD_CN = 0x06;
+const uint8_t LOD_EN = 0x07;
+const uint8_t ERROR_LOD = 0x18;
+const uint8_t ERR_STATUS = 0x19;
+const uint8_t R2_RATE = 0x21;
+const uint8_t R3_RATE_CH1 = 0x22;
+const uint8_t R1_RATE = 0x25;
+const uint8_t DRDYB_SRC = 0x27;
+const uint8_t MASK_DRDYB = 0x29;
+const uint8_t MASK_ERR = 0x2A;
+const uint8_t CH_CNFG = 0x2F;
+const uint8_t DATA_STATUS = 0x30;
+const uint8_t DATA_CH1_PACE = 0x31;
+const uint8_t DATA_CH1_ECG = 0x37;
+const uint8_t REVID = 0x40;
+const uint8_t DATA_LOOP = 0x50;
+
+const uint64_t CRYSTAL_START_NS = 15000000u;
+const uint8_t INITIAL_DRDY_MASK = 6;
+
+uint8_t resetValue(uint8_t a)
+{
+	switch (a)
+	{
+	case 0x00: return 0x02;
+	case 0x06: return 0x08;
+	case 0x17: return 0x01;
+	case 0x1F: return 0x03;
+	case 0x21: return 0x08;
+	case 0x22:
+	case 0x23:
+	case 0x24: return 0x80;
+	case 0x28: return 0x40;
+	case 0x2D: return 0x09;
+	case 0x2E: return 0x33;
+	case 0x40: return ADS1293Sim::REVISION;
+	default: return 0x00;
+	}
+}
+
+// One-hot rate codes; anything else behaves as the reset value.
+uint8_t decodeR2(uint8_t code)
+{
+	switch (code)
+	{
+	case 0x01: return 4;
+	case 0x02: return 5;
+	case 0x04: return 6;
+	default: return 8;
+	}
+}
+
+uint8_t decodeR3(uint8_t code)
+{
+	switch (code)
+	{
+	case 0x01: return 4;
+	case 0x02: return 6;
+	case 0x04: return 8;
+	case 0x08: return 12;
+	case 0x10: return 16;
+	case 0x20: return 32;
+	case 0x40: return 64;
+	default: return 128;
+	}
+}
+
+double gaussian(double t, double centre, double width)
+{
+	const double z = (t - centre) / width;
+	return exp(-0.5 * z * z);
+}
+
+} // namespace
+
+// --- bus ---
+
+void ADS1293SimBus::beginTransaction(SPISettings settings)
+{
+	SPIClass::beginTransaction(settings);
+	++transactions_;
+}
+
+uint8_t ADS1293SimBus::transfer(uint8_t data)
+{
+	std::lock_guard<std::recursive_mutex> guard(shim::lock());
+	uint8_t out = 0xFF;
+	for (uint8_t i = 0; i < MAX_DEVICES; ++i)
+		if (devices_[i] && devices_[i]->selected_)
+			out &= devices_[i]->transfer(data);
+	++bytes_;
+	const uint32_t clock = settings().clock ? settings().clock : 1;
+	byteRemainderPs_ += 8000000000000ull / clock;
+	shim::advanceNs(byteRemainderPs_ / 1000u);
+	byteRemainderPs_ %= 1000u;
+	return out;
+}
+
+void ADS1293SimBus::transfer(void *buf, size_t count)
+{
+	++bufferTransfers_;
+	uint8_t *p = static_cast<uint8_t *>(buf);
+	for (size_t i = 0; i < count; ++i)
+		p[i] = transfer(p[i]);
+}
+
+// --- device ---
+
+ADS1293Sim::ADS1293Sim(ADS1293SimBus &bus, uint8_t csPin, uint8_t drdyPin, uint8_t alarmPin)
+	: bus_(bus), cs_(csPin), drdy_(drdyPin), alarm_(alarmPin)
+{
+	for (uint8_t i = 0; i < ADS1293SimBus::MAX_DEVICES; ++i)
+	{
+		if (!bus_.devices_[i])
+		{
+			bus_.devices_[i] = this;
+			break;
+		}
+	}
+	powerOn();
+	shim::attachDevice(this);
+}
+
+ADS1293Sim::~ADS1293Sim()
+{
+	shim::detachDevice(this);
+	for (uint8_t i = 0; i < ADS1293SimBus::MAX_DEVICES; ++i)
+		if (bus_.devices_[i] == this)
+			bus_.devices_[i] = nullptr;
+}
+
+void ADS1293Sim::powerOn()
+{
+	std::lock_guard<std::recursive_mutex> guard(shim::lock());
+	for (uint8_t a = 0; a < REGISTER_COUNT; ++a)
+		regs_[a] = resetValue(a);
+	const uint64_t now = shim::nowNs();
+	oscReadyNs_ = now + CRYSTAL_START_NS;
+	interfaceReadyNs_ = now + interfaceDelayNs_;
+	running_ = false;
+	drdyLow_ = false;
+	sourceRead_ = true;
+	selected_ = false;
+	for (uint8_t ch = 0; ch < 3; ++ch)
+		ecgIndex_[ch] = paceIndex_[ch] = 0;
+	injectedLod_ = 0;
+	updateLeadOff(); // the electrodes stay off, the detector is shut down
+}
+
+void ADS1293Sim::setReg(uint8_t addr, uint8_t value)
+{
+	std::lock_guard<std::recursive_mutex> guard(shim::lock());
+	if (addr >= REGISTER_COUNT)
+		return;
+	regs_[addr] = value;
+	if (addr == CONFIG || addr == OSC_CN)
+		updateRunState();
+}
+
+bool ADS1293Sim::channelActive(uint8_t ch) const
+{
+	// routed, with INA and SDM powered, or measuring the supply (INA off)
+	if (regs_[AFE_SHDN_CN] & (0x08u << ch))
+		return false;
+	return batteryMonitor(ch) || (regs_[0x01 + ch] != 0 && !(regs_[AFE_SHDN_CN] & (0x01u << ch)));
+}
+
+bool ADS1293Sim::batteryMonitor(uint8_t ch) const
+{
+	return (regs_[FLEX_VBAT_CN] & (0x01u << ch)) != 0;
+}
+
+uint32_t ADS1293Sim::batteryCode(uint8_t channel) const
+{
+	const double max = adcMax(channel);
+	const double code = (static_cast<double>(batteryUv_) / vrefUv_ - 1.0) * max;
+	return static_cast<uint32_t>(lround(code < 0.0 ? 0.0 : code > max ? max : code));
+}
+
+double ADS1293Sim::fsHz(uint8_t ch) const
+{
+	const double fs = (regs_[AFE_RES] & (0x08u << ch)) ? 204800.0 : 102400.0;
+	return fs * (1.0 + ppm_ * 1.0e-6);
+}
+
+double ADS1293Sim::pacePeriodNs(uint8_t channel) const
+{
+	if (channel < 1 || channel > 3 || !running_ || !channelActive(channel - 1))
+		return 0.0;
+	const uint8_t ch = static_cast<uint8_t>(channel - 1);
+	const uint8_t r1 = (regs_[R1_RATE] & (1u << ch)) ? 2 : 4;
+	return 1.0e9 * r1 * decodeR2(regs_[R2_RATE]) / fsHz(ch);
+}
+
+double ADS1293Sim::ecgPeriodNs(uint8_t channel) const
+{
+	const double pace = pacePeriodNs(channel);
+	return pace * decodeR3(regs_[R3_RATE_CH1 + channel - 1]);
+}
+
+uint32_t ADS1293Sim::adcMax(uint8_t channel) const
+{
+	if (channel < 1 || channel > 3)
+		return 0;
+	const uint8_t r3 = decodeR3(regs_[R3_RATE_CH1 + channel - 1]);
+	const bool alt = r3 == 6 || r3 == 12;
+	switch (decodeR2(regs_[R2_RATE]))
+	{
+	case 5: return alt ? 0xB964F0u : 0xC35000u;
+	case 6: return alt ? 0xE6A900u : 0xF30000u;
+	default: return alt ? 0xF30000u : 0x800000u;
+	}
+}
+
+uint16_t ADS1293Sim::paceAdcMax() const
+{
+	switch (decodeR2(regs_[R2_RATE]))
+	{
+	case 5: return 0xC350u;
+	case 6: return 0xF300u;
+	default: return 0x8000u;
+	}
+}
+
+double ADS1293Sim::beatTimeS(uint32_t k) const
+{
+	return wave_.firstBeatS + k * 60.0 / wave_.heartRateBpm;
+}
+
+double ADS1293Sim::ecgUv(uint8_t lead, double t) const
+{
+	static const double scale[3] = {1.0, 1.4, 0.4}; // lead III = II - I
+	const double rr = 60.0 / wave_.heartRateBpm;
+	const long nearest = lround((t - wave_.firstBeatS) / rr);
+	double uv = 0.0;
+	for (long k = nearest - 1; k <= nearest + 1; ++k)
+	{
+		if (k < 0)
+			continue;
+		const double b = beatTimeS(static_cast<uint32_t>(k));
+		uv += 150.0 * gaussian(t, b - 0.16, 0.025) - 100.0 * gaussian(t, b - 0.02, 0.008) +
+			  1000.0 * gaussian(t, b, 0.010) - 250.0 * gaussian(t, b + 0.02, 0.008) +
+			  350.0 * gaussian(t, b + 0.28, 0.040);
+	}
+	uv *= scale[(lead - 1) % 3];
+	uv += wave_.mainsUv * sin(2.0 * M_PI * wave_.mainsHz * t) + wave_.baselineUv * sin(2.0 * M_PI * 0.3 * t);
+	return uv;
+}
+
+uint32_t ADS1293Sim::ecgCode(uint8_t channel, uint32_t index, double t)
+{
+	(void)index;
+	double uv = ecgUv(channel, t);
+	if (wave_.noiseUv > 0.0f)
+	{
+		noiseState_ = noiseState_ * 1664525u + 1013904223u;
+		uv += wave_.noiseUv * ((noiseState_ >> 8) / 8388608.0 - 1.0);
+	}
+	const double max = adcMax(channel);
+	double code = max / 2.0 + uv * 3.5 * max / (2.0 * vrefUv_);
+	if (code < 0.0)
+		code = 0.0;
+	else if (code > max)
+		code = max;
+	return static_cast<uint32_t>(lround(code));
+}
+
+uint16_t ADS1293Sim::paceCode(uint8_t channel, uint32_t index, double t)
+{
+	(void)index;
+	const double max = paceAdcMax();
+	const double code = max / 2.0 + ecgUv(channel, t) * 3.5 * max / (2.0 * vrefUv_);
+	return static_cast<uint16_t>(lround(code < 0.0 ? 0.0 : code > max ? max : code));
+}
+
+void ADS1293Sim::setLeadOff(uint8_t lod)
+{
+	std::lock_guard<std::recursive_mutex> guard(shim::lock());
+	injectedLod_ = lod;
+	updateLeadOff();
+}
+
+void ADS1293Sim::disconnectInputs(uint8_t inputs)
+{
+	std::lock_guard<std::recursive_mutex> guard(shim::lock());
+	inputsOff_ = static_cast<uint8_t>(inputs & 0x3Fu);
+	updateLeadOff();
+}
+
+void ADS1293Sim::updateLeadOff()
+{
+	// SHDN_LOD (LOD_CN bit 3) powers the comparators down
+	const uint8_t detected = (regs_[LOD_CN] & 0x08u) ? 0 : static_cast<uint8_t>(inputsOff_ & regs_[LOD_EN]);
+	const uint8_t lod = static_cast<uint8_t>(injectedLod_ | detected);
+	regs_[ERROR_LOD] = lod;
+	regs_[ERR_STATUS] = static_cast<uint8_t>(lod ? regs_[ERR_STATUS] | 0x08u : regs_[ERR_STATUS] & ~0x08u);
+}
+
+void ADS1293Sim::setErrorStatus(uint8_t err)
+{
+	std::lock_guard<std::recursive_mutex> guard(shim::lock());
+	regs_[ERR_STATUS] = static_cast<uint8_t>((err & ~0x08u) | (regs_[ERROR_LOD] ? 0x08u : 0x00u));
+}
+
+bool ADS1293Sim::alarmAsserted() const
+{
+	return (regs_[ERR_STATUS] & ~regs_[MASK_ERR]) != 0;
+}
+
+bool ADS1293Sim::locked(uint8_t addr) const
+{
+	// REF_CN..AFE_RES and R2_RATE..MASK_DRDYB while START_CON is set
+	return (regs_[CONFIG] & 0x01u) && ((addr >= 0x11 && addr <= 0x13) || (addr >= 0x21 && addr <= 0x29));
+}
+
+void ADS1293Sim::updateRunState()
+{
+	const uint8_t config = regs_[CONFIG];
+	const bool run = (config & 0x01u) && !(config & 0x06u) && (regs_[OSC_CN] & 0x04u);
+	if (run == running_)
+		return;
+	running_ = run;
+	drdyLow_ = false;
+	sourceRead_ = true;
+	if (!run)
+		return;
+	startNs_ = shim::nowNs();
+	// leaving power-down with STRTCLK still set starts the clock here
+	if (!(regs_[OSC_CN] & 0x02u) && startNs_ < oscReadyNs_)
+		++clockViolations_;
+	regs_[DATA_STATUS] = 0;
+	for (uint8_t ch = 0; ch < 3; ++ch)
+		ecgIndex_[ch] = paceIndex_[ch] = 0;
+}
+
+uint8_t ADS1293Sim::loopSources(uint8_t *addrs) const
+{
+	const uint8_t cnfg = regs_[CH_CNFG];
+	uint8_t n = 0;
+	if (cnfg & 0x01u)
+		addrs[n++] = DATA_STATUS;
+	for (uint8_t ch = 0; ch < 3; ++ch)
+	{
+		if (cnfg & (0x02u << ch))
+		{
+			addrs[n++] = static_cast<uint8_t>(DATA_CH1_PACE + 2 * ch);
+			addrs[n++] = static_cast<uint8_t>(DATA_CH1_PACE + 2 * ch + 1);
+		}
+	}
+	for (uint8_t ch = 0; ch < 3; ++ch)
+		if (cnfg & (0x10u << ch))
+			for (uint8_t i = 0; i < 3; ++i)
+				addrs[n++] = static_cast<uint8_t>(DATA_CH1_ECG + 3 * ch + i);
+	return n;
+}
+
+bool ADS1293Sim::holdData() const
+{
+	if (!selected_)
+		return false;
+	// DATA_LOOP updates between frames, so a loop read can wait on DRDY
+	// with CS held low.
+	if (reading_ && !command_ && addr_ == DATA_LOOP)
+	{
+		uint8_t addrs[16];
+		const uint8_t n = loopSources(addrs);
+		return n && loopIndex_ % n != 0;
+	}
+	return true;
+}
+
+void ADS1293Sim::noteDataRead(uint8_t addr)
+{
+	if (addr < DATA_CH1_PACE || addr > 0x3F)
+		return;
+	drdyLow_ = false;
+	sourceRead_ = true;
+	if (addr < DATA_CH1_ECG)
+		regs_[DATA_STATUS] &= static_cast<uint8_t>(~(0x04u << ((addr - DATA_CH1_PACE) / 2)));
+	else
+		regs_[DATA_STATUS] &= static_cast<uint8_t>(~(0x20u << ((addr - DATA_CH1_ECG) / 3)));
+}
+
+uint8_t ADS1293Sim::readByte()
+{
+	uint8_t a = addr_;
+	if (a == DATA_LOOP)
+	{
+		uint8_t addrs[16];
+		const uint8_t n = loopSources(addrs);
+		if (!n)
+			return 0;
+		a = addrs[loopIndex_ % n];
+		++loopIndex_;
+	}
+	else if (addr_ < DATA_LOOP - 1)
+	{
+		++addr_;
+	}
+	uint8_t v = regs_[a];
+	if (a == DATA_STATUS)
+		v = static_cast<uint8_t>((v & ~0x02u) | (alarmAsserted() ? 0x02u : 0x00u));
+	noteDataRead(a);
+	return v;
+}
+
+void ADS1293Sim::writeByte(uint8_t value)
+{
+	const uint8_t a = addr_;
+	if (addr_ < DATA_LOOP - 1)
+		++addr_;
+	if ((a >= ERROR_LOD && a <= 0x1E) || a >= DATA_STATUS)
+		return; // read-only
+	if (locked(a))
+	{
+		++lockedWrites_;
+		return;
+	}
+	const uint8_t previous = regs_[a];
+	regs_[a] = value;
+	if (a == OSC_CN && (value & 0x04u) && !(previous & 0x04u) && !(value & 0x02u) &&
+		shim::nowNs() < oscReadyNs_)
+		++clockViolations_;
+	if (a == CONFIG && (previous & 0x04u) && !(value & 0x04u))
+		oscReadyNs_ = shim::nowNs() + CRYSTAL_START_NS; // crystal restarts after power-down
+	if (a == CONFIG || a == OSC_CN)
+		updateRunState();
+	if (a == LOD_CN || a == LOD_EN)
+		updateLeadOff();
+}
+
+uint8_t ADS1293Sim::transfer(uint8_t data)
+{
+	if (shim::nowNs() < interfaceReadyNs_)
+		return 0x00;
+	if (command_)
+	{
+		command_ = false;
+		reading_ = (data & 0x80u) != 0;
+		addr_ = static_cast<uint8_t>(data & 0x7Fu);
+		loopIndex_ = 0;
+		return 0x00;
+	}
+	if (reading_)
+		return readByte();
+	writeByte(data);
+	return 0x00;
+}
+
+void ADS1293Sim::pinWritten(uint8_t pin, uint8_t value)
+{
+	if (pin != cs_)
+		return;
+	if (value == LOW)
+	{
+		selected_ = true;
+		command_ = true;
+		return;
+	}
+	selected_ = false;
+	service(shim::nowNs());
+}
+
+bool ADS1293Sim::pinRead(uint8_t pin, int &value)
+{
+	if (pin == drdy_)
+	{
+		value = drdyLow_ ? LOW : HIGH;
+		return true;
+	}
+	if (pin == alarm_ && alarm_ != NO_PIN)
+	{
+		value = alarmAsserted() ? LOW : HIGH;
+		return true;
+	}
+	return false;
+}
+
+uint64_t ADS1293Sim::eventTime(double periodNs, uint32_t index) const
+{
+	return startNs_ + phaseNs_ + static_cast<uint64_t>(llround(periodNs * index));
+}
+
+uint64_t ADS1293Sim::nextEventNs() const
+{
+	if (!running_)
+		return UINT64_MAX;
+	uint64_t next = UINT64_MAX;
+	for (uint8_t ch = 0; ch < 3; ++ch)
+	{
+		const double pace = pacePeriodNs(static_cast<uint8_t>(ch + 1));
+		if (pace == 0.0)
+			continue;
+		const uint64_t p = eventTime(pace, paceIndex_[ch] + 1);
+		const uint64_t e = eventTime(ecgPeriodNs(static_cast<uint8_t>(ch + 1)), ecgIndex_[ch] + 1);
+		if (p < next)
+			next = p;
+		if (e < next)
+			next = e;
+	}
+	return next;
+}
+
+void ADS1293Sim::clockAdvanced(uint64_t nowNs)
+{
+	service(nowNs);
+}
+
+void ADS1293Sim::service(uint64_t nowNs)
+{
+	while (running_ && !holdData())
+	{
+		const uint64_t due = nextEventNs();
+		if (due > nowNs)
+			return;
+		// Every channel updating at this instant does so before DRDY falls.
+		bool ready = false;
+		for (uint8_t ch = 0; ch < 3; ++ch)
+		{
+			const uint8_t channel = static_cast<uint8_t>(ch + 1);
+			const double pacePeriod = pacePeriodNs(channel);
+			if (pacePeriod == 0.0)
+				continue;
+			if (eventTime(pacePeriod, paceIndex_[ch] + 1) == due)
+			{
+				const uint32_t index = ++paceIndex_[ch];
+				const uint16_t code = paceCode(channel, index, index * pacePeriod * 1.0e-9);
+				regs_[DATA_CH1_PACE + 2 * ch] = static_cast<uint8_t>(code >> 8);
+				regs_[DATA_CH1_PACE + 2 * ch + 1] = static_cast<uint8_t>(code);
+				regs_[DATA_STATUS] |= static_cast<uint8_t>(0x04u << ch);
+				if (regs_[DRDYB_SRC] & (0x01u << ch))
+					ready = true;
+			}
+			const double ecgPeriod = ecgPeriodNs(channel);
+			if (eventTime(ecgPeriod, ecgIndex_[ch] + 1) == due)
+			{
+				const uint32_t index = ++ecgIndex_[ch];
+				const uint32_t code =
+					batteryMonitor(ch) ? batteryCode(channel) : ecgCode(channel, index, index * ecgPeriod * 1.0e-9);
+				regs_[DATA_CH1_ECG + 3 * ch] = static_cast<uint8_t>(code >> 16);
+				regs_[DATA_CH1_ECG + 3 * ch + 1] = static_cast<uint8_t>(code >> 8);
+				regs_[DATA_CH1_ECG + 3 * ch + 2] = static_cast<uint8_t>(code);
+				regs_[DATA_STATUS] |= static_cast<uint8_t>(0x20u << ch);
+				// the initial mask counts ECG periods of the source
+				const uint8_t first = (regs_[MASK_DRDYB] & 0x02u) ? 1 : INITIAL_DRDY_MASK;
+				if ((regs_[DRDYB_SRC] & (0x08u << ch)) && index >= first)
+					ready = true;
+			}
+		}
+		if (ready)
+			dataReady();
+	}
+}
+
+void ADS1293Sim::dataReady()
+{
+	++edges_;
+	if (!sourceRead_)
+		++overwritten_;
+	sourceRead_ = false;
+	drdyLow_ = true;
+	if (dropInterrupts_)
+	{
+		--dropInterrupts_;
+		return;
+	}
+	shim::raiseInterrupt(digitalPinToInterrupt(drdy_));
+}
@@ -0,0 +1,206 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Host test simulator - behavioural ADS1293
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//
+// ADS1293Sim models the device as the driver sees it over SPI and its pins,
+// on the shim's virtual clock:
+//  - register file 0x00..0x50 with datasheet reset values; writes to the
+//    read-only and data registers are ignored, and REF_CN..AFE_RES and
+//    R2_RATE..MASK_DRDYB ignore writes while START_CON is set (counted by
+//    lockedWrites());
+//  - auto-incrementing reads and writes, and the DATA_LOOP read-back that
+//    cycles through the sources enabled in CH_CNFG;
+//  - conversions run while START_CON and STRTCLK are set and the device is
+//    not powered down. Each routed, powered channel updates its ECG data
+//    every R1 x R2 x R3 / fS and its pace data every R1 x R2 / fS, with fS
+//    102.4 kHz or 204.8 kHz (FS_HIGH_CHn). DATA_STATUS flags new data per
+//    channel; DRDYB falls when the DRDYB_SRC channel updates (after the
+//    six-period initial mask unless MASK_DRDYB clears it) and rises when
+//    the data is read. Data registers do not change while CS is low, except
+//    between frames of a DATA_LOOP read;
+//  - a synthetic ECG (P-QRS-T with known beat times, optional noise, mains
+//    and baseline wander) scaled to the programmed ADC_MAX, or per-test
+//    codes from an override of ecgCode()/paceCode(); a channel in battery-
+//    monitor mode converts the supply instead;
+//  - fault injection: lead-off and ERR_STATUS flags, which set the ALARMB
+//    bit of DATA_STATUS and pull the ALARMB pin low unless masked, and
+//    electrodes off inputs, flagged as far as LOD_CN and LOD_EN detect them;
+//  - clock error (ppm) and phase offset, and dropped DRDY interrupts.
+//
+// ADS1293SimBus is the SPIClass the driver is given. It routes bytes to the
+// device whose CS is low, advances the clock by 8 SCLK periods per byte and
+// counts transactions, bytes and buffer transfers.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <SPI.h>
+#include "shim.h"
+
+class ADS1293Sim;
+
+class ADS1293SimBus : public SPIClass {
+public:
+  static constexpr uint8_t MAX_DEVICES = 4;
+
+  void beginTransaction(SPISettings settings) override;
+  uint8_t transfer(uint8_t data) override;
+  void transfer(void *buf, size_t count) override;
+  using SPIClass::transfer;
+
+  uint32_t transactions() const noexcept { return transactions_; }
+  uint32_t bytes() const noexcept { return bytes_; }
+  uint32_t bufferTransfers() const noexcept { return bufferTransfers_; }
+  void resetCounters() noexcept { transactions_ = bytes_ = bufferTransfers_ = 0; }
+
+private:
+  friend class ADS1293Sim;
+  ADS1293Sim *devices_[MAX_DEVICES] = {};
+  uint32_t transactions_ = 0;
+  uint32_t bytes_ = 0;
+  uint32_t bufferTransfers_ = 0;
+  uint64_t byteRemainderPs_ = 0;
+};
+
+class ADS1293Sim : public shim::Device {
+public:
+  static constexpr uint8_t NO_PIN = 255;
+  static constexpr uint8_t REGISTER_COUNT = 0x51;
+  static constexpr uint8_t REVISION = 0x01;
+
+  // Analog input per ECG lead, in microvolts at the channel input.
+  struct Waveform {
+    float heartRateBpm = 72.0f;
+    float firstBeatS = 0.5f;  // time of the first R peak after START_CON
+    float noiseUv = 0.0f;     // uniform, peak
+    float mainsUv = 0.0f;     // 50 Hz amplitude
+    float mainsHz = 50.0f;
+    float baselineUv = 0.0f;  // 0.3 Hz wander amplitude
+  };
+
+  ADS1293Sim(ADS1293SimBus &bus, uint8_t csPin, uint8_t drdyPin, uint8_t alarmPin = NO_PIN);
+  ~ADS1293Sim();
+  ADS1293Sim(const ADS1293Sim &) = delete;
+  ADS1293Sim &operator=(const ADS1293Sim &) = delete;
+
+  // Power-on reset: registers, conversions and the crystal start-up time.
+  void powerOn();
+
+  // Register file, bypassing SPI and the write lock.
+  uint8_t reg(uint8_t addr) const { return addr < REGISTER_COUNT ? regs_[addr] : 0; }
+  void setReg(uint8_t addr, uint8_t value);
+
+  bool converting() const noexcept { return running_; }
+  bool drdyLow() const noexcept { return drdyLow_; }
+  // Output period of an ECG channel (1..3) and of its pace data, in ns
+  // (0 while the channel does not convert).
+  double ecgPeriodNs(uint8_t channel) const;
+  double pacePeriodNs(uint8_t channel) const;
+  uint32_t adcMax(uint8_t channel) const;
+  uint16_t paceAdcMax() const;
+
+  // Stimulus.
+  Waveform &waveform() noexcept { return wave_; }
+  // Time of beat k (from 0) relative to START_CON, in seconds.
+  double beatTimeS(uint32_t k) const;
+  // Lead signal in microvolts at time t after START_CON (lead 1..3).
+  double ecgUv(uint8_t lead, double t) const;
+  void setVref(float volts) noexcept { vrefUv_ = volts * 1.0e6f; }
+  // Supply seen by a channel in battery-monitor mode (VBAT_MONI_CHn):
+  // code = (VBAT / VREF - 1) * ADC_MAX, clamped to 0..ADC_MAX.
+  void setBatteryVolts(float volts) noexcept { batteryUv_ = volts * 1.0e6f; }
+  void setClockPpm(double ppm) noexcept { ppm_ = ppm; }
+  void setPhaseNs(uint32_t ns) noexcept { phaseNs_ = ns; }
+  // The next `count` DRDY edges do not reach the interrupt (the pin still
+  // falls), as if interrupts had been blocked across two edges.
+  void dropInterrupts(uint32_t count) noexcept { dropInterrupts_ = count; }
+  // REVID reads 0x00 for this long after powerOn().
+  void setInterfaceDelayUs(uint32_t us) noexcept { interfaceDelayNs_ = static_cast<uint64_t>(us) * 1000u; }
+
+  // Fault injection: ERROR_LOD bits (with ERR_STATUS LEADOFF) and other
+  // ERR_STATUS bits. Pass 0 to clear.
+  void setLeadOff(uint8_t lod);
+  void setErrorStatus(uint8_t err);
+  // Electrodes off inputs IN1..IN6 (bit 0 = IN1). They show in ERROR_LOD
+  // only while lead-off detection is out of shutdown (LOD_CN) and the
+  // input is enabled in LOD_EN. Pass 0 to reconnect all.
+  void disconnectInputs(uint8_t inputs);
+  bool alarmAsserted() const;
+
+  // Counters.
+  uint32_t drdyEdges() const noexcept { return edges_; }
+  // DRDY-source frames replaced before any of their data was read.
+  uint32_t framesOverwritten() const noexcept { return overwritten_; }
+  uint32_t lockedWrites() const noexcept { return lockedWrites_; }
+  // Conversions started before the crystal had CLOCK_START_MS.
+  uint32_t clockStartViolations() const noexcept { return clockViolations_; }
+  uint32_t ecgUpdates(uint8_t channel) const { return channel >= 1 && channel <= 3 ? ecgIndex_[channel - 1] : 0; }
+
+  // Per-test data. Defaults: the synthetic ECG and a pace ramp.
+  virtual uint32_t ecgCode(uint8_t channel, uint32_t index, double t);
+  virtual uint16_t paceCode(uint8_t channel, uint32_t index, double t);
+
+  // shim::Device
+  void pinWritten(uint8_t pin, uint8_t value) override;
+  bool pinRead(uint8_t pin, int &value) override;
+  uint64_t nextEventNs() const override;
+  void clockAdvanced(uint64_t nowNs) override;
+
+private:
+  friend class ADS1293SimBus;
+
+  ADS1293SimBus &bus_;
+  uint8_t cs_, drdy_, alarm_;
+  uint8_t regs_[REGISTER_COUNT];
+  Waveform wave_;
+  float vrefUv_ = 2.4e6f;
+  float batteryUv_ = 3.7e6f;
+  double ppm_ = 0.0;
+  uint32_t phaseNs_ = 0;
+
+  // SPI state
+  bool selected_ = false;
+  bool command_ = true;
+  bool reading_ = false;
+  uint8_t addr_ = 0;
+  uint16_t loopIndex_ = 0;
+
+  // conversion state
+  bool running_ = false;
+  uint64_t startNs_ = 0;
+  uint64_t oscReadyNs_ = 0;
+  uint64_t interfaceReadyNs_ = 0;
+  uint64_t interfaceDelayNs_ = 0;
+  uint32_t ecgIndex_[3] = {};
+  uint32_t paceIndex_[3] = {};
+  bool drdyLow_ = false;
+  bool sourceRead_ = true;
+  uint32_t noiseState_ = 1;
+  uint8_t injectedLod_ = 0;
+  uint8_t inputsOff_ = 0;
+
+  uint32_t edges_ = 0;
+  uint32_t overwritten_ = 0;
+  uint32_t lockedWrites_ = 0;
+  uint32_t clockViolations_ = 0;
+  uint32_t dropInterrupts_ = 0;
+
+  uint8_t transfer(uint8_t data);
+  uint8_t readByte();
+  void writeByte(uint8_t value);
+  void noteDataRead(uint8_t addr);
+  uint8_t loopSources(uint8_t *addrs) const;
+  bool locked(uint8_t addr) const;
+  void updateRunState();
+  void updateLeadOff();
+  bool channelActive(uint8_t ch) const;
+  bool batteryMonitor(uint8_t ch) const;
+  uint32_t batteryCode(uint8_t channel) const;
+  double fsHz(uint8_t ch) const;
+  bool holdData() const;
+  uint64_t eventTime(double periodNs, uint32_t index) const;
+  void service(uint64_t nowNs);
+  void dataReady();
+};
@@ -0,0 +1,104 @@
+// Interrupt-driven acquisition: every DRDY edge lands in the ring once, in
+// order, and the DRDY handler never runs inside another transaction on the
+// bus (startAcquisition registers it with SPI.usingInterrupt()).
+
+#include "test_common.h"
+
+static void testRing()
+{
+  TestRig rig;
+  shim::advanceUs(20000); // crystal start-up
+  CHECK(rig.ecg.begin3LeadECG());
+  CHECK_NEAR(rig.ecg.getOutputDataRate(1), 853.333, 0.001);
+
+  ADS1293::Samples ring[16];
+  CHECK(!rig.ecg.startAcquisition(ring, 12)); // not a power of two
+  CHECK(rig.ecg.startAcquisition(ring, 16));
+  CHECK(rig.bus.usesInterrupt(digitalPinToInterrupt(TestRig::DRDY_PIN)));
+
+  // loop(): register access in between, and a drain every 5 ms
+  ADS1293::Samples out[16];
+  uint32_t frames = 0;
+  uint32_t lastIndex = 0;
+  bool ordered = true;
+  bool missed = false;
+  for (uint16_t ms = 0; ms < 1000; ++ms)
+  {
+    CHECK_EQ(rig.ecg.readDeviceID(), ADS1293Sim::REVISION);
+    shim::advanceUs(1000);
+    if (ms % 5 != 4)
+      continue;
+    bool m = false;
+    const size_t n = rig.ecg.readFrames(out, 16, &m);
+    missed |= m;
+    for (size_t i = 0; i < n; ++i)
+    {
+      if (frames && out[i].index != lastIndex + 1)
+        ordered = false;
+      lastIndex = out[i].index;
+      ++frames;
+    }
+  }
+  CHECK(!missed);
+  CHECK(ordered);
+  CHECK_EQ(rig.ecg.overrunCount(), 0);
+  CHECK_EQ(rig.sim.framesOverwritten(), 0);
+  CHECK_NEAR(frames + rig.ecg.available(), rig.sim.drdyEdges(), 0);
+  CHECK_NEAR(frames, 853 - 5, 2);
+  CHECK_EQ(shim::interruptsInTransaction(), 0);
+
+  rig.ecg.stopAcquisition();
+  CHECK(!rig.ecg.acquisitionActive());
+  CHECK(!rig.bus.usesInterrupt(digitalPinToInterrupt(TestRig::DRDY_PIN)));
+  CHECK(!shim::interruptAttached(digitalPinToInterrupt(TestRig::DRDY_PIN)));
+}
+
+// The frames in the ring are the codes the device produced.
+static uint32_t lastCode[3];
+
+class RecordingSim : public ADS1293Sim {
+public:
+  using ADS1293Sim::ADS1293Sim;
+  uint32_t ecgCode(uint8_t channel, uint32_t index, double t) override
+  {
+    (void)t;
+    lastCode[channel - 1] = (channel << 20) | index;
+    return lastCode[channel - 1];
+  }
+};
+
+static void testFrameData()
+{
+  shim::reset();
+  ADS1293SimBus bus;
+  RecordingSim sim(bus, TestRig::CS_PIN, TestRig::DRDY_PIN);
+  ADS1293 ecg(TestRig::DRDY_PIN, TestRig::CS_PIN, &bus, 8000000);
+  ecg.begin();
+  shim::advanceUs(20000);
+  CHECK(ecg.begin3LeadECG());
+
+  ADS1293::Samples ring[64];
+  CHECK(ecg.startAcquisition(ring, 64));
+  shim::advanceUs(50000);
+  ADS1293::Samples out[64];
+  const size_t n = ecg.readFrames(out, 64);
+  CHECK(n > 30);
+  bool match = true;
+  for (size_t i = 1; i < n; ++i)
+  {
+    const int32_t step1 = out[i].ch1 - out[i - 1].ch1;
+    if ((out[i].ch1 >> 20) != 1 || (out[i].ch2 >> 20) != 2 || step1 != 1)
+      match = false;
+  }
+  CHECK(match);
+  CHECK_EQ(out[n - 1].ch1, static_cast<int32_t>(lastCode[0]));
+  CHECK_EQ(out[n - 1].ch3, 0); // CH3 not routed
+  ecg.stopAcquisition();
+}
+
+int main()
+{
+  testRing();
+  testFrameData();
+  return testResult("test_acquisition");
+}
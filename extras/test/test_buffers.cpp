@@ -0,0 +1,71 @@
+// Frame reads as buffer transfers, and the double-buffered raw frames
+// handed to the FrameReadyCallback: one transaction and one buffer
+// transfer per frame, and each frame pointer stays intact until the
+// second following frame completes.
+
+#include "test_common.h"
+
+struct Capture {
+  ADS1293SimBus *bus = nullptr;
+  const uint8_t *prev = nullptr;
+  const uint8_t *prevPrev = nullptr;
+  uint8_t prevCopy[ADS1293::FRAME_BYTES] = {};
+  uint32_t frames = 0;
+  uint32_t intact = 0;
+  uint32_t alternating = 0;
+  uint8_t status = 0;
+};
+
+static void onFrame(const uint8_t *frame, void *context)
+{
+  Capture &c = *static_cast<Capture *>(context);
+  if (c.prev)
+  {
+    // the previous frame is still readable while this one is handled
+    if (frame != c.prev && memcmp(c.prev, c.prevCopy, sizeof(c.prevCopy)) == 0)
+      ++c.intact;
+    if (!c.prevPrev || frame == c.prevPrev)
+      ++c.alternating;
+  }
+  c.prevPrev = c.prev;
+  c.prev = frame;
+  memcpy(c.prevCopy, frame, sizeof(c.prevCopy));
+  c.status = frame[-7];
+  ++c.frames;
+}
+
+static void testCallback(bool pace)
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  CHECK(rig.ecg.enablePaceReadout(pace));
+
+  Capture c;
+  rig.ecg.onFrameReady(onFrame, &c);
+  CHECK(rig.ecg.startAcquisition(nullptr, 0));
+  shim::advanceUs(10000); // past the initial mask
+  rig.bus.resetCounters();
+  const uint32_t before = c.frames;
+  shim::advanceUs(100000);
+  const uint32_t frames = c.frames - before;
+  CHECK_NEAR(frames, 85, 1);
+
+  const uint32_t block = pace ? ADS1293::DATA_BLOCK_BYTES : ADS1293::FRAME_BYTES;
+  CHECK_EQ(rig.bus.transactions(), frames);
+  CHECK_EQ(rig.bus.bufferTransfers(), frames);
+  CHECK_EQ(rig.bus.bytes(), frames * (1 + block));
+  CHECK_EQ(c.intact, c.frames - 1);
+  CHECK_EQ(c.alternating, c.frames - 1);
+  if (pace)
+    CHECK_EQ(c.status & 0x60, 0x60); // DATA_STATUS of the same burst
+  rig.ecg.stopAcquisition();
+  rig.ecg.onFrameReady(nullptr);
+}
+
+int main()
+{
+  testCallback(false);
+  testCallback(true);
+  return testResult("test_buffers");
+}
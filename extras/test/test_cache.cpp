@@ -0,0 +1,100 @@
+// Shadow register cache against the simulated register file: cached reads
+// and skipped writes stay off the bus, sync() groups dirty registers, and
+// writes the device ignores under START_CON never reach the cache, so
+// verify() agrees with the device after setSamplingRate() on a running
+// device.
+
+#include "test_common.h"
+
+static void testCache()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+
+  // reads of the configuration block come from the cache
+  rig.bus.resetCounters();
+  uint8_t flex[3];
+  CHECK(rig.ecg.readRegisters(Register::FLEX_CH1_CN, flex, sizeof(flex)));
+  CHECK_EQ(flex[1], 0x19);
+  CHECK(rig.ecg.configureChannel1()); // unchanged value
+  CHECK_EQ(rig.bus.transactions(), 0);
+  CHECK(rig.ecg.getCacheStats().writesSkipped >= 1);
+
+  // staged registers go out in one bridged burst
+  CHECK(rig.ecg.stageRegister(Register::LOD_EN, 0x07));
+  CHECK(rig.ecg.stageRegister(Register::LOD_AC_CN, 0x01));
+  CHECK(rig.ecg.sync());
+  CHECK_EQ(rig.bus.transactions(), 1);
+  CHECK_EQ(rig.sim.reg(0x07), 0x07);
+  CHECK_EQ(rig.sim.reg(0x09), 0x01);
+  CHECK(rig.ecg.verify());
+
+  // a chip reset behind the driver's back shows up in verify()
+  rig.sim.setReg(0x0A, 0x00);
+  CHECK(!rig.ecg.verify());
+  CHECK(rig.ecg.verify());
+}
+
+static void testLockedWrites()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  CHECK(rig.sim.converting());
+
+  // the device drops the write: the call says so and the cache keeps
+  // the device's value
+  CHECK(!rig.ecg.configureDRDYSource(DRDYSource::Ch2Ecg));
+  CHECK_EQ(rig.sim.lockedWrites(), 1);
+  CHECK_EQ(rig.sim.reg(0x27), 0x08);
+  uint8_t src = 0;
+  CHECK(rig.ecg.readRegisters(Register::DRDYB_SRC, &src, 1));
+  CHECK_EQ(src, 0x08);
+  CHECK(rig.ecg.verify());
+
+  // unlocked registers are written while running
+  CHECK(rig.ecg.setAlarmMask(0x08));
+  CHECK_EQ(rig.sim.reg(0x2A), 0x08);
+}
+
+static void testSamplingRateWhileRunning()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  CHECK_NEAR(rig.sim.ecgPeriodNs(1), 1.0e9 / 853.333, 1.0);
+
+  CHECK(rig.ecg.setSamplingRate(ADS1293::SamplingRate::SPS_1600));
+  CHECK_EQ(rig.sim.lockedWrites(), 0);
+  CHECK(rig.sim.converting());
+  CHECK_NEAR(rig.sim.ecgPeriodNs(1), 625000.0, 1.0);
+  CHECK_NEAR(rig.sim.ecgPeriodNs(2), 625000.0, 1.0);
+  CHECK_NEAR(rig.ecg.getOutputDataRate(1), 1600.0, 0.01);
+  CHECK(rig.ecg.verify());
+
+  // and the DRDY edges follow
+  const uint32_t before = rig.sim.drdyEdges();
+  ADS1293::Samples out[1];
+  for (uint16_t i = 0; i < 1000; ++i)
+  {
+    shim::advanceUs(100);
+    rig.ecg.readFrames(out, 1);
+  }
+  CHECK_NEAR(rig.sim.drdyEdges() - before, 160, 7);
+
+  // a stopped device stays stopped
+  CHECK(rig.ecg.applyGlobalConfig(GlobalConfig::Standby));
+  CHECK(rig.ecg.setSamplingRate(ADS1293::SamplingRate::SPS_200));
+  CHECK(!rig.sim.converting());
+  CHECK_EQ(rig.sim.reg(0x22), 0x20);
+  CHECK(rig.ecg.verify());
+}
+
+int main()
+{
+  testCache();
+  testLockedWrites();
+  testSamplingRateWhileRunning();
+  return testResult("test_cache");
+}
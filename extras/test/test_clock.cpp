@@ -0,0 +1,186 @@
+// Drift-corrected sample clock: with the device oscillator off by a few
+// hundred ppm, interrupt latency jitter and dropped DRDY edges, the
+// tracker measures the drift, frame indices show the gaps, and timestamps
+// sit on a straight line much tighter than the jitter. The same holds
+// across the 32-bit micros() wrap and on the polled and captured paths.
+
+#include "test_common.h"
+
+// Loop work with interrupts off for 0..maxUs, delaying DRDY handling the
+// way a busy sketch does.
+class JitterSource {
+public:
+  explicit JitterSource(uint32_t seed) : x_(seed) {}
+  void run(uint32_t maxUs)
+  {
+    x_ = x_ * 1664525u + 1013904223u;
+    noInterrupts();
+    shim::advanceNs((x_ >> 8) % (maxUs * 1000u + 1u));
+    interrupts();
+  }
+
+private:
+  uint32_t x_;
+};
+
+struct ClockRun {
+  uint32_t frames = 0;
+  uint32_t gaps = 0;        // missing indices
+  uint32_t backwards = 0;   // timestamps not increasing
+  double maxResidualUs = 0; // from the straight line through the first and last frame
+};
+
+// Acquire for `seconds` with jitter, draining every 5 ms.
+static ClockRun acquire(TestRig &rig, double seconds, uint32_t jitterUs)
+{
+  ADS1293::Samples ring[64];
+  CHECK(rig.ecg.startAcquisition(ring, 64));
+  std::vector<ADS1293::Samples> all;
+  ADS1293::Samples out[64];
+  JitterSource jitter(5);
+  const uint64_t end = shim::nowNs() + static_cast<uint64_t>(seconds * 1e9);
+  while (shim::nowNs() < end)
+  {
+    for (uint8_t i = 0; i < 50; ++i)
+    {
+      jitter.run(jitterUs);
+      shim::advanceUs(75);
+    }
+    const size_t n = rig.ecg.readFrames(out, 64);
+    all.insert(all.end(), out, out + n);
+  }
+  rig.ecg.stopAcquisition();
+
+  ClockRun r;
+  r.frames = static_cast<uint32_t>(all.size());
+  if (all.size() < 100)
+    return r;
+  // skip the first second while the tracker converges
+  const size_t first = all.size() / static_cast<size_t>(seconds);
+  const ADS1293::Samples &a = all[first];
+  const ADS1293::Samples &b = all.back();
+  const double usPerIndex = static_cast<double>(static_cast<uint32_t>(b.timestampUs - a.timestampUs)) / (b.index - a.index);
+  for (size_t i = 1; i < all.size(); ++i)
+  {
+    r.gaps += all[i].index - all[i - 1].index - 1;
+    if (static_cast<int32_t>(all[i].timestampUs - all[i - 1].timestampUs) <= 0)
+      ++r.backwards;
+    if (i < first)
+      continue;
+    const double expected = (all[i].index - a.index) * usPerIndex;
+    const double actual = static_cast<int32_t>(all[i].timestampUs - a.timestampUs);
+    if (fabs(actual - expected) > r.maxResidualUs)
+      r.maxResidualUs = fabs(actual - expected);
+  }
+  return r;
+}
+
+static void testDrift()
+{
+  TestRig rig;
+  rig.sim.setClockPpm(230.0);
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+
+  const ClockRun r = acquire(rig, 20.0, 24);
+  CHECK_NEAR(r.frames, 20 * 853.3, 20);
+  CHECK_EQ(r.gaps, 0);
+  CHECK_EQ(r.backwards, 0);
+  CHECK_NEAR(rig.ecg.sampleClockPpm(), 230.0, 5.0);
+  CHECK_NEAR(rig.ecg.sampleClockHz(), 853.333 * (1.0 + 230e-6), 0.01);
+  CHECK(r.maxResidualUs < 8.0);
+  benchResult("clock", "drift_error_ppm", fabs(rig.ecg.sampleClockPpm() - 230.0), "ppm");
+  benchResult("clock", "timestamp_residual_max", r.maxResidualUs, "us");
+}
+
+static void testDroppedEdges()
+{
+  TestRig rig;
+  rig.sim.setClockPpm(-150.0);
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  ADS1293::Samples ring[64];
+  CHECK(rig.ecg.startAcquisition(ring, 64));
+  ADS1293::Samples out[64];
+  uint32_t last = 0;
+  for (uint16_t ms = 0; ms < 2000; ms += 5)
+  {
+    shim::advanceUs(5000);
+    const size_t n = rig.ecg.readFrames(out, 64);
+    if (n)
+      last = out[n - 1].index;
+  }
+
+  // eight edges lost to the interrupt; the frames they carried are gone
+  rig.sim.dropInterrupts(8);
+  uint32_t frames = 0, gaps = 0;
+  for (uint16_t ms = 0; ms < 2000; ms += 5)
+  {
+    shim::advanceUs(5000);
+    const size_t n = rig.ecg.readFrames(out, 64);
+    for (size_t i = 0; i < n; ++i)
+    {
+      gaps += out[i].index - last - 1;
+      last = out[i].index;
+      ++frames;
+    }
+  }
+  rig.ecg.stopAcquisition();
+  CHECK_NEAR(gaps, 8, 1);
+  CHECK_NEAR(frames + gaps, 2 * 853.3, 3);
+  CHECK_NEAR(rig.ecg.sampleClockPpm(), -150.0, 10.0);
+}
+
+static void testMicrosWrap()
+{
+  TestRig rig;
+  rig.sim.setClockPpm(80.0);
+  shim::setMicrosOffset(0xFFFFFFFFu - 3000000u); // wraps 3 s in
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  const ClockRun r = acquire(rig, 6.0, 10);
+  CHECK_EQ(r.gaps, 0);
+  CHECK_EQ(r.backwards, 0);
+  CHECK(r.maxResidualUs < 8.0);
+  CHECK_NEAR(rig.ecg.sampleClockPpm(), 80.0, 8.0);
+}
+
+static void testPolledAndCaptured()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  shim::advanceUs(10000);
+
+  // captureFrames: consecutive indices one output period apart
+  ADS1293::Samples out[32];
+  CHECK_EQ(rig.ecg.captureFrames(out, 32), 32);
+  bool consecutive = true;
+  for (uint8_t i = 1; i < 32; ++i)
+  {
+    const uint32_t dt = out[i].timestampUs - out[i - 1].timestampUs;
+    if (out[i].index != out[i - 1].index + 1 || dt < 1100 || dt > 1250)
+      consecutive = false;
+  }
+  CHECK(consecutive);
+
+  // polled reads two periods apart: the skipped frame is a gap
+  CHECK(rig.ecg.applyGlobalConfig(GlobalConfig::Start));
+  shim::advanceUs(8000);
+  rig.ecg.readFrames(out, 1);
+  shim::advanceUs(1172);
+  CHECK_EQ(rig.ecg.readFrames(out, 1), 1);
+  const uint32_t index = out[0].index;
+  shim::advanceUs(2 * 1172);
+  CHECK_EQ(rig.ecg.readFrames(out, 1), 1);
+  CHECK_EQ(out[0].index - index, 2);
+}
+
+int main()
+{
+  testDrift();
+  testDroppedEdges();
+  testMicrosWrap();
+  testPolledAndCaptured();
+  return testResult("test_clock");
+}
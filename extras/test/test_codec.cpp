@@ -0,0 +1,188 @@
+// Lossless codec: frames acquired from the simulated device, synthetic
+// 3-lead ECG and white noise decode bit-exactly, packets never exceed the
+// worst-case size, and the compression ratio and host encode/decode cost
+// per frame are reported for each signal.
+//
+// A recorded waveform (see ecg_waveform.h) can be measured too:
+//
+//   test_codec <recording.csv>
+
+#include "test_common.h"
+#include "ecg_waveform.h"
+#include "protocentral_ads1293_codec.h"
+
+struct Decoded {
+  std::vector<ADS1293::Samples> frames;
+  std::vector<uint16_t> seqs;
+};
+
+static void onFrame(const ADS1293::Samples &s, uint16_t seq, void *context)
+{
+  Decoded &d = *static_cast<Decoded *>(context);
+  d.frames.push_back(s);
+  d.seqs.push_back(seq);
+}
+
+static int32_t sign24(int32_t v)
+{
+  return static_cast<int32_t>(static_cast<uint32_t>(v) << 8) >> 8;
+}
+
+static bool sameFrame(const ADS1293::Samples &a, const ADS1293::Samples &b, uint8_t mask)
+{
+  return (!(mask & 1) || sign24(a.ch1) == b.ch1) && (!(mask & 2) || sign24(a.ch2) == b.ch2) &&
+         (!(mask & 4) || sign24(a.ch3) == b.ch3);
+}
+
+// Encode, decode and compare; report ratio and cost under `name`.
+static void roundTrip(const char *name, const std::vector<ADS1293::Samples> &in, uint8_t mask,
+                      double maxBytesPerFrame)
+{
+  const uint8_t channels = static_cast<uint8_t>((mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1));
+  const size_t worst = ADS1293CodecEncoder::packetSize(ADS1293CodecEncoder::MAX_FRAMES, channels);
+  std::vector<uint8_t> buffer(worst);
+  ByteSink sink;
+  ADS1293CodecEncoder enc(sink, buffer.data(), buffer.size(), mask);
+  CHECK_EQ(enc.framesPerBlock(), ADS1293CodecEncoder::MAX_FRAMES);
+
+  HostTimer encodeTimer;
+  CHECK_EQ(enc.add(in.data(), in.size()), in.size());
+  CHECK(enc.flush());
+  const double encodeNs = encodeTimer.elapsedNs();
+  CHECK_EQ(sink.writes, enc.packetsSent());
+  CHECK(enc.bytesWritten() <= enc.packetsSent() * worst);
+
+  std::vector<uint8_t> rx(worst);
+  Decoded out;
+  ADS1293CodecDecoder dec(rx.data(), rx.size(), onFrame, &out);
+  HostTimer decodeTimer;
+  dec.feed(sink.data.data(), sink.data.size());
+  const double decodeNs = decodeTimer.elapsedNs();
+
+  CHECK_EQ(out.frames.size(), in.size());
+  CHECK_EQ(dec.crcErrors(), 0);
+  CHECK_EQ(dec.formatErrors(), 0);
+  CHECK_EQ(dec.framesLost(), 0);
+  size_t mismatched = 0;
+  for (size_t i = 0; i < in.size() && i < out.frames.size(); ++i)
+    if (!sameFrame(in[i], out.frames[i], mask) || out.seqs[i] != static_cast<uint16_t>(i))
+      ++mismatched;
+  CHECK_EQ(mismatched, 0);
+
+  const double bytesPerFrame = static_cast<double>(sink.data.size()) / in.size();
+  const double raw = 4.0 * channels;
+  CHECK(bytesPerFrame <= maxBytesPerFrame);
+  printf("%-12s %6zu frames: %.2f bytes/frame, ratio %.2f\n", name, in.size(), bytesPerFrame, raw / bytesPerFrame);
+  char bench[40];
+  snprintf(bench, sizeof(bench), "codec_%s", name);
+  benchResult(bench, "bytes_per_frame", bytesPerFrame, "B");
+  benchResult(bench, "ratio_vs_int32", raw / bytesPerFrame, "x");
+  benchResult(bench, "encode_ns_per_frame", encodeNs / in.size(), "ns");
+  benchResult(bench, "decode_ns_per_frame", decodeNs / in.size(), "ns");
+}
+
+// Frames as the library acquires them: captureFrames() from the simulator
+// running its synthetic ECG.
+static std::vector<ADS1293::Samples> acquired(uint32_t frames)
+{
+  TestRig rig;
+  rig.sim.waveform().noiseUv = 10.0f;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  std::vector<ADS1293::Samples> v(frames);
+  for (uint32_t i = 0; i < frames; i += 32)
+    CHECK_EQ(rig.ecg.captureFrames(&v[i], 32), 32);
+  return v;
+}
+
+// Leads I and II from the waveform generator, lead III = II - I.
+static std::vector<ADS1293::Samples> synthetic(uint32_t frames, double noiseMv)
+{
+  EcgSignal lead1, lead2;
+  lead1.noiseMv = lead2.noiseMv = noiseMv;
+  lead1.mainsMv = lead2.mainsMv = 0.02;
+  lead2.seed = 9;
+  SyntheticEcg a(853.333, lead1), b(853.333, lead2);
+  std::vector<ADS1293::Samples> v(frames);
+  for (uint32_t i = 0; i < frames; ++i)
+  {
+    v[i].ch1 = a.next() / 2;
+    v[i].ch2 = b.next();
+    v[i].ch3 = v[i].ch2 - v[i].ch1;
+  }
+  return v;
+}
+
+// Incompressible input: every code word takes the escape path.
+static std::vector<ADS1293::Samples> noise(uint32_t frames)
+{
+  std::vector<ADS1293::Samples> v(frames);
+  uint32_t x = 12345;
+  for (uint32_t i = 0; i < frames; ++i)
+  {
+    int32_t *ch[3] = {&v[i].ch1, &v[i].ch2, &v[i].ch3};
+    for (uint8_t c = 0; c < 3; ++c)
+    {
+      x = x * 1664525u + 1013904223u;
+      *ch[c] = sign24(static_cast<int32_t>(x >> 8));
+    }
+  }
+  return v;
+}
+
+static void testPartialAndSkip()
+{
+  std::vector<uint8_t> buffer(ADS1293CodecEncoder::packetSize(ADS1293CodecEncoder::MAX_FRAMES, 2));
+  ByteSink sink;
+  ADS1293CodecEncoder enc(sink, buffer.data(), buffer.size(), 0x03);
+  const std::vector<ADS1293::Samples> in = synthetic(40, 0.01);
+  CHECK_EQ(enc.add(in.data(), 10), 10);
+  enc.skipFrames(5);
+  CHECK_EQ(enc.add(in.data() + 10, 30), 30);
+  CHECK(enc.flush());
+  CHECK_EQ(enc.framesEncoded(), 40);
+
+  std::vector<uint8_t> rx(buffer.size());
+  Decoded out;
+  ADS1293CodecDecoder dec(rx.data(), rx.size(), onFrame, &out);
+  dec.feed(sink.data.data(), sink.data.size());
+  CHECK_EQ(out.frames.size(), 40);
+  CHECK_EQ(dec.framesLost(), 5);
+  if (out.frames.size() == 40)
+  {
+    CHECK_EQ(out.seqs[9], 9);
+    CHECK_EQ(out.seqs[10], 15);
+    CHECK(sameFrame(in[39], out.frames[39], 0x03));
+    CHECK_EQ(out.frames[39].ch3, 0);
+  }
+
+  // a buffer too small for one frame's worst case
+  uint8_t tiny[8];
+  ADS1293CodecEncoder none(sink, tiny, sizeof(tiny));
+  CHECK(!none.add(in[0]));
+}
+
+int main(int argc, char **argv)
+{
+  roundTrip("acquired", acquired(8192), 0x03, 3.2);
+  roundTrip("synthetic", synthetic(8192, 0.005), 0x07, 3.5);
+  roundTrip("noisy", synthetic(8192, 0.05), 0x07, 4.5);
+  roundTrip("white_noise", noise(4096), 0x07, 12.0);
+  testPartialAndSkip();
+
+  if (argc > 1)
+  {
+    EcgRecording rec;
+    CHECK(loadRecording(argv[1], rec));
+    std::vector<ADS1293::Samples> v(rec.samples.size());
+    for (size_t i = 0; i < v.size(); ++i)
+      v[i].ch1 = rec.samples[i];
+    if (!v.empty())
+      roundTrip("recording", v, 0x01, 4.0);
+  }
+  else
+  {
+    printf("recorded waveform: skipped (pass a CSV recording to measure one)\n");
+  }
+  return testResult("test_codec");
+}
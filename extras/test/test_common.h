@@ -0,0 +1,131 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Host tests - checks, benchmark output and the standard test rig
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//
+// CHECK() records a failure and carries on; testResult() turns the count
+// into the exit status ctest looks at. benchResult() prints one
+// machine-readable line per metric,
+//
+//   BENCH,<benchmark>,<metric>,<value>,<unit>
+//
+// which scripts/host_bench.sh collects and compares against a baseline.
+// Metrics measured on the virtual clock (bus time, transactions) are
+// exact; host wall-clock figures only compare runs on the same machine.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+#include "ads1293_sim.h"
+#include "protocentral_ads1293.h"
+
+static int testFailures = 0;
+
+#define CHECK(cond)                                                              \
+  do                                                                             \
+  {                                                                              \
+    if (!(cond))                                                                 \
+    {                                                                            \
+      ++testFailures;                                                            \
+      fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+    }                                                                            \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                 \
+  do                                                                                               \
+  {                                                                                                \
+    const long long a_ = static_cast<long long>(actual);                                           \
+    const long long e_ = static_cast<long long>(expected);                                         \
+    if (a_ != e_)                                                                                  \
+    {                                                                                              \
+      ++testFailures;                                                                              \
+      fprintf(stderr, "%s:%d: CHECK_EQ failed: %s = %lld, expected %lld\n", __FILE__, __LINE__, \
+              #actual, a_, e_);                                                                    \
+    }                                                                                              \
+  } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                                     \
+  do                                                                                                \
+  {                                                                                                 \
+    const double a_ = static_cast<double>(actual);                                                  \
+    const double e_ = static_cast<double>(expected);                                                \
+    if (!(fabs(a_ - e_) <= (tolerance)))                                                            \
+    {                                                                                               \
+      ++testFailures;                                                                               \
+      fprintf(stderr, "%s:%d: CHECK_NEAR failed: %s = %g, expected %g +- %g\n", __FILE__, __LINE__, \
+              #actual, a_, e_, static_cast<double>(tolerance));                                     \
+    }                                                                                               \
+  } while (0)
+
+static inline int testResult(const char *name)
+{
+  if (testFailures)
+    fprintf(stderr, "%s: %d check(s) failed\n", name, testFailures);
+  else
+    printf("%s: all checks passed\n", name);
+  return testFailures ? 1 : 0;
+}
+
+static inline void benchResult(const char *bench, const char *metric, double value, const char *unit)
+{
+  printf("BENCH,%s,%s,%.6g,%s\n", bench, metric, value, unit);
+}
+
+// Host wall clock, for throughput figures.
+class HostTimer {
+public:
+  HostTimer() : start_(std::chrono::steady_clock::now()) {}
+  double elapsedNs() const
+  {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_).count();
+  }
+
+private:
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Print target collecting everything written, for encoder output.
+class ByteSink : public Print {
+public:
+  std::vector<uint8_t> data;
+  uint32_t writes = 0;
+
+  size_t write(uint8_t c) override
+  {
+    data.push_back(c);
+    ++writes;
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override
+  {
+    data.insert(data.end(), buffer, buffer + size);
+    ++writes;
+    return size;
+  }
+};
+
+// One simulated device on its own bus, with the driver in front of it.
+// The shim is reset first, so every rig starts at time zero.
+struct TestRig {
+  static constexpr uint8_t CS_PIN = 10;
+  static constexpr uint8_t DRDY_PIN = 2;
+  static constexpr uint8_t ALARM_PIN = 3;
+
+  struct ShimReset {
+    ShimReset() { shim::reset(); }
+  } shimReset;
+  ADS1293SimBus bus;
+  ADS1293Sim sim;
+  ADS1293 ecg;
+
+  explicit TestRig(uint32_t spiClockHz = 8000000)
+      : sim(bus, CS_PIN, DRDY_PIN, ALARM_PIN), ecg(DRDY_PIN, CS_PIN, &bus, spiClockHz)
+  {
+    ecg.begin();
+  }
+};
@@ -0,0 +1,100 @@
+// Supply and bus diagnostics: readBatteryVoltage() recovers the supply a
+// battery-monitor channel converts, across output rates and references,
+// and measureFrameBusTime() reports the time of one 10-byte frame read
+// (command and nine data bytes) at the configured SPI clock.
+
+#include "test_common.h"
+
+static const uint8_t FLEX_VBAT_CN = 0x05, AFE_SHDN_CN = 0x14;
+
+static void testBattery()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  CHECK(!rig.ecg.enableBatteryMonitor(0));
+  CHECK(!rig.ecg.enableBatteryMonitor(4));
+  CHECK(rig.ecg.enableBatteryMonitor(3));
+  CHECK_EQ(rig.sim.reg(FLEX_VBAT_CN), 0x04);
+  CHECK_EQ(rig.sim.reg(AFE_SHDN_CN) & 0x04, 0x04); // INA off, SDM on
+  CHECK_EQ(rig.sim.reg(AFE_SHDN_CN) & 0x20, 0x00);
+
+  // CH3 is left at the reset rates by the 3-lead profile: 40 SPS
+  CHECK_NEAR(rig.ecg.getOutputDataRate(3), 40.0, 1e-3);
+  float volts = 0.0f;
+  CHECK(!rig.ecg.readBatteryVoltage(0, volts));
+  const float supplies[] = {2.5f, 3.0f, 3.7f, 4.2f};
+  for (uint8_t i = 0; i < 4; ++i)
+  {
+    rig.sim.setBatteryVolts(supplies[i]);
+    shim::advanceUs(30000);
+    CHECK(rig.ecg.readBatteryVoltage(3, volts));
+    CHECK_NEAR(volts, supplies[i], 1e-4); // a few LSBs of 2.4 V / ADC_MAX
+  }
+
+  // a different ADC_MAX (R2 = 8 at 400 SPS) and reference
+  CHECK(rig.ecg.setSamplingRate(ADS1293::SamplingRate::SPS_400));
+  rig.sim.setVref(2.5f);
+  rig.sim.setBatteryVolts(3.3f);
+  shim::advanceUs(30000);
+  CHECK(rig.ecg.readBatteryVoltage(3, volts, 2.5f));
+  CHECK_NEAR(volts, 3.3, 1e-4);
+
+  // the code saturates at 2 * VREF
+  rig.sim.setBatteryVolts(5.5f);
+  shim::advanceUs(30000);
+  CHECK(rig.ecg.readBatteryVoltage(3, volts, 2.5f));
+  CHECK_NEAR(volts, 5.0, 1e-4);
+
+  CHECK(rig.ecg.enableBatteryMonitor(3, false));
+  CHECK_EQ(rig.sim.reg(FLEX_VBAT_CN), 0x00);
+  CHECK_EQ(rig.sim.reg(AFE_SHDN_CN) & 0x04, 0x00);
+}
+
+static uint32_t frameBusTimeNs(uint32_t clockHz, uint32_t &bytes, uint32_t &transactions)
+{
+  TestRig rig(clockHz);
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  const uint32_t bytesBefore = rig.bus.bytes();
+  const uint32_t transactionsBefore = rig.bus.transactions();
+  const uint32_t ns = rig.ecg.measureFrameBusTime(32);
+  bytes = rig.bus.bytes() - bytesBefore;
+  transactions = rig.bus.transactions() - transactionsBefore;
+  return ns;
+}
+
+static void testFrameBusTime()
+{
+  uint32_t bytes = 0, transactions = 0;
+  const uint32_t fast = frameBusTimeNs(8000000, bytes, transactions);
+  CHECK_EQ(bytes, 32 * 10);
+  CHECK_EQ(transactions, 32);
+  const uint32_t slow = frameBusTimeNs(4000000, bytes, transactions);
+  CHECK_EQ(bytes, 32 * 10);
+
+  // 1 us per byte at 8 MHz, 2 us at 4 MHz, plus the same pin and call
+  // overhead at both clocks: the difference is exactly 10 bytes
+  CHECK(fast >= 10000);
+  CHECK(fast < 11000);
+  CHECK_EQ(slow - fast, 10 * 1000);
+  benchResult("diagnostics", "frame_bus_us_8mhz", fast / 1000.0, "us");
+
+  // not while acquiring, and not for zero reads
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  CHECK_EQ(rig.ecg.measureFrameBusTime(0), 0);
+  static ADS1293::Samples ring[8];
+  CHECK(rig.ecg.startAcquisition(ring, 8));
+  CHECK_EQ(rig.ecg.measureFrameBusTime(), 0);
+  rig.ecg.stopAcquisition();
+  CHECK(rig.ecg.measureFrameBusTime() > 0);
+}
+
+int main()
+{
+  testBattery();
+  testFrameBusTime();
+  return testResult("test_diagnostics");
+}
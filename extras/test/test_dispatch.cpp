@@ -0,0 +1,127 @@
+// Frame dispatcher: push sinks get every frame in order across the buffer
+// wrap, a slow pull sink loses only its own oldest frames, and frames lost
+// upstream (acquisition ring overruns reported by readFrames()) are counted
+// for every sink, visible to a push handler by the time the frames after
+// the gap arrive.
+
+#include "test_common.h"
+#include "protocentral_ads1293_dispatch.h"
+
+struct PushSink {
+  ADS1293Dispatcher *dispatcher = nullptr;
+  int8_t id = -1;
+  std::vector<uint32_t> indices;
+  uint32_t calls = 0;
+  uint32_t missedAtGap = 0; // missed() when the first gap arrived
+  uint32_t gaps = 0;
+};
+
+static void onBlock(const ADS1293::Samples *frames, size_t count, void *context)
+{
+  PushSink &s = *static_cast<PushSink *>(context);
+  ++s.calls;
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (!s.indices.empty() && frames[i].index != s.indices.back() + 1 && s.gaps++ == 0)
+      s.missedAtGap = s.dispatcher->missed(s.id);
+    s.indices.push_back(frames[i].index);
+  }
+}
+
+static void testFanOut()
+{
+  TestRig rig;
+  static ADS1293::Samples history[16];
+  ADS1293Dispatcher dispatcher(rig.ecg, history, 16);
+  PushSink push;
+  push.dispatcher = &dispatcher;
+  push.id = dispatcher.subscribe(onBlock, &push);
+  const int8_t pull = dispatcher.subscribe();
+  CHECK(push.id >= 0);
+  CHECK(pull >= 0 && pull != push.id);
+
+  ADS1293::Samples in[40];
+  for (uint32_t i = 0; i < 40; ++i)
+    in[i].index = i;
+  CHECK_EQ(dispatcher.publish(in, 10), 10);
+  CHECK_EQ(dispatcher.available(pull), 10);
+  CHECK_EQ(dispatcher.publish(in + 10, 30), 30); // laps the 16-frame history
+  CHECK_EQ(push.indices.size(), 40);
+  bool ordered = true;
+  for (uint32_t i = 0; i < push.indices.size(); ++i)
+    ordered &= push.indices[i] == i;
+  CHECK(ordered);
+
+  // the pull sink keeps the newest 16
+  CHECK_EQ(dispatcher.dropped(pull), 24);
+  CHECK_EQ(dispatcher.available(pull), 16);
+  const ADS1293::Samples *block;
+  size_t n = dispatcher.peek(pull, block);
+  CHECK(n > 0 && block[0].index == 24);
+  dispatcher.consume(pull, n);
+  n = dispatcher.peek(pull, block);
+  dispatcher.consume(pull, n);
+  CHECK_EQ(dispatcher.available(pull), 0);
+  CHECK_EQ(dispatcher.dropped(push.id), 0);
+  CHECK_EQ(dispatcher.missed(push.id), 0);
+
+  // publish() with frames lost before them
+  CHECK_EQ(dispatcher.publish(in, 1, true), 1);
+  CHECK_EQ(dispatcher.missed(push.id), 1);
+  CHECK_EQ(dispatcher.missed(pull), 1);
+  dispatcher.unsubscribe(pull);
+  CHECK_EQ(dispatcher.missed(pull), 0);
+  CHECK_EQ(dispatcher.sinks(), 1);
+}
+
+static void testRingOverrun()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  static ADS1293::Samples ring[8];
+  CHECK(rig.ecg.startAcquisition(ring, 8));
+
+  static ADS1293::Samples history[64];
+  ADS1293Dispatcher dispatcher(rig.ecg, history, 64);
+  PushSink push;
+  push.dispatcher = &dispatcher;
+  push.id = dispatcher.subscribe(onBlock, &push);
+  const int8_t pull = dispatcher.subscribe();
+
+  // polled often enough: nothing lost
+  for (uint16_t ms = 0; ms < 200; ms += 5)
+  {
+    shim::advanceUs(5000);
+    dispatcher.poll();
+    dispatcher.consume(pull, dispatcher.available(pull));
+  }
+  CHECK(push.indices.size() > 150);
+  CHECK_EQ(dispatcher.missed(push.id), 0);
+  CHECK_EQ(push.gaps, 0);
+
+  // 20 ms between polls at 853 SPS overruns the 8-frame ring: the poll
+  // that drains it reports the loss, the frames after the gap follow
+  shim::advanceUs(20000);
+  CHECK_EQ(dispatcher.poll(), 8);
+  CHECK_EQ(dispatcher.missed(push.id), 1);
+  CHECK_EQ(dispatcher.missed(pull), 1);
+  CHECK_EQ(push.gaps, 0);
+  const int8_t late = dispatcher.subscribe();
+  CHECK_EQ(dispatcher.missed(late), 0);
+  shim::advanceUs(5000);
+  CHECK(dispatcher.poll() > 0);
+  CHECK_EQ(push.gaps, 1);
+  CHECK_EQ(push.missedAtGap, 1);
+  CHECK_EQ(dispatcher.missed(push.id), 1);
+  CHECK_EQ(dispatcher.missed(late), 0);
+  CHECK_EQ(dispatcher.dropped(pull), 0);
+  rig.ecg.stopAcquisition();
+}
+
+int main()
+{
+  testFanOut();
+  testRingOverrun();
+  return testResult("test_dispatch");
+}
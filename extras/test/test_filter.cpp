@@ -0,0 +1,240 @@
+// Fixed-point filter chain: the 50 Hz notch, baseline high-pass and
+// low-pass shape synthetic tones as designed, block processing matches
+// per-sample processing, and the per-sample cost is reported. The
+// resampler produces L/M outputs per input on an evenly spaced output
+// clock, keeps a passband tone in phase once its FIR delay is allowed
+// for, and suppresses a tone above the output Nyquist frequency.
+
+#include <math.h>
+
+#include "test_common.h"
+#include "protocentral_ads1293_filter.h"
+
+static const double PI = 3.14159265358979323846;
+
+// Peak output for a tone of `amplitude` at `hz`, after a 6 s settle.
+static double peakResponse(ADS1293FilterChain &chain, double fs, double hz, double amplitude, double offset = 0.0)
+{
+  chain.reset();
+  double peak = 0.0;
+  const uint32_t settle = static_cast<uint32_t>(6.0 * fs);
+  for (uint32_t n = 0; n < settle + static_cast<uint32_t>(fs); ++n)
+  {
+    const double x = offset + amplitude * sin(2.0 * PI * hz * n / fs);
+    const int32_t y = chain.process(0, static_cast<int32_t>(lround(x)));
+    if (n >= settle && fabs(static_cast<double>(y)) > peak)
+      peak = fabs(static_cast<double>(y));
+  }
+  return peak;
+}
+
+static double db(double out, double in)
+{
+  return 20.0 * log10(out / in);
+}
+
+static void testResponse()
+{
+  const double fs = 400.0;
+  ADS1293FilterChain chain;
+  ADS1293FilterConfig cfg; // 0.5 Hz HP, 40 Hz LP, 50 Hz notch
+  CHECK(chain.configure(ADS1293::SamplingRate::SPS_400, cfg));
+  CHECK_EQ(chain.stages(), 3);
+
+  const double a = 100000.0;
+  CHECK(fabs(db(peakResponse(chain, fs, 10.0, a), a)) < 1.0);            // passband
+  CHECK(db(peakResponse(chain, fs, 50.0, a), a) < -30.0);                 // mains
+  CHECK(db(peakResponse(chain, fs, 120.0, a), a) < -15.0);                // above LP
+  CHECK(db(peakResponse(chain, fs, 0.05, a), a) < -20.0);                 // wander
+  CHECK(fabs(db(peakResponse(chain, fs, 10.0, a, 2000000.0), a)) < 1.0); // DC offset
+
+  // 60 Hz mains, notch alone
+  cfg.notchHz = 60.0f;
+  cfg.lowPassHz = 0.0f;
+  CHECK(chain.configure(fs, cfg));
+  CHECK(db(peakResponse(chain, fs, 60.0, a), a) < -30.0);
+  CHECK(fabs(db(peakResponse(chain, fs, 50.0, a), a)) < 3.0);
+
+  // stages that do not fit below fs/2
+  CHECK(!chain.configure(100.0f, cfg));
+  ADS1293FilterConfig off;
+  off.highPassHz = off.lowPassHz = off.notchHz = 0.0f;
+  CHECK(chain.configure(fs, off));
+  CHECK_EQ(chain.stages(), 0);
+  CHECK_EQ(chain.process(0, 12345), 12345);
+}
+
+static void testBlock()
+{
+  ADS1293FilterChain a, b;
+  ADS1293FilterConfig cfg;
+  CHECK(a.configure(1600.0f, cfg));
+  CHECK(b.configure(1600.0f, cfg));
+
+  static ADS1293::Samples frames[1600];
+  static int32_t ch2[1600];
+  for (uint16_t n = 0; n < 1600; ++n)
+  {
+    frames[n].ch1 = static_cast<int32_t>(300000.0 * sin(2.0 * PI * 7.0 * n / 1600.0));
+    frames[n].ch2 = static_cast<int32_t>(80000.0 * sin(2.0 * PI * 50.0 * n / 1600.0)) + 1000000;
+    frames[n].ch3 = -static_cast<int32_t>(n) * 100;
+    ch2[n] = frames[n].ch2;
+  }
+  bool same = true;
+  for (uint16_t n = 0; n < 1600; ++n)
+  {
+    const int32_t y1 = a.process(0, frames[n].ch1);
+    const int32_t y2 = a.process(1, frames[n].ch2);
+    const int32_t y3 = a.process(2, frames[n].ch3);
+    ADS1293::Samples s = frames[n];
+    b.process(s);
+    if (s.ch1 != y1 || s.ch2 != y2 || s.ch3 != y3)
+      same = false;
+  }
+  CHECK(same);
+
+  // block entry points give the same samples
+  a.reset();
+  b.reset();
+  ADS1293::Samples copy[1600];
+  memcpy(copy, frames, sizeof(copy));
+  a.processBlock(copy, 1600);
+  b.processBlock(1, ch2, 1600);
+  same = true;
+  for (uint16_t n = 0; n < 1600; ++n)
+    if (copy[n].ch2 != ch2[n])
+      same = false;
+  CHECK(same);
+}
+
+// 400 SPS input frames: a tone on ch1, the frame number in status and
+// pace1, timestamps on the input clock.
+static void toneFrames(ADS1293::Samples *frames, uint32_t first, uint32_t n, double hz, double amplitude)
+{
+  for (uint32_t k = 0; k < n; ++k)
+  {
+    const uint32_t i = first + k;
+    ADS1293::Samples &f = frames[k];
+    f = ADS1293::Samples();
+    f.ch1 = static_cast<int32_t>(lround(amplitude * sin(2.0 * PI * hz * i / 400.0)));
+    f.status = static_cast<uint8_t>(i);
+    f.pace1 = static_cast<uint16_t>(i);
+    f.index = i;
+    f.timestampUs = 1000000u + i * 2500u;
+    f.ok = true;
+  }
+}
+
+static void testResamplerClock()
+{
+  ADS1293Resampler rs;
+  CHECK(rs.configure(ADS1293::SamplingRate::SPS_400, 250.0f));
+  CHECK_EQ(rs.interpolation(), 5);
+  CHECK_EQ(rs.decimation(), 8);
+  CHECK_NEAR(rs.outputRateHz(), 250.0, 1e-3);
+
+  // 10 s in blocks of 64, processed in place
+  static ADS1293::Samples block[64];
+  uint32_t outputs = 0;
+  bool indexed = true, spaced = true, nearest = true;
+  uint32_t lastUs = 0;
+  for (uint32_t first = 0; first < 4000; first += 64)
+  {
+    const uint32_t n = first + 64 <= 4000 ? 64 : 4000 - first;
+    toneFrames(block, first, n, 10.0, 100000.0);
+    const size_t produced = rs.process(block, n, block);
+    for (size_t k = 0; k < produced; ++k)
+    {
+      const ADS1293::Samples &o = block[k];
+      indexed &= o.index == outputs && o.ok;
+      // one output every 4 ms, on the input clock at 5 outputs per 8 inputs
+      spaced &= outputs == 0 || o.timestampUs - lastUs == 4000u;
+      spaced &= o.timestampUs == 1000000u + outputs * 4000u;
+      // the flags are those of the input frame at or just before it
+      const uint32_t frame = (o.timestampUs - 1000000u) / 2500u;
+      nearest &= o.status == static_cast<uint8_t>(frame) && o.pace1 == static_cast<uint16_t>(frame);
+      lastUs = o.timestampUs;
+      ++outputs;
+    }
+  }
+  CHECK_EQ(outputs, 2500);
+  CHECK(indexed);
+  CHECK(spaced);
+  CHECK(nearest);
+
+  rs.reset();
+  toneFrames(block, 0, 8, 10.0, 100000.0);
+  CHECK_EQ(rs.process(block, 8, block), 5);
+  CHECK_EQ(block[0].index, 0);
+}
+
+// Largest |ch1| error against the input tone at each output's timestamp less
+// the FIR delay, and the largest |ch1|, after a one second settle.
+static void resampleTone(double hz, double amplitude, double &maxError, double &peak)
+{
+  ADS1293Resampler rs;
+  CHECK(rs.configure(400.0f, 5, 8));
+  const double delayUs = (5.0 * ADS1293Resampler::TAPS - 1.0) / (2.0 * 5.0) * 2500.0;
+  static ADS1293::Samples in[4000], out[4000];
+  toneFrames(in, 0, 4000, hz, amplitude);
+  const size_t n = rs.process(in, 4000, out);
+  maxError = peak = 0.0;
+  for (size_t k = 250; k < n; ++k)
+  {
+    const double t = (out[k].timestampUs - 1000000.0 - delayUs) * 1e-6;
+    const double expected = amplitude * sin(2.0 * PI * hz * t);
+    maxError = fmax(maxError, fabs(out[k].ch1 - expected));
+    peak = fmax(peak, fabs(static_cast<double>(out[k].ch1)));
+  }
+}
+
+static void testResamplerResponse()
+{
+  double error, peak;
+  // passband: in phase with the input at timestamp - delay
+  resampleTone(10.0, 100000.0, error, peak);
+  CHECK_NEAR(db(peak, 100000.0), 0.0, 0.1);
+  CHECK(error < 1000.0);
+  printf("resampler 10 Hz: max error %.0f of 100000\n", error);
+
+  // 160 Hz is above the 125 Hz output Nyquist frequency and would alias
+  // to 90 Hz
+  resampleTone(160.0, 100000.0, error, peak);
+  const double stop = db(peak, 100000.0);
+  printf("resampler 160 Hz: %.1f dB\n", stop);
+  CHECK(stop < -40.0);
+  benchResult("resampler", "stopband_160hz", stop, "dB");
+}
+
+static void benchFilter()
+{
+  ADS1293FilterChain chain;
+  ADS1293FilterConfig cfg;
+  CHECK(chain.configure(1600.0f, cfg));
+  static ADS1293::Samples frames[1600];
+  for (uint16_t n = 0; n < 1600; ++n)
+    frames[n].ch1 = frames[n].ch2 = frames[n].ch3 = static_cast<int32_t>(200000.0 * sin(2.0 * PI * n / 160.0));
+
+  const uint32_t rounds = 200;
+  volatile int32_t sink = 0; // keeps the loop
+  HostTimer timer;
+  for (uint32_t r = 0; r < rounds; ++r)
+  {
+    chain.processBlock(frames, 1600);
+    sink = frames[r].ch1;
+  }
+  const double ns = timer.elapsedNs();
+  benchResult("filter", "ns_per_sample", ns / (rounds * 1600.0 * 3.0), "ns");
+  benchResult("filter", "stages", chain.stages(), "count");
+  (void)sink;
+}
+
+int main()
+{
+  testResponse();
+  testBlock();
+  testResamplerClock();
+  testResamplerResponse();
+  benchFilter();
+  return testResult("test_filter");
+}
@@ -0,0 +1,215 @@
+// Batched frame reads: readFrames() reports ring overruns through `missed`
+// once per overrun, reads a pending frame in polled mode, and
+// captureFrames() streams consecutive frames in one DATA_LOOP transaction.
+// The block decoders give what decodeFrame() and rawToVoltage() give frame
+// by frame, for random and full-scale codes, and their cost is reported.
+
+#include <math.h>
+
+#include "test_common.h"
+
+// ECG codes (channel << 20) | index, so every sample names its frame.
+class IndexSim : public ADS1293Sim {
+public:
+  using ADS1293Sim::ADS1293Sim;
+  uint32_t ecgCode(uint8_t channel, uint32_t index, double t) override
+  {
+    (void)t;
+    return (static_cast<uint32_t>(channel) << 20) | index;
+  }
+};
+
+struct IndexRig {
+  TestRig::ShimReset shimReset;
+  ADS1293SimBus bus;
+  IndexSim sim;
+  ADS1293 ecg;
+
+  IndexRig() : sim(bus, TestRig::CS_PIN, TestRig::DRDY_PIN), ecg(TestRig::DRDY_PIN, TestRig::CS_PIN, &bus, 8000000)
+  {
+    ecg.begin();
+    shim::advanceUs(20000);
+  }
+};
+
+static void testMissed()
+{
+  IndexRig rig;
+  CHECK(rig.ecg.begin3LeadECG());
+  ADS1293::Samples ring[4];
+  ADS1293::Samples out[8];
+  CHECK(rig.ecg.startAcquisition(ring, 4));
+
+  // 20 ms at 853 SPS: 17 frames into a ring of 4
+  shim::advanceUs(20000);
+  bool missed = false;
+  CHECK_EQ(rig.ecg.readFrames(out, 8, &missed), 4);
+  CHECK(missed);
+  CHECK(rig.ecg.overrunCount() > 0);
+  CHECK_EQ(rig.ecg.ringHighWater(), 4);
+  // the ring keeps the oldest frames
+  CHECK_EQ(out[3].ch1 - out[0].ch1, 3);
+
+  // reported once; a drain in time clears it
+  shim::advanceUs(3000);
+  CHECK(rig.ecg.readFrames(out, 8, &missed) >= 2);
+  CHECK(!missed);
+  CHECK_EQ(rig.ecg.readFrames(out, 8, &missed), 0);
+  CHECK(!missed);
+  rig.ecg.stopAcquisition();
+
+  // polled: one frame when DRDY is low, nothing otherwise
+  shim::advanceUs(1200);
+  CHECK_EQ(rig.ecg.readFrames(out, 8, &missed), 1);
+  CHECK(!missed);
+  CHECK_EQ(out[0].ch2 >> 20, 2);
+  CHECK_EQ(rig.ecg.readFrames(out, 8), 0);
+  CHECK_EQ(rig.ecg.readFrames(nullptr, 8), 0);
+}
+
+static void testCapture()
+{
+  IndexRig rig;
+  CHECK(rig.ecg.begin3LeadECG());
+  shim::advanceUs(10000); // past the initial DRDY mask
+
+  ADS1293::Samples out[32];
+  rig.bus.resetCounters();
+  const uint32_t overwritten = rig.sim.framesOverwritten();
+  CHECK_EQ(rig.ecg.captureFrames(out, 32), 32);
+  // CH_CNFG read from the cache, then one transaction for the whole block
+  CHECK_EQ(rig.bus.transactions(), 1);
+  CHECK_EQ(rig.bus.bytes(), 1 + 32 * 6);
+  CHECK_EQ(rig.sim.framesOverwritten(), overwritten);
+  bool consecutive = true;
+  for (uint8_t i = 1; i < 32; ++i)
+    if (out[i].ch1 - out[i - 1].ch1 != 1 || out[i].ch2 - out[i - 1].ch2 != 1 || out[i].ch3 != 0)
+      consecutive = false;
+  CHECK(consecutive);
+  CHECK(out[0].ok && out[31].ok);
+
+  // the timeout ends a capture on a stopped device
+  CHECK(rig.ecg.applyGlobalConfig(GlobalConfig::Standby));
+  const uint64_t start = shim::nowNs();
+  CHECK_EQ(rig.ecg.captureFrames(out, 4, 20), 0);
+  CHECK_NEAR((shim::nowNs() - start) / 1000000.0, 20.0, 1.0);
+
+  // not while acquisition owns the data
+  ADS1293::Samples ring[4];
+  CHECK(rig.ecg.applyGlobalConfig(GlobalConfig::Start));
+  CHECK(rig.ecg.startAcquisition(ring, 4));
+  CHECK_EQ(rig.ecg.captureFrames(out, 4), 0);
+  rig.ecg.stopAcquisition();
+}
+
+// Raw frames: the full-scale, zero and sign-boundary codes on every
+// channel first (channel k of frame f gets EDGES[f + k]), then random ones.
+static std::vector<uint8_t> rawFrames(size_t frames)
+{
+  static const uint32_t EDGES[] = {0x7FFFFF, 0x800000, 0x800001, 0xFFFFFF, 0x000000, 0x000001, 0x400000, 0xC00000};
+  const size_t edges = sizeof(EDGES) / sizeof(EDGES[0]);
+  std::vector<uint8_t> raw(frames * 9);
+  uint32_t x = 12345;
+  for (size_t i = 0; i < frames * 3; ++i)
+  {
+    x = x * 1664525u + 1013904223u;
+    const uint32_t code = i < edges * 3 ? EDGES[(i / 3 + i % 3) % edges] : (x >> 8);
+    raw[3 * i] = static_cast<uint8_t>(code >> 16);
+    raw[3 * i + 1] = static_cast<uint8_t>(code >> 8);
+    raw[3 * i + 2] = static_cast<uint8_t>(code);
+  }
+  return raw;
+}
+
+static void testBlockDecode()
+{
+  const size_t frames = 4096;
+  const std::vector<uint8_t> raw = rawFrames(frames);
+  std::vector<int32_t> c1(frames), c2(frames), c3(frames);
+  ADS1293::decodeFrames(raw.data(), frames, c1.data(), c2.data(), c3.data());
+
+  const float vref = 2.4f, gain = 1.0f;
+  const int32_t fullscale = 0xC3500; // ADC_MAX of the default rate
+  const float lsb = ADS1293::voltsPerLsb(vref, fullscale, gain);
+  std::vector<float> v1(frames), v2(frames), v3(frames);
+  ADS1293::decodeFrames(raw.data(), frames, v1.data(), v2.data(), v3.data(), lsb);
+
+  bool codes = true, volts = true;
+  bool sawPositive = false, sawNegative = false;
+  for (size_t i = 0; i < frames; ++i)
+  {
+    int32_t a, b, c;
+    ADS1293::decodeFrame(raw.data() + 9 * i, a, b, c);
+    codes &= c1[i] == a && c2[i] == b && c3[i] == c;
+    sawPositive |= a == 0x7FFFFF;
+    sawNegative |= a == -0x800000;
+    const int32_t code[3] = {a, b, c};
+    const float got[3] = {v1[i], v2[i], v3[i]};
+    for (uint8_t k = 0; k < 3; ++k)
+    {
+      // one multiply against a divide and two multiplies: a few float ulps
+      const float want = ADS1293::rawToVoltage(code[k], vref, fullscale, gain);
+      volts &= fabsf(got[k] - want) <= 4.0f * 1.2e-7f * fabsf(want);
+    }
+  }
+  CHECK(sawPositive);
+  CHECK(sawNegative);
+  CHECK(codes);
+  CHECK(volts);
+  CHECK_EQ(c1[1], -0x800000); // 0x800000 is the most negative code
+  CHECK_EQ(c2[2], -1);
+  CHECK_NEAR(ADS1293::voltsPerLsb(vref, 0, gain), ADS1293::rawToVoltage(1, vref, 0, gain), 1e-12);
+
+  // a skipped channel is left alone
+  std::vector<int32_t> untouched(frames, 7);
+  ADS1293::decodeFrames(raw.data(), frames, c1.data(), nullptr, untouched.data());
+  CHECK_EQ(untouched[0], c3[0]);
+  std::vector<float> skipped(frames, 7.0f);
+  ADS1293::decodeFrames(raw.data(), frames, nullptr, skipped.data(), nullptr, lsb);
+  CHECK_EQ(skipped[5], v2[5]);
+}
+
+static void benchBlockDecode()
+{
+  const size_t frames = 4096;
+  const std::vector<uint8_t> raw = rawFrames(frames);
+  std::vector<float> v1(frames), v2(frames), v3(frames);
+  const float lsb = ADS1293::voltsPerLsb();
+  const uint32_t rounds = 200;
+  volatile float sink = 0.0f; // keeps the loops
+
+  HostTimer block;
+  for (uint32_t r = 0; r < rounds; ++r)
+  {
+    ADS1293::decodeFrames(raw.data(), frames, v1.data(), v2.data(), v3.data(), lsb);
+    sink = v1[r];
+  }
+  const double blockNs = block.elapsedNs() / (rounds * static_cast<double>(frames));
+
+  HostTimer single;
+  for (uint32_t r = 0; r < rounds; ++r)
+  {
+    for (size_t i = 0; i < frames; ++i)
+    {
+      int32_t a, b, c;
+      ADS1293::decodeFrame(raw.data() + 9 * i, a, b, c);
+      v1[i] = ADS1293::rawToVoltage(a);
+      v2[i] = ADS1293::rawToVoltage(b);
+      v3[i] = ADS1293::rawToVoltage(c);
+    }
+    sink = v1[r];
+  }
+  const double singleNs = single.elapsedNs() / (rounds * static_cast<double>(frames));
+  (void)sink;
+  benchResult("decode", "block_volts_ns_per_frame", blockNs, "ns");
+  benchResult("decode", "single_volts_ns_per_frame", singleNs, "ns");
+}
+
+int main()
+{
+  testMissed();
+  testCapture();
+  testBlockDecode();
+  benchBlockDecode();
+  return testResult("test_frames");
+}
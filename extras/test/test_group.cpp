@@ -0,0 +1,172 @@
+// ADS1293Group with two simulated devices on one bus: merged frames are
+// anchored on the master's DRDY, a slave outside the skew window is
+// reported missed (never paired with the next master frame), a leading
+// slave is waited for, a late poll counts the frames the group lost, and
+// the wide pace layout goes through each device's own read path.
+
+#include "test_common.h"
+#include "protocentral_ads1293_group.h"
+
+// ECG codes (channel << 20) | index, so merged frames can be checked for
+// alignment.
+class IndexSim : public ADS1293Sim {
+public:
+  using ADS1293Sim::ADS1293Sim;
+  uint32_t ecgCode(uint8_t channel, uint32_t index, double t) override
+  {
+    (void)t;
+    return (static_cast<uint32_t>(channel) << 20) | index;
+  }
+};
+
+static const uint8_t MASTER_CS = 10, MASTER_DRDY = 2;
+static const uint8_t SLAVE_CS = 9, SLAVE_DRDY = 5;
+
+struct GroupRig {
+  TestRig::ShimReset shimReset;
+  ADS1293SimBus bus;
+  IndexSim masterSim, slaveSim;
+  ADS1293 master, slave;
+  ADS1293Group group;
+
+  GroupRig(uint32_t masterPhaseNs, uint32_t slavePhaseNs, bool pace = false)
+      : masterSim(bus, MASTER_CS, MASTER_DRDY), slaveSim(bus, SLAVE_CS, SLAVE_DRDY),
+        master(MASTER_DRDY, MASTER_CS, &bus, 8000000), slave(SLAVE_DRDY, SLAVE_CS, &bus, 8000000)
+  {
+    master.begin();
+    slave.begin();
+    shim::advanceUs(20000);
+    CHECK(master.begin3LeadECG());
+    CHECK(slave.begin3LeadECG());
+    CHECK(master.enablePaceReadout(pace));
+    CHECK(slave.enablePaceReadout(pace));
+    masterSim.setPhaseNs(masterPhaseNs);
+    slaveSim.setPhaseNs(slavePhaseNs);
+    CHECK(group.add(master));
+    CHECK(group.add(slave));
+    CHECK(!group.add(slave));
+    CHECK(group.synchronize());
+    shim::advanceUs(10000); // past the initial DRDY mask
+  }
+};
+
+struct RunResult {
+  uint32_t merged = 0;
+  uint32_t withSlave = 0;
+  uint32_t misaligned = 0;
+  uint32_t withoutMaster = 0;
+  uint32_t paceMissing = 0;
+};
+
+static uint32_t frameIndex(const ADS1293::Samples &s)
+{
+  return static_cast<uint32_t>(s.ch1) & 0xFFFFFu;
+}
+
+static RunResult run(GroupRig &rig, uint32_t ms, uint32_t pollEveryUs = 25)
+{
+  RunResult r;
+  ADS1293Group::Frame frame;
+  const uint64_t end = shim::nowNs() + ms * 1000000ull;
+  while (shim::nowNs() < end)
+  {
+    shim::advanceUs(pollEveryUs);
+    if (!rig.group.poll(frame))
+      continue;
+    ++r.merged;
+    if (!frame.device[0].ok)
+      ++r.withoutMaster;
+    if (frame.device[1].ok)
+    {
+      ++r.withSlave;
+      if (frameIndex(frame.device[1]) != frameIndex(frame.device[0]))
+        ++r.misaligned;
+      if (!frame.device[1].pace1)
+        ++r.paceMissing;
+    }
+  }
+  return r;
+}
+
+static void testAligned()
+{
+  GroupRig rig(0, 20000);
+  const RunResult r = run(rig, 100);
+  CHECK_NEAR(r.merged, 85, 1);
+  CHECK_EQ(r.withSlave, r.merged);
+  CHECK_EQ(r.misaligned, 0);
+  CHECK_EQ(rig.group.missedFrames(0), 0);
+  CHECK_EQ(rig.group.missedFrames(1), 0);
+  CHECK_NEAR(rig.group.maxSkewUs(1), 20, 2);
+}
+
+static void testSlaveOutsideWindow()
+{
+  // 300 us behind the master, well outside the 50 us window
+  GroupRig rig(0, 300000);
+  run(rig, 10); // the frames both held since the start
+  rig.group.resetStats();
+  const RunResult r = run(rig, 100);
+  CHECK_NEAR(r.merged, 85, 1);
+  CHECK_EQ(r.withoutMaster, 0);
+  CHECK_EQ(r.withSlave, 0);
+  CHECK_EQ(rig.group.missedFrames(0), 0);
+  CHECK_EQ(rig.group.missedFrames(1), r.merged);
+  CHECK_EQ(rig.group.framesRead(), r.merged);
+
+  // a wider window picks it up again, aligned
+  rig.group.setSkewWindow(400);
+  rig.group.resetStats();
+  const RunResult wide = run(rig, 100);
+  CHECK_NEAR(wide.merged, 85, 1);
+  CHECK_EQ(wide.withSlave, wide.merged);
+  CHECK_EQ(wide.misaligned, 0);
+  CHECK_EQ(rig.group.missedFrames(1), 0);
+}
+
+static void testSlaveLeads()
+{
+  GroupRig rig(20000, 0);
+  const RunResult r = run(rig, 100);
+  CHECK_NEAR(r.merged, 85, 1);
+  CHECK_EQ(r.withSlave, r.merged);
+  CHECK_EQ(r.misaligned, 0);
+  CHECK_EQ(rig.group.missedFrames(1), 0);
+  CHECK_NEAR(rig.group.maxSkewUs(1), 20, 2);
+}
+
+static void testLatePoll()
+{
+  GroupRig rig(0, 10000);
+  run(rig, 20);
+  CHECK_EQ(rig.group.missedFrames(0), 0);
+
+  // five periods without a poll: the devices hold only their newest frame
+  shim::advanceUs(5 * 1172);
+  ADS1293Group::Frame frame;
+  CHECK(rig.group.poll(frame));
+  CHECK(frame.device[0].ok && frame.device[1].ok);
+  CHECK_EQ(frameIndex(frame.device[0]), frameIndex(frame.device[1]));
+  CHECK_NEAR(rig.group.missedFrames(0), 4, 1);
+  CHECK_EQ(rig.group.missedFrames(1), rig.group.missedFrames(0));
+}
+
+static void testPaceLayout()
+{
+  GroupRig rig(0, 10000, true);
+  const RunResult r = run(rig, 50);
+  CHECK(r.merged > 40);
+  CHECK_EQ(r.withSlave, r.merged);
+  CHECK_EQ(r.misaligned, 0);
+  CHECK_EQ(r.paceMissing, 0);
+}
+
+int main()
+{
+  testAligned();
+  testSlaveOutsideWindow();
+  testSlaveLeads();
+  testLatePoll();
+  testPaceLayout();
+  return testResult("test_group");
+}
@@ -0,0 +1,130 @@
+// Hot-path metrics (built with ADS1293_ENABLE_METRICS): polled reads count
+// their frames, bytes and bus time, register access only its bytes, the
+// interrupt path counts edges, latency and ring drops, coalesced edges in
+// deferred mode count as missed, and resetMetrics() clears everything.
+
+#include <string>
+
+#include "test_common.h"
+
+static_assert(ADS1293_ENABLE_METRICS, "test_metrics needs the metrics build of the library");
+
+static const uint32_t FRAME_READ_BYTES = 1 + 9; // command byte, three channels
+
+static uint32_t latencyTotal(const ADS1293::Metrics &m)
+{
+  uint32_t n = 0;
+  for (uint8_t i = 0; i < ADS1293::Metrics::LATENCY_BUCKETS; ++i)
+    n += m.latency[i];
+  return n;
+}
+
+static bool allZero(const ADS1293::Metrics &m)
+{
+  return m.drdyEdges == 0 && m.framesRead == 0 && m.framesMissed == 0 && m.ringDrops == 0 && m.readErrors == 0 &&
+         latencyTotal(m) == 0 && m.maxLatencyUs == 0 && m.busBytes == 0 && m.busUs == 0 && m.decodes == 0 &&
+         m.decodeUs == 0;
+}
+
+static void testPolled()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  shim::advanceUs(10000); // past the initial DRDY mask
+  CHECK(!allZero(rig.ecg.getMetrics()));
+  rig.ecg.resetMetrics();
+  CHECK(allZero(rig.ecg.getMetrics()));
+
+  // register access: bytes, no bus time
+  CHECK_EQ(rig.ecg.readDeviceID(), ADS1293Sim::REVISION);
+  ADS1293::Metrics m = rig.ecg.getMetrics();
+  CHECK_EQ(m.busBytes, 2);
+  CHECK_EQ(m.busUs, 0);
+  rig.ecg.resetMetrics();
+
+  ADS1293::Samples out[1];
+  uint32_t frames = 0;
+  for (uint16_t i = 0; i < 200; ++i)
+  {
+    shim::advanceUs(500);
+    frames += rig.ecg.readFrames(out, 1);
+  }
+  m = rig.ecg.getMetrics();
+  CHECK_NEAR(frames, 86, 1); // 100 ms at 853 SPS, and the frame pending at the start
+  CHECK_EQ(m.framesRead, frames);
+  CHECK_EQ(m.decodes, frames);
+  CHECK_EQ(m.busBytes, frames * FRAME_READ_BYTES);
+  // 10 bytes at 8 MHz is 10 us, plus the calls around the transfer
+  CHECK(m.busUs >= frames * 10);
+  CHECK(m.busUs <= frames * 12);
+  CHECK(m.decodeUs <= frames * 2);
+  CHECK_EQ(m.drdyEdges, 0);
+  CHECK_EQ(latencyTotal(m), 0); // polled reads have no edge to measure from
+  CHECK_EQ(m.readErrors, 0);
+}
+
+static void testInterrupt()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  shim::advanceUs(10000); // past the initial DRDY mask
+  static ADS1293::Samples ring[8];
+  CHECK(rig.ecg.startAcquisition(ring, 8));
+  rig.ecg.resetMetrics();
+  const uint32_t edgesBefore = rig.sim.drdyEdges();
+
+  // 30 ms without a drain overruns the 8-frame ring
+  shim::advanceUs(30000);
+  const uint32_t edges = rig.sim.drdyEdges() - edgesBefore;
+  ADS1293::Metrics m = rig.ecg.getMetrics();
+  CHECK(edges > 20);
+  CHECK_EQ(m.drdyEdges, edges);
+  CHECK_EQ(m.framesRead, edges);
+  CHECK_EQ(m.decodes, 8);
+  CHECK_EQ(m.ringDrops, edges - 8);
+  CHECK_EQ(m.framesMissed, 0);
+  CHECK_EQ(m.busBytes, edges * FRAME_READ_BYTES);
+  // the handler starts reading a few calls after the edge
+  CHECK_EQ(latencyTotal(m), edges);
+  CHECK_EQ(m.latency[0], edges);
+  CHECK(m.maxLatencyUs < 8);
+
+  // deferred: three edges before the loop gets to them are one read and
+  // two missed frames
+  ADS1293::Samples out[8];
+  CHECK_EQ(rig.ecg.readFrames(out, 8), 8);
+  CHECK(rig.ecg.setDeferredReads(true));
+  rig.ecg.resetMetrics();
+  shim::advanceUs(3 * 1172);
+  CHECK_EQ(rig.ecg.readFrames(out, 8), 1);
+  m = rig.ecg.getMetrics();
+  CHECK_EQ(m.drdyEdges, 3);
+  CHECK_EQ(m.framesRead, 1);
+  CHECK_EQ(m.framesMissed, 2);
+  // measured from the last of the three edges
+  CHECK_EQ(latencyTotal(m), 1);
+  CHECK(m.maxLatencyUs < 1172);
+  rig.ecg.stopAcquisition();
+}
+
+static void testDump()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  ByteSink out;
+  CHECK(rig.ecg.dumpDebug(out));
+  const std::string text(out.data.begin(), out.data.end());
+  CHECK(text.find("FRAMES: read=") != std::string::npos);
+  CHECK(text.find("BUS: bytes=") != std::string::npos);
+}
+
+int main()
+{
+  testPolled();
+  testInterrupt();
+  testDump();
+  return testResult("test_metrics");
+}
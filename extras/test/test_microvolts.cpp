@@ -0,0 +1,154 @@
+// Fixed-point microvolt conversion: every code of every ADC_MAX the rate
+// registers can select converts to the exact transfer function value
+// rounded half away from zero, for several reference voltages, and the
+// block forms agree with the single-sample form. The float rawToVoltage()
+// path is within its own rounding of the same value. Conversion cost per
+// sample is reported for both.
+
+#include "test_common.h"
+
+static const uint8_t R2_CODES[] = {0x01, 0x02, 0x04, 0x08};
+static const uint8_t R3_CODES[] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+
+// uV = (code - ADC_MAX / 2) * 4 * VREF / (7 * ADC_MAX), rounded half away
+// from zero, in exact integer arithmetic.
+static int32_t exactMicrovolts(uint32_t code, uint32_t adcMax, uint32_t vrefUv)
+{
+  const uint32_t zero = adcMax / 2;
+  const bool negative = code < zero;
+  const uint64_t a = negative ? zero - code : code - zero;
+  const uint64_t num = a * 4u * vrefUv;
+  const uint64_t den = 7ull * adcMax;
+  const int32_t uv = static_cast<int32_t>((2 * num + den) / (2 * den));
+  return negative ? -uv : uv;
+}
+
+// Program R2 and R3 of channel 1 on a stopped device; returns ADC_MAX.
+static uint32_t selectRates(ADS1293 &ecg, uint8_t r2, uint8_t r3)
+{
+  CHECK(ecg.stageRegister(Register::R2_RATE, r2));
+  CHECK(ecg.stageRegister(Register::R3_RATE_CH1, r3));
+  CHECK(ecg.sync());
+  CHECK(ecg.updateMicrovoltScale());
+  return ecg.ecgAdcMax(1);
+}
+
+static void testExhaustive()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  CHECK(rig.ecg.applyGlobalConfig(GlobalConfig::Standby));
+
+  static const float VREFS[] = {2.4f, 1.25f, 2.5f, 3.3f};
+  std::vector<uint32_t> seen;
+  uint64_t conversions = 0, mismatches = 0, floatOff = 0;
+  static int32_t in[4096], out[4096];
+  for (uint8_t i = 0; i < sizeof(R2_CODES); ++i)
+  {
+    for (uint8_t j = 0; j < sizeof(R3_CODES); ++j)
+    {
+      uint32_t adcMax = selectRates(rig.ecg, R2_CODES[i], R3_CODES[j]);
+      bool known = false;
+      for (size_t k = 0; k < seen.size(); ++k)
+        known |= seen[k] == adcMax;
+      if (known || !adcMax)
+        continue;
+      seen.push_back(adcMax);
+      for (uint8_t v = 0; v < sizeof(VREFS) / sizeof(VREFS[0]); ++v)
+      {
+        CHECK(rig.ecg.setReferenceVoltage(VREFS[v]));
+        const uint32_t vrefUv = static_cast<uint32_t>(VREFS[v] * 1.0e6f + 0.5f);
+        for (uint32_t code = 0; code <= adcMax; ++code)
+        {
+          const int32_t uv = rig.ecg.toMicrovolts(1, static_cast<int32_t>(code));
+          if (uv != exactMicrovolts(code, adcMax, vrefUv))
+            ++mismatches;
+          ++conversions;
+        }
+        // float reference: within one microvolt plus its own rounding
+        for (uint32_t code = 0; code <= adcMax; code += 4099)
+        {
+          const double ref = ADS1293::rawToVoltage(static_cast<int32_t>(code) - static_cast<int32_t>(adcMax / 2),
+                                                 VREFS[v], static_cast<int32_t>(adcMax), 2.0f / 3.5f) * 1.0e6;
+          if (fabs(ref - exactMicrovolts(code, adcMax, vrefUv)) > 1.0 + fabs(ref) * 1e-6)
+            ++floatOff;
+        }
+        // block form
+        const uint32_t base = adcMax / 2 - 2048;
+        for (uint16_t k = 0; k < 4096; ++k)
+          in[k] = static_cast<int32_t>(base + k);
+        rig.ecg.toMicrovolts(1, in, out, 4096);
+        bool same = true;
+        for (uint16_t k = 0; k < 4096; ++k)
+          same &= out[k] == rig.ecg.toMicrovolts(1, in[k]);
+        CHECK(same);
+      }
+    }
+  }
+  printf("%zu ADC_MAX values, %llu conversions, %llu mismatches\n", seen.size(),
+         static_cast<unsigned long long>(conversions), static_cast<unsigned long long>(mismatches));
+  CHECK_EQ(seen.size(), 5); // datasheet tables 8-11
+  CHECK_EQ(mismatches, 0);
+  CHECK_EQ(floatOff, 0);
+}
+
+static void testSamplesAndLimits()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  const uint32_t adcMax = rig.ecg.ecgAdcMax(1);
+  CHECK_EQ(adcMax, rig.sim.adcMax(1));
+
+  ADS1293::Samples s[2];
+  s[0].ch1 = static_cast<int32_t>(adcMax / 2);
+  s[0].ch2 = static_cast<int32_t>(adcMax);
+  s[0].ch3 = 0;
+  s[1].ch1 = s[1].ch2 = s[1].ch3 = static_cast<int32_t>(adcMax / 2 + 1000);
+  rig.ecg.toMicrovolts(s, 2);
+  CHECK_EQ(s[0].ch1, 0);
+  CHECK_EQ(s[0].ch2, exactMicrovolts(adcMax, adcMax, 2400000));
+  CHECK_EQ(s[1].ch1, exactMicrovolts(adcMax / 2 + 1000, adcMax, 2400000));
+
+  // full scale is +-VREF / 3.5
+  CHECK_NEAR(s[0].ch2, 2.4e6 / 3.5, 2);
+  CHECK(!rig.ecg.setReferenceVoltage(0.0f));
+  CHECK(!rig.ecg.setReferenceVoltage(4.5f));
+  CHECK_EQ(rig.ecg.toMicrovolts(0, 123), 0);
+  CHECK_EQ(rig.ecg.toMicrovolts(4, 123), 0);
+}
+
+static void benchMicrovolts()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  const uint32_t adcMax = rig.ecg.ecgAdcMax(1);
+  static int32_t in[4096], out[4096];
+  static float volts[4096];
+  for (uint16_t k = 0; k < 4096; ++k)
+    in[k] = static_cast<int32_t>((k * 2654435761u) % adcMax);
+
+  const uint32_t rounds = 500;
+  HostTimer fixedTimer;
+  for (uint32_t r = 0; r < rounds; ++r)
+    rig.ecg.toMicrovolts(1, in, out, 4096);
+  const double fixedNs = fixedTimer.elapsedNs();
+  HostTimer floatTimer;
+  for (uint32_t r = 0; r < rounds; ++r)
+    for (uint16_t k = 0; k < 4096; ++k)
+      volts[k] = ADS1293::rawToVoltage(in[k] - static_cast<int32_t>(adcMax / 2), 2.4f, static_cast<int32_t>(adcMax), 2.0f / 3.5f);
+  const double floatNs = floatTimer.elapsedNs();
+  CHECK(out[1] != 0 || volts[1] != 0.0f);
+  benchResult("microvolts", "fixed_ns_per_sample", fixedNs / (rounds * 4096.0), "ns");
+  benchResult("microvolts", "float_ns_per_sample", floatNs / (rounds * 4096.0), "ns");
+}
+
+int main()
+{
+  testExhaustive();
+  testSamplesAndLimits();
+  benchMicrovolts();
+  return testResult("test_microvolts");
+}
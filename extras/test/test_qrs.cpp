@@ -0,0 +1,183 @@
+// QRS detector accuracy and cost: beats found in synthetic ECG across heart
+// rates, noise, mains interference and baseline wander are scored against
+// the true R peaks (sensitivity and positive predictivity within 75 ms), and
+// the per-sample cost at 1600 SPS is reported.
+//
+// A recorded waveform can be scored too:
+//
+//   test_qrs <recording.csv> [sample rate, default 360]
+//
+// (see ecg_waveform.h for the format). Without annotations only the beat
+// count and heart rate are reported.
+
+#include "test_common.h"
+#include "ecg_waveform.h"
+#include "protocentral_ads1293_qrs.h"
+
+struct Score {
+  uint32_t truth = 0;
+  uint32_t detected = 0;
+  uint32_t matched = 0;
+  double sensitivity() const { return truth ? 100.0 * matched / truth : 0.0; }
+  double predictivity() const { return detected ? 100.0 * matched / detected : 0.0; }
+};
+
+// Match detections to annotations within `tolerance` samples, ignoring
+// beats before `from` (the learning period).
+static Score score(const std::vector<uint32_t> &truth, const std::vector<uint32_t> &found, uint32_t tolerance,
+                   uint32_t from)
+{
+  Score s;
+  size_t j = 0;
+  for (size_t i = 0; i < truth.size(); ++i)
+  {
+    if (truth[i] < from)
+      continue;
+    ++s.truth;
+    while (j < found.size() && found[j] + tolerance < truth[i])
+      ++j;
+    if (j < found.size() && found[j] <= truth[i] + tolerance)
+    {
+      ++s.matched;
+      ++j;
+    }
+  }
+  for (size_t i = 0; i < found.size(); ++i)
+    if (found[i] + tolerance >= from)
+      ++s.detected;
+  return s;
+}
+
+static void runSynthetic(const char *name, double fs, const EcgSignal &signal, double seconds, double minScore)
+{
+  SyntheticEcg ecg(fs, signal);
+  ADS1293QrsDetector qrs;
+  CHECK(qrs.configure(static_cast<float>(fs)));
+
+  std::vector<uint32_t> truth, found;
+  const uint32_t n = static_cast<uint32_t>(seconds * fs);
+  ADS1293QrsDetector::Beat beat;
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    bool r = false;
+    const int32_t x = ecg.next(&r);
+    if (r)
+      truth.push_back(i);
+    if (qrs.process(x, &beat))
+      found.push_back(beat.sample);
+  }
+  // the last beats may still be in the detector's pipeline
+  while (!truth.empty() && truth.back() + 0.5 * fs > n)
+    truth.pop_back();
+  while (!found.empty() && found.back() > (truth.empty() ? 0 : truth.back() + 0.1 * fs))
+    found.pop_back();
+
+  const Score s = score(truth, found, static_cast<uint32_t>(0.075 * fs), static_cast<uint32_t>(2.5 * fs));
+  printf("%-16s %5.0f SPS %3.0f bpm: %u beats, Se %.1f%%, +P %.1f%%, HR %u\n", name, fs, signal.heartRate,
+         s.truth, s.sensitivity(), s.predictivity(), qrs.heartRate());
+  CHECK(s.truth > 10);
+  CHECK(s.sensitivity() >= minScore);
+  CHECK(s.predictivity() >= minScore);
+  CHECK_NEAR(qrs.heartRate(), signal.heartRate, signal.heartRate * (signal.rrJitter + 0.04));
+}
+
+static void testSynthetic()
+{
+  EcgSignal clean;
+  runSynthetic("clean", 1600.0, clean, 60.0, 100.0);
+  runSynthetic("clean", 400.0, clean, 60.0, 100.0);
+  runSynthetic("clean", 200.0, clean, 60.0, 100.0);
+
+  EcgSignal slow;
+  slow.heartRate = 45.0;
+  runSynthetic("bradycardia", 1600.0, slow, 90.0, 100.0);
+
+  EcgSignal fast;
+  fast.heartRate = 160.0;
+  runSynthetic("tachycardia", 1600.0, fast, 60.0, 99.0);
+
+  EcgSignal noisy;
+  noisy.noiseMv = 0.05;
+  noisy.seed = 7;
+  runSynthetic("noise", 1600.0, noisy, 60.0, 99.0);
+
+  EcgSignal mains;
+  mains.mainsMv = 0.3;
+  mains.mainsHz = 60.0;
+  runSynthetic("mains", 853.333, mains, 60.0, 99.0);
+
+  EcgSignal wander;
+  wander.wanderMv = 1.0;
+  runSynthetic("wander", 1600.0, wander, 60.0, 99.0);
+
+  EcgSignal all;
+  all.heartRate = 95.0;
+  all.rrJitter = 0.1;
+  all.noiseMv = 0.04;
+  all.mainsMv = 0.2;
+  all.wanderMv = 0.5;
+  all.seed = 3;
+  runSynthetic("combined", 1600.0, all, 120.0, 98.0);
+}
+
+static void testRecording(const char *path, double fs)
+{
+  EcgRecording rec;
+  if (!loadRecording(path, rec))
+  {
+    fprintf(stderr, "cannot read recording %s\n", path);
+    CHECK(false);
+    return;
+  }
+  ADS1293QrsDetector qrs;
+  CHECK(qrs.configure(static_cast<float>(fs)));
+  std::vector<uint32_t> found;
+  ADS1293QrsDetector::Beat beat;
+  for (size_t i = 0; i < rec.samples.size(); ++i)
+    if (qrs.process(rec.samples[i], &beat))
+      found.push_back(beat.sample);
+
+  printf("recording %s: %zu samples, %zu beats, HR %u\n", path, rec.samples.size(), found.size(), qrs.heartRate());
+  if (rec.rPeaks.empty())
+    return;
+  const Score s = score(rec.rPeaks, found, static_cast<uint32_t>(0.075 * fs), static_cast<uint32_t>(2.5 * fs));
+  printf("recording: %u annotated beats, Se %.1f%%, +P %.1f%%\n", s.truth, s.sensitivity(), s.predictivity());
+  benchResult("qrs", "recording_sensitivity", s.sensitivity(), "%");
+  benchResult("qrs", "recording_predictivity", s.predictivity(), "%");
+  CHECK(s.sensitivity() >= 95.0);
+  CHECK(s.predictivity() >= 95.0);
+}
+
+static void benchQrs()
+{
+  const double fs = 1600.0;
+  EcgSignal signal;
+  signal.noiseMv = 0.02;
+  SyntheticEcg ecg(fs, signal);
+  static int32_t samples[16000];
+  for (uint32_t i = 0; i < 16000; ++i)
+    samples[i] = ecg.next();
+
+  ADS1293QrsDetector qrs;
+  CHECK(qrs.configure(ADS1293::SamplingRate::SPS_1600));
+  const uint32_t rounds = 50;
+  HostTimer timer;
+  for (uint32_t r = 0; r < rounds; ++r)
+    for (uint32_t i = 0; i < 16000; ++i)
+      qrs.process(samples[i]);
+  const double ns = timer.elapsedNs();
+  CHECK(qrs.beatCount() > 0);
+  benchResult("qrs", "ns_per_sample_1600sps", ns / (rounds * 16000.0), "ns");
+  benchResult("qrs", "detector_bytes", sizeof(ADS1293QrsDetector), "B");
+}
+
+int main(int argc, char **argv)
+{
+  testSynthetic();
+  if (argc > 1)
+    testRecording(argv[1], argc > 2 ? atof(argv[2]) : 360.0);
+  else
+    printf("recorded waveform: skipped (pass a CSV recording to score one)\n");
+  benchQrs();
+  return testResult("test_qrs");
+}
@@ -0,0 +1,70 @@
+// Output data rate and full-scale decoding (getOutputDataRate,
+// getPaceDataRate, ecgAdcMax, paceAdcMax) against the periods and codes
+// the simulated device produces for the same rate registers.
+
+#include "test_common.h"
+
+struct RateCase {
+  uint8_t afeRes; // FS_HIGH_CHn = bit 3 + n - 1
+  uint8_t r1;     // bit n - 1 set: R1 = 2
+  uint8_t r2;
+  uint8_t r3[3];
+};
+
+static const RateCase CASES[] = {
+    {0x00, 0x00, 0x01, {0x01, 0x02, 0x80}}, // 1600, 1066.7, 50 SPS
+    {0x08, 0x01, 0x02, {0x04, 0x08, 0x10}}, // R2 = 5, FS_HIGH + R1 = 2 on CH1
+    {0x30, 0x06, 0x04, {0x08, 0x02, 0x20}}, // R2 = 6, R3 = 12 and 6
+    {0x10, 0x00, 0x08, {0x40, 0x01, 0x04}}, // R2 = 8
+};
+
+static void testCase(TestRig &rig, const RateCase &c)
+{
+  ADS1293 &ecg = rig.ecg;
+  CHECK(ecg.applyGlobalConfig(GlobalConfig::Standby));
+  const uint8_t flex[] = {0x11, 0x19, 0x2E};
+  CHECK(ecg.writeRegisters(Register::FLEX_CH1_CN, flex, sizeof(flex)));
+  const uint8_t clock[] = {0x04, c.afeRes, 0x00}; // OSC_CN, AFE_RES, AFE_SHDN_CN
+  CHECK(ecg.writeRegisters(Register::OSC_CN, clock, sizeof(clock)));
+  const uint8_t rates[] = {c.r2, c.r3[0], c.r3[1], c.r3[2], c.r1};
+  CHECK(ecg.writeRegisters(Register::R2_RATE, rates, sizeof(rates)));
+  CHECK(ecg.applyGlobalConfig(GlobalConfig::Start));
+  CHECK(rig.sim.converting());
+
+  for (uint8_t ch = 1; ch <= 3; ++ch)
+  {
+    const double ecgHz = 1.0e9 / rig.sim.ecgPeriodNs(ch);
+    const double paceHz = 1.0e9 / rig.sim.pacePeriodNs(ch);
+    CHECK_NEAR(ecg.getOutputDataRate(ch), ecgHz, ecgHz * 1e-6);
+    CHECK_NEAR(ecg.getPaceDataRate(ch), paceHz, paceHz * 1e-6);
+    CHECK_EQ(ecg.ecgAdcMax(ch), rig.sim.adcMax(ch));
+  }
+  CHECK_EQ(ecg.paceAdcMax(), rig.sim.paceAdcMax());
+}
+
+// The decoded rate is the rate DRDY actually runs at.
+static void testEdgeRate()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.configureDRDYSource(DRDYSource::Ch1Ecg));
+  testCase(rig, CASES[0]);
+  shim::advanceUs(1000000);
+  // less the five periods of the initial DRDY mask
+  CHECK_NEAR(rig.sim.drdyEdges(), rig.ecg.getOutputDataRate(1) - 5, 1);
+}
+
+int main()
+{
+  {
+    TestRig rig;
+    shim::advanceUs(20000); // crystal start-up
+    for (size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); ++i)
+      testCase(rig, CASES[i]);
+    CHECK_EQ(rig.sim.lockedWrites(), 0);
+    CHECK_EQ(rig.ecg.getOutputDataRate(0), 0);
+    CHECK_EQ(rig.ecg.getOutputDataRate(4), 0);
+  }
+  testEdgeRate();
+  return testResult("test_rates");
+}
@@ -0,0 +1,105 @@
+// Per-channel output data rates: setChannelSamplingRate() never retimes
+// another enabled channel, and while channels run at different rates each
+// frame reads DATA_STATUS and then only the channels it flags, so a slower
+// channel costs bus bytes only when it has new data and otherwise holds its
+// last sample.
+
+#include "test_common.h"
+
+// ECG codes (channel << 20) | index, so every sample names its update.
+class IndexSim : public ADS1293Sim {
+public:
+  using ADS1293Sim::ADS1293Sim;
+  uint32_t ecgCode(uint8_t channel, uint32_t index, double t) override
+  {
+    (void)t;
+    return (static_cast<uint32_t>(channel) << 20) | index;
+  }
+};
+
+struct IndexRig {
+  TestRig::ShimReset shimReset;
+  ADS1293SimBus bus;
+  IndexSim sim;
+  ADS1293 ecg;
+
+  IndexRig() : sim(bus, TestRig::CS_PIN, TestRig::DRDY_PIN), ecg(TestRig::DRDY_PIN, TestRig::CS_PIN, &bus, 8000000)
+  {
+    ecg.begin();
+    shim::advanceUs(20000);
+  }
+};
+
+static void testKeepsOtherChannels()
+{
+  IndexRig rig;
+  CHECK(rig.ecg.begin3LeadECG());
+
+  // R2 = 5 cannot give 1600 SPS, and R2 = 4 would move channel 2 off
+  // 853 SPS: nothing is written
+  CHECK(!rig.ecg.setChannelSamplingRate(1, ADS1293::SamplingRate::SPS_1600));
+  CHECK_NEAR(rig.sim.ecgPeriodNs(1), 1.0e9 / 853.333, 1.0);
+  CHECK_NEAR(rig.sim.ecgPeriodNs(2), 1.0e9 / 853.333, 1.0);
+  CHECK_EQ(rig.sim.reg(0x21), 0x02);
+  CHECK(rig.sim.converting());
+  CHECK(rig.ecg.verify());
+
+  CHECK(!rig.ecg.setChannelSamplingRate(0, ADS1293::SamplingRate::SPS_400));
+  CHECK(!rig.ecg.setChannelSamplingRate(4, ADS1293::SamplingRate::SPS_400));
+}
+
+static void testScheduledFrames()
+{
+  IndexRig rig;
+  CHECK(rig.ecg.begin3LeadECG());
+  CHECK(rig.ecg.setSamplingRate(ADS1293::SamplingRate::SPS_1600));
+  CHECK(rig.ecg.setChannelSamplingRate(2, ADS1293::SamplingRate::SPS_400));
+  CHECK(rig.sim.converting());
+  CHECK_NEAR(rig.sim.ecgPeriodNs(1), 625000.0, 1.0);
+  CHECK_NEAR(rig.sim.ecgPeriodNs(2), 2500000.0, 1.0);
+  CHECK_NEAR(rig.ecg.getOutputDataRate(2), 400.0, 0.01);
+  CHECK(rig.ecg.verify());
+  shim::advanceUs(10000); // past the initial DRDY mask
+
+  ADS1293::Samples out[1];
+  uint32_t frames = 0, updates2 = 0, stale = 0, flagged = 0;
+  int32_t last2 = 0;
+  rig.bus.resetCounters();
+  const uint64_t end = shim::nowNs() + 100000000ull;
+  while (shim::nowNs() < end)
+  {
+    shim::advanceUs(50);
+    if (!rig.ecg.readFrames(out, 1))
+      continue;
+    ++frames;
+    if (out[0].ch2 != last2)
+    {
+      ++updates2;
+      if (!(out[0].status & 0x40))
+        ++stale;
+    }
+    else if (out[0].status & 0x40)
+    {
+      ++flagged;
+    }
+    if (out[0].ch2 >> 20 != 2 || out[0].ch3 != 0)
+      ++stale;
+    last2 = out[0].ch2;
+  }
+  CHECK_NEAR(frames, 160, 2);
+  CHECK_NEAR(updates2, 40, 1);
+  CHECK_EQ(stale, 0);
+  CHECK_EQ(flagged, 0);
+  // per frame: DATA_STATUS (command + 1), then channel 1 (command + 3), and
+  // channel 2 in the same burst only on its updates
+  CHECK_EQ(rig.bus.transactions(), 2 * frames);
+  CHECK_EQ(rig.bus.bytes(), frames * (2 + 4) + updates2 * 3);
+  benchResult("schedule", "bytes_per_frame", static_cast<double>(rig.bus.bytes()) / frames, "B");
+}
+
+int main()
+{
+  testKeepsOtherChannels();
+  testScheduledFrames();
+  return testResult("test_schedule");
+}
@@ -0,0 +1,266 @@
+// Checks the simulated device against the datasheet behaviour the other
+// tests rely on, over raw SPI and without the driver.
+
+#include "test_common.h"
+
+static const uint8_t CS = 10;
+static const uint8_t DRDY = 2;
+static const uint8_t ALARM = 3;
+
+static void writeRegs(ADS1293SimBus &bus, uint8_t addr, const uint8_t *values, uint8_t len)
+{
+  bus.beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
+  digitalWrite(CS, LOW);
+  bus.transfer(static_cast<uint8_t>(addr & 0x7F));
+  for (uint8_t i = 0; i < len; ++i)
+    bus.transfer(values[i]);
+  digitalWrite(CS, HIGH);
+  bus.endTransaction();
+}
+
+static void writeReg(ADS1293SimBus &bus, uint8_t addr, uint8_t value)
+{
+  writeRegs(bus, addr, &value, 1);
+}
+
+static void readRegs(ADS1293SimBus &bus, uint8_t addr, uint8_t *values, uint8_t len)
+{
+  bus.beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
+  digitalWrite(CS, LOW);
+  bus.transfer(static_cast<uint8_t>(addr | 0x80));
+  for (uint8_t i = 0; i < len; ++i)
+    values[i] = bus.transfer(0x00);
+  digitalWrite(CS, HIGH);
+  bus.endTransaction();
+}
+
+static uint8_t readReg(ADS1293SimBus &bus, uint8_t addr)
+{
+  uint8_t v = 0;
+  readRegs(bus, addr, &v, 1);
+  return v;
+}
+
+// 3-lead routing at 1600 SPS (R1 = 4, R2 = 4, R3 = 4), DRDY from CH1 ECG.
+static void configure1600(ADS1293SimBus &bus, bool initialMask)
+{
+  const uint8_t flex[] = {0x11, 0x19};
+  writeRegs(bus, 0x01, flex, sizeof(flex));
+  writeReg(bus, 0x12, 0x04); // STRTCLK
+  writeReg(bus, 0x14, 0x24); // CH3 off
+  const uint8_t rates[] = {0x01, 0x01, 0x01, 0x01, 0x00};
+  writeRegs(bus, 0x21, rates, sizeof(rates));
+  writeReg(bus, 0x27, 0x08);
+  writeReg(bus, 0x29, initialMask ? 0x00 : 0x02);
+  writeReg(bus, 0x2F, 0x30);
+}
+
+static volatile uint32_t edges = 0;
+static volatile uint32_t firstEdgeUs = 0;
+static void onEdge()
+{
+  if (edges++ == 0)
+    firstEdgeUs = static_cast<uint32_t>(shim::nowNs() / 1000u);
+}
+
+static void testRegisters()
+{
+  shim::reset();
+  ADS1293SimBus bus;
+  ADS1293Sim sim(bus, CS, DRDY, ALARM);
+
+  CHECK_EQ(readReg(bus, 0x40), ADS1293Sim::REVISION);
+  CHECK_EQ(readReg(bus, 0x00), 0x02);
+  CHECK_EQ(readReg(bus, 0x21), 0x08);
+  CHECK_EQ(readReg(bus, 0x2E), 0x33);
+
+  // auto-increment in both directions
+  const uint8_t in[] = {0x11, 0x19, 0x2E};
+  writeRegs(bus, 0x01, in, sizeof(in));
+  uint8_t out[3];
+  readRegs(bus, 0x01, out, sizeof(out));
+  CHECK(memcmp(in, out, sizeof(in)) == 0);
+
+  // read-only registers ignore writes
+  writeReg(bus, 0x19, 0xFF);
+  writeReg(bus, 0x40, 0x55);
+  CHECK_EQ(readReg(bus, 0x19), 0x00);
+  CHECK_EQ(readReg(bus, 0x40), ADS1293Sim::REVISION);
+
+  // START_CON locks the clock and rate registers, not the rest
+  shim::advanceUs(20000); // crystal start-up
+  configure1600(bus, true);
+  writeReg(bus, 0x00, 0x01);
+  CHECK(sim.converting());
+  writeReg(bus, 0x21, 0x08);
+  writeReg(bus, 0x13, 0x08);
+  writeReg(bus, 0x0A, 0x07);
+  CHECK_EQ(readReg(bus, 0x21), 0x01);
+  CHECK_EQ(readReg(bus, 0x13), 0x00);
+  CHECK_EQ(readReg(bus, 0x0A), 0x07);
+  CHECK_EQ(sim.lockedWrites(), 2);
+  CHECK_EQ(sim.clockStartViolations(), 0);
+  writeReg(bus, 0x00, 0x00);
+  writeReg(bus, 0x21, 0x08);
+  CHECK_EQ(readReg(bus, 0x21), 0x08);
+}
+
+static void testTiming()
+{
+  shim::reset();
+  ADS1293SimBus bus;
+  ADS1293Sim sim(bus, CS, DRDY, ALARM);
+  shim::advanceUs(20000);
+  configure1600(bus, false);
+  attachInterrupt(digitalPinToInterrupt(DRDY), onEdge, FALLING);
+
+  // 102.4 kHz / (4 * 4 * 4) = 1600 SPS: first DRDY one period after START
+  edges = 0;
+  const uint32_t startUs = static_cast<uint32_t>(shim::nowNs() / 1000u);
+  writeReg(bus, 0x00, 0x01);
+  CHECK_NEAR(sim.ecgPeriodNs(1), 625000.0, 1.0);
+  CHECK_NEAR(sim.pacePeriodNs(1), 156250.0, 1.0);
+  shim::advanceUs(100000);
+  CHECK_NEAR(edges, 160, 1);
+  CHECK_NEAR(firstEdgeUs - startUs, 625, 2);
+  CHECK_EQ(sim.ecgPeriodNs(3), 0.0); // shut down
+
+  // the initial mask holds DRDY off for six periods
+  writeReg(bus, 0x00, 0x00);
+  writeReg(bus, 0x29, 0x00);
+  edges = 0;
+  const uint32_t maskedStartUs = static_cast<uint32_t>(shim::nowNs() / 1000u);
+  writeReg(bus, 0x00, 0x01);
+  shim::advanceUs(10000);
+  CHECK_NEAR(firstEdgeUs - maskedStartUs, 6 * 625, 2);
+
+  // FS_HIGH_CH1 doubles the modulator clock; R1_RATE bit selects R1 = 2
+  writeReg(bus, 0x00, 0x00);
+  writeReg(bus, 0x13, 0x08);
+  writeReg(bus, 0x25, 0x01);
+  writeReg(bus, 0x00, 0x01);
+  CHECK_NEAR(sim.ecgPeriodNs(1), 156250.0, 1.0);
+  CHECK_NEAR(sim.ecgPeriodNs(2), 625000.0, 1.0);
+
+  // clock error scales every period
+  writeReg(bus, 0x00, 0x00);
+  sim.setClockPpm(100.0);
+  writeReg(bus, 0x00, 0x01);
+  CHECK_NEAR(sim.ecgPeriodNs(2), 625000.0 / 1.0001, 1.0);
+  detachInterrupt(digitalPinToInterrupt(DRDY));
+}
+
+static void testData()
+{
+  shim::reset();
+  ADS1293SimBus bus;
+  ADS1293Sim sim(bus, CS, DRDY, ALARM);
+  shim::advanceUs(20000);
+  configure1600(bus, false);
+  writeReg(bus, 0x00, 0x01);
+
+  // status, pace and ECG in one auto-incrementing burst; the read
+  // releases DRDY and clears the new-data flags of what was read
+  shim::advanceUs(700);
+  CHECK(sim.drdyLow());
+  CHECK_EQ(digitalRead(DRDY), LOW);
+  uint8_t block[16];
+  readRegs(bus, 0x30, block, sizeof(block));
+  CHECK_EQ(block[0] & 0x60, 0x60);
+  CHECK(!sim.drdyLow());
+  CHECK_EQ(readReg(bus, 0x30) & 0x60, 0x00);
+
+  // the synthetic ECG sits on ADC_MAX / 2 and peaks at each beat
+  const uint32_t max = sim.adcMax(1);
+  CHECK_EQ(max, 0x800000);
+  const double codesPerUv = 3.5 * max / (2.0 * 2.4e6);
+  CHECK_NEAR(sim.ecgCode(1, 0, 1.0), max / 2, 1);
+  const double peak = sim.ecgUv(1, sim.beatTimeS(1));
+  CHECK_NEAR(peak, 1000.0, 20.0);
+  CHECK_NEAR(sim.ecgUv(2, sim.beatTimeS(1)), 1.4 * peak, 0.01);
+  CHECK_NEAR(sim.ecgCode(1, 0, sim.beatTimeS(1)) - static_cast<double>(max / 2), peak * codesPerUv, 1);
+
+  // DATA_LOOP cycles through the CH_CNFG sources, a frame at a time
+  writeReg(bus, 0x2F, 0x31);
+  bus.beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
+  digitalWrite(CS, LOW);
+  bus.transfer(0x50 | 0x80);
+  uint32_t frames = 0;
+  for (uint8_t f = 0; f < 4; ++f)
+  {
+    while (digitalRead(DRDY) != LOW)
+      ;
+    const uint8_t status = bus.transfer(0x00);
+    for (uint8_t i = 0; i < 6; ++i)
+      bus.transfer(0x00);
+    if (status & 0x20)
+      ++frames;
+  }
+  digitalWrite(CS, HIGH);
+  bus.endTransaction();
+  CHECK_EQ(frames, 4);
+  CHECK_EQ(sim.framesOverwritten(), 0);
+}
+
+static void testFaults()
+{
+  shim::reset();
+  ADS1293SimBus bus;
+  ADS1293Sim sim(bus, CS, DRDY, ALARM);
+
+  CHECK_EQ(digitalRead(ALARM), HIGH);
+  sim.setLeadOff(0x01);
+  CHECK_EQ(readReg(bus, 0x18), 0x01);
+  CHECK_EQ(readReg(bus, 0x19), 0x08);
+  CHECK_EQ(readReg(bus, 0x30) & 0x02, 0x02);
+  CHECK_EQ(digitalRead(ALARM), LOW);
+
+  writeReg(bus, 0x2A, 0x08); // mask LEADOFF
+  CHECK_EQ(digitalRead(ALARM), HIGH);
+  sim.setErrorStatus(0x01); // common-mode out of range
+  CHECK_EQ(digitalRead(ALARM), LOW);
+  sim.setErrorStatus(0);
+  sim.setLeadOff(0);
+  CHECK_EQ(readReg(bus, 0x19), 0x00);
+  CHECK_EQ(digitalRead(ALARM), HIGH);
+}
+
+static void testInterruptsInTransaction()
+{
+  shim::reset();
+  ADS1293SimBus bus;
+  ADS1293Sim sim(bus, CS, DRDY, ALARM);
+  shim::advanceUs(20000);
+  configure1600(bus, false);
+  attachInterrupt(digitalPinToInterrupt(DRDY), onEdge, FALLING);
+  writeReg(bus, 0x00, 0x01);
+
+  // an edge while another transaction holds the bus waits for its end
+  edges = 0;
+  bus.beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
+  shim::advanceUs(700);
+  CHECK_EQ(edges, 0);
+  bus.endTransaction();
+  CHECK_EQ(edges, 1);
+  CHECK_EQ(shim::interruptsInTransaction(), 1);
+
+  // unless the interrupt was registered with usingInterrupt()
+  bus.usingInterrupt(digitalPinToInterrupt(DRDY));
+  bus.beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
+  shim::advanceUs(700);
+  bus.endTransaction();
+  CHECK_EQ(edges, 2);
+  CHECK_EQ(shim::interruptsInTransaction(), 1);
+  detachInterrupt(digitalPinToInterrupt(DRDY));
+  (void)sim;
+}
+
+int main()
+{
+  testRegisters();
+  testTiming();
+  testData();
+  testFaults();
+  testInterruptsInTransaction();
+  return testResult("test_simulator");
+}
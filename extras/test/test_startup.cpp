@@ -0,0 +1,168 @@
+// startup() per profile on the simulated device: the crystal start-up time
+// is respected from power-up and skipped on a running clock, the first
+// settled frame arrives SETTLE_FRAMES output periods after START_CON (or
+// DRDY_MASK_FRAMES with the device's DRDY mask) and is the frame returned,
+// and the time to each step is reported per profile, cold and warm.
+
+#include "test_common.h"
+#include "protocentral_ads1293_profile.h"
+
+typedef ADS1293Profile<
+    ADS1293FlexChannel<1, 2, 1>,
+    ADS1293FlexChannel<2, 3, 1>,
+    ADS1293CommonModeDetect<0x07>,
+    ADS1293RightLegDrive<4>,
+    ADS1293Oscillator<>,
+    ADS1293AfeChannels<0x03>,
+    ADS1293DecimationR2<5>,
+    ADS1293DecimationR3<1, 6>,
+    ADS1293DecimationR3<2, 6>,
+    ADS1293DataReadySource<DRDYSource::Ch1Ecg>,
+    ADS1293DataReadyMasking<false>,
+    ADS1293LoopReadback<0x03>,
+    ADS1293Start<>>
+    ThreeLeadUnmasked;
+
+struct ProfileCase {
+  const char *name;
+  const uint8_t *image;
+  bool masked;
+};
+
+static void report(const char *name, const char *run, const ADS1293::StartupTiming &t, uint32_t transactions)
+{
+  char bench[48];
+  snprintf(bench, sizeof(bench), "startup_%s_%s", name, run);
+  benchResult(bench, "ready", t.readyUs, "us");
+  benchResult(bench, "configured", t.configuredUs, "us");
+  benchResult(bench, "first_sample", t.firstSampleUs, "us");
+  benchResult(bench, "settled_sample", t.settledSampleUs, "us");
+  benchResult(bench, "transactions", transactions, "count");
+}
+
+static void testProfile(const ProfileCase &p)
+{
+  TestRig rig; // MCU boot and device power-up at time zero
+  ADS1293::StartupTiming cold;
+  ADS1293::Samples settled;
+  rig.bus.resetCounters();
+  CHECK(rig.ecg.startup(p.image, &settled, &cold));
+  const uint32_t coldTransactions = rig.bus.transactions();
+  CHECK(settled.ok);
+  CHECK_EQ(rig.sim.clockStartViolations(), 0);
+  CHECK(cold.configuredUs >= ADS1293::CLOCK_START_MS * 1000u);
+  CHECK(cold.configuredUs < ADS1293::CLOCK_START_MS * 1000u + 500u);
+
+  // first DRDY one period after START_CON (unmasked) or at the first
+  // settled frame; the settled frame SETTLE_FRAMES periods after START_CON
+  const double periodUs = rig.sim.ecgPeriodNs(1) / 1000.0;
+  const double started = cold.configuredUs;
+  const uint8_t settledFrame = p.masked ? ADS1293::DRDY_MASK_FRAMES : ADS1293::SETTLE_FRAMES;
+  CHECK_NEAR(cold.settledSampleUs - started, settledFrame * periodUs, periodUs * 0.5);
+  CHECK_NEAR(cold.firstSampleUs - started, (p.masked ? settledFrame : 1) * periodUs, periodUs * 0.5);
+  report(p.name, "cold", cold, coldTransactions);
+
+  // reconfiguration with the clock running: no crystal wait
+  CHECK(rig.ecg.applyGlobalConfig(GlobalConfig::Standby));
+  ADS1293::StartupTiming warm;
+  rig.bus.resetCounters();
+  CHECK(rig.ecg.startup(p.image, nullptr, &warm));
+  CHECK(warm.configuredUs < 500u);
+  CHECK_NEAR(warm.settledSampleUs - warm.configuredUs, settledFrame * periodUs, periodUs * 0.5);
+  CHECK_EQ(rig.sim.clockStartViolations(), 0);
+  report(p.name, "warm", warm, rig.bus.transactions());
+}
+
+// ECG codes carry the conversion number, so the frame startup() returns
+// names itself.
+class ConversionSim : public ADS1293Sim {
+public:
+  using ADS1293Sim::ADS1293Sim;
+  uint32_t ecgCode(uint8_t channel, uint32_t index, double t) override
+  {
+    (void)t;
+    return (static_cast<uint32_t>(channel) << 16) | index;
+  }
+};
+
+static void testSettledConversion(const uint8_t *image, uint8_t conversion)
+{
+  shim::reset();
+  ADS1293SimBus bus;
+  ConversionSim sim(bus, TestRig::CS_PIN, TestRig::DRDY_PIN);
+  ADS1293 ecg(TestRig::DRDY_PIN, TestRig::CS_PIN, &bus, 8000000);
+  ecg.begin();
+  ADS1293::Samples settled;
+  CHECK(ecg.startup(image, &settled));
+  CHECK(settled.ok);
+  CHECK_EQ(settled.ch1, (1 << 16) | conversion);
+  CHECK_EQ(settled.ch2, (2 << 16) | conversion);
+  CHECK_EQ(sim.framesOverwritten(), 0); // every unsettled frame was read
+
+  // and again from a running clock
+  CHECK(ecg.applyGlobalConfig(GlobalConfig::Standby));
+  CHECK(ecg.startup(image, &settled));
+  CHECK_EQ(settled.ch1, (1 << 16) | conversion);
+}
+
+static void testPowerDownAndTimeout()
+{
+  TestRig rig;
+  rig.sim.setInterfaceDelayUs(3000);
+  rig.sim.powerOn();
+  ADS1293::StartupTiming t;
+  CHECK(rig.ecg.startup(ADS1293Profiles::ThreeLead::image(), nullptr, &t));
+  CHECK(t.readyUs >= 3000u);
+  CHECK_EQ(rig.sim.clockStartViolations(), 0);
+
+  // leaving power-down restarts the crystal
+  CHECK(rig.ecg.applyGlobalConfig(GlobalConfig::PowerDown));
+  shim::advanceUs(1000);
+  CHECK(rig.ecg.startup(ADS1293Profiles::ThreeLead::image(), nullptr, &t));
+  CHECK(t.configuredUs >= ADS1293::CLOCK_START_MS * 1000u);
+  CHECK_EQ(rig.sim.clockStartViolations(), 0);
+
+  // a device that does not answer times out
+  TestRig silent;
+  silent.sim.setInterfaceDelayUs(1000000);
+  silent.sim.powerOn();
+  const uint64_t start = shim::nowNs();
+  CHECK(!silent.ecg.startup(ADS1293Profiles::ThreeLead::image(), nullptr, nullptr, 20));
+  CHECK_NEAR((shim::nowNs() - start) / 1000000.0, 20.0, 1.0);
+}
+
+// The register-call path for comparison: begin3LeadECG(), then DRDY.
+static void benchLegacy()
+{
+  TestRig rig;
+  shim::advanceUs(ADS1293::CLOCK_START_MS * 1000u);
+  const uint64_t start = shim::nowNs();
+  rig.bus.resetCounters();
+  CHECK(rig.ecg.begin3LeadECG());
+  const uint32_t transactions = rig.bus.transactions();
+  const uint64_t configured = shim::nowNs();
+  while (digitalRead(TestRig::DRDY_PIN) && shim::nowNs() - start < 100000000ull)
+    shim::advanceUs(1);
+  CHECK(!digitalRead(TestRig::DRDY_PIN));
+  benchResult("startup_3-lead_calls", "configured", (configured - start) / 1000.0, "us");
+  benchResult("startup_3-lead_calls", "settled_sample", (shim::nowNs() - start) / 1000.0, "us");
+  benchResult("startup_3-lead_calls", "transactions", transactions, "count");
+}
+
+int main()
+{
+  const ProfileCase profiles[] = {
+      {"3-lead", ADS1293Profiles::ThreeLead::image(), true},
+      {"3-lead-unmasked", ThreeLeadUnmasked::image(), false},
+      {"5-lead", ADS1293Profiles::FiveLead::image(), true},
+      {"self-test", ADS1293Profiles::SelfTest::image(), true},
+      {"high-rate", ADS1293Profiles::HighRate::image(), true},
+  };
+  for (size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); ++i)
+    testProfile(profiles[i]);
+  testSettledConversion(ADS1293Profiles::ThreeLead::image(), ADS1293::DRDY_MASK_FRAMES);
+  testSettledConversion(ThreeLeadUnmasked::image(), ADS1293::SETTLE_FRAMES);
+  testPowerDownAndTimeout();
+  benchLegacy();
+  return testResult("test_startup");
+}
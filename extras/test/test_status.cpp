@@ -0,0 +1,147 @@
+// Lead-off detection and status readout: configureLeadOff() programs the
+// detector so that only enabled inputs are flagged, and in both status
+// modes an electrode coming off (and back on) shows in the decoded frames'
+// status, leadOff and errors fields and fires the status callback once per
+// change.
+
+#include "test_common.h"
+
+static const uint8_t LOD_CN = 0x06, LOD_EN = 0x07, LOD_CURRENT = 0x08;
+static const uint8_t ERR_LEADOFF = 0x08; // ERR_STATUS
+static const uint8_t STATUS_ALARM = 0x02; // DATA_STATUS ALARMB
+
+struct StatusLog {
+  uint32_t calls = 0;
+  uint8_t leadOff = 0;
+  uint8_t errors = 0;
+};
+
+static void onStatus(uint8_t leadOff, uint8_t errors, void *context)
+{
+  StatusLog &log = *static_cast<StatusLog *>(context);
+  ++log.calls;
+  log.leadOff = leadOff;
+  log.errors = errors;
+}
+
+// Frames over `ms`, drained every 5 ms; true if all of them carry the
+// given flags.
+static bool framesShow(TestRig &rig, uint16_t ms, uint8_t leadOff, uint8_t errors, bool alarm)
+{
+  ADS1293::Samples out[16];
+  uint32_t frames = 0;
+  bool all = true;
+  for (uint16_t t = 0; t < ms; t += 5)
+  {
+    shim::advanceUs(5000);
+    const size_t n = rig.ecg.readFrames(out, 16);
+    for (size_t i = 0; i < n; ++i, ++frames)
+      all &= out[i].ok && out[i].leadOff == leadOff && out[i].errors == errors &&
+             ((out[i].status & STATUS_ALARM) != 0) == alarm;
+  }
+  return frames > 0 && all;
+}
+
+static void testConfigure()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  CHECK_EQ(rig.sim.reg(LOD_CN) & 0x08, 0x08); // shut down after reset
+
+  CHECK(!rig.ecg.configureLeadOff(ADS1293::LeadOffMode::DC, 0x07, 100, 4));
+  CHECK(rig.ecg.configureLeadOff(ADS1293::LeadOffMode::DC, 0x07, 100));
+  CHECK_EQ(rig.sim.reg(LOD_CN), 0x00);
+  CHECK_EQ(rig.sim.reg(LOD_EN), 0x07);
+  CHECK_EQ(rig.sim.reg(LOD_CURRENT), 12); // 8 nA steps, rounded down
+  CHECK(rig.ecg.configureLeadOff(ADS1293::LeadOffMode::AnalogAC, 0xFF, 5000, 3));
+  CHECK_EQ(rig.sim.reg(LOD_CN), 0x17);
+  CHECK_EQ(rig.sim.reg(LOD_EN), 0x3F);
+  CHECK_EQ(rig.sim.reg(LOD_CURRENT), 0xFF);
+
+  // only detected while enabled and out of shutdown
+  rig.sim.disconnectInputs(0x10);
+  CHECK_EQ(rig.sim.reg(0x18), 0x10);
+  CHECK(rig.ecg.configureLeadOff(ADS1293::LeadOffMode::DC, 0x07, 100));
+  CHECK_EQ(rig.sim.reg(0x18), 0x00);
+  CHECK(rig.ecg.configureLeadOff(ADS1293::LeadOffMode::Off, 0x3F, 100));
+  rig.sim.disconnectInputs(0x01);
+  CHECK_EQ(rig.sim.reg(0x18), 0x00);
+  CHECK(!rig.sim.alarmAsserted());
+}
+
+static void testStatusMode(ADS1293::StatusMode mode)
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  CHECK(rig.ecg.configureLeadOff(ADS1293::LeadOffMode::DC, 0x07, 100));
+  if (mode == ADS1293::StatusMode::AlarmPin)
+  {
+    CHECK(!rig.ecg.setStatusMode(mode)); // needs the pin
+    CHECK(rig.ecg.setStatusMode(mode, TestRig::ALARM_PIN));
+  }
+  else
+  {
+    CHECK(rig.ecg.setStatusMode(mode));
+  }
+  StatusLog log;
+  rig.ecg.onStatusChange(onStatus, &log);
+  shim::advanceUs(10000); // past the initial DRDY mask
+  static ADS1293::Samples ring[16];
+  CHECK(rig.ecg.startAcquisition(ring, 16));
+
+  CHECK(framesShow(rig, 20, 0, 0, false));
+  CHECK_EQ(log.calls, 0);
+
+  // IN2 off: the alarm, the lead and LEADOFF on every frame, one callback
+  rig.sim.disconnectInputs(0x02);
+  shim::advanceUs(5000);
+  ADS1293::Samples out[16];
+  rig.ecg.readFrames(out, 16); // the frame read as the electrode came off
+  CHECK(framesShow(rig, 20, 0x02, ERR_LEADOFF, true));
+  CHECK_EQ(log.calls, 1);
+  CHECK_EQ(log.leadOff, 0x02);
+  CHECK_EQ(log.errors, ERR_LEADOFF);
+
+  // IN3 too
+  rig.sim.disconnectInputs(0x06);
+  shim::advanceUs(5000);
+  rig.ecg.readFrames(out, 16);
+  CHECK(framesShow(rig, 20, 0x06, ERR_LEADOFF, true));
+  CHECK_EQ(log.calls, 2);
+  CHECK_EQ(log.leadOff, 0x06);
+
+  // an input the detector does not watch changes nothing
+  rig.sim.disconnectInputs(0x26);
+  CHECK(framesShow(rig, 20, 0x06, ERR_LEADOFF, true));
+  CHECK_EQ(log.calls, 2);
+
+  // back on: cleared once
+  rig.sim.disconnectInputs(0);
+  shim::advanceUs(5000);
+  rig.ecg.readFrames(out, 16);
+  CHECK(framesShow(rig, 20, 0, 0, false));
+  CHECK_EQ(log.calls, 3);
+  CHECK_EQ(log.leadOff, 0);
+  CHECK_EQ(log.errors, 0);
+  rig.ecg.stopAcquisition();
+
+  // Off: the flags are no longer read
+  CHECK(rig.ecg.setStatusMode(ADS1293::StatusMode::Off));
+  rig.sim.disconnectInputs(0x01);
+  CHECK(rig.ecg.startAcquisition(ring, 16));
+  shim::advanceUs(5000);
+  rig.ecg.readFrames(out, 16);
+  CHECK(framesShow(rig, 20, 0, 0, false));
+  CHECK_EQ(log.calls, 3);
+  rig.ecg.stopAcquisition();
+}
+
+int main()
+{
+  testConfigure();
+  testStatusMode(ADS1293::StatusMode::InBurst);
+  testStatusMode(ADS1293::StatusMode::AlarmPin);
+  return testResult("test_status");
+}
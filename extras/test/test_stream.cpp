@@ -0,0 +1,206 @@
+// Packet decoders on a damaged link: for both the compact stream format and
+// the lossless codec, a corrupt byte costs only its own packet, a packet
+// cut short does not take the following one with it, sync bytes inside
+// noise or inside a rejected packet do not hide the next real packet, and
+// the result does not depend on how the bytes are chunked.
+
+#include <algorithm>
+
+#include "test_common.h"
+#include "protocentral_ads1293_codec.h"
+#include "protocentral_ads1293_stream.h"
+
+struct Decoded {
+  std::vector<ADS1293::Samples> frames;
+  std::vector<uint16_t> seqs;
+};
+
+static void onFrame(const ADS1293::Samples &s, uint16_t seq, void *context)
+{
+  Decoded &d = *static_cast<Decoded *>(context);
+  d.frames.push_back(s);
+  d.seqs.push_back(seq);
+}
+
+// Packets as separate byte strings, so a test can damage one of them.
+typedef std::vector<std::vector<uint8_t>> Packets;
+
+// Frames with values that contain the sync bytes now and then.
+static std::vector<ADS1293::Samples> frames(uint32_t count)
+{
+  std::vector<ADS1293::Samples> v(count);
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    v[i].ch1 = static_cast<int32_t>(i * 0x5AA5u) % 0x7FFFFF;
+    v[i].ch2 = -static_cast<int32_t>(i * 313u);
+    v[i].ch3 = (i % 7 == 0) ? 0x5AA5A5 : static_cast<int32_t>(i);
+  }
+  return v;
+}
+
+// Print target that keeps each write() as one packet.
+class PacketSink : public Print {
+public:
+  Packets packets;
+  size_t write(uint8_t b) override { return write(&b, 1); }
+  size_t write(const uint8_t *buffer, size_t size) override
+  {
+    packets.push_back(std::vector<uint8_t>(buffer, buffer + size));
+    return size;
+  }
+};
+
+static Packets streamPackets(const std::vector<ADS1293::Samples> &in)
+{
+  static uint8_t buffer[ADS1293StreamEncoder::packetSize(8, 3)];
+  PacketSink sink;
+  ADS1293StreamEncoder enc(sink, buffer, sizeof(buffer));
+  CHECK_EQ(enc.add(in.data(), in.size()), in.size());
+  CHECK(enc.flush());
+  return sink.packets;
+}
+
+static Packets codecPackets(const std::vector<ADS1293::Samples> &in)
+{
+  static uint8_t buffer[ADS1293CodecEncoder::packetSize(16, 3)];
+  PacketSink sink;
+  ADS1293CodecEncoder enc(sink, buffer, sizeof(buffer));
+  CHECK_EQ(enc.add(in.data(), in.size()), in.size());
+  CHECK(enc.flush());
+  return sink.packets;
+}
+
+struct Result {
+  Decoded out;
+  uint32_t crcErrors = 0;
+  uint32_t lost = 0;
+};
+
+// Feed `bytes` in chunks of 1..chunk bytes.
+template <typename Decoder>
+static Result decode(const std::vector<uint8_t> &bytes, size_t bufferSize, size_t chunk)
+{
+  Result r;
+  std::vector<uint8_t> rx(bufferSize);
+  Decoder dec(rx.data(), rx.size(), onFrame, &r.out);
+  uint32_t x = 77;
+  for (size_t i = 0; i < bytes.size();)
+  {
+    x = x * 1664525u + 1013904223u;
+    const size_t n = std::min(bytes.size() - i, 1 + (x >> 16) % chunk);
+    dec.feed(bytes.data() + i, n);
+    i += n;
+  }
+  r.crcErrors = dec.crcErrors();
+  r.lost = dec.framesLost();
+  CHECK_EQ(dec.framesDecoded(), r.out.frames.size());
+  return r;
+}
+
+static std::vector<uint8_t> join(const Packets &packets)
+{
+  std::vector<uint8_t> v;
+  for (size_t i = 0; i < packets.size(); ++i)
+    v.insert(v.end(), packets[i].begin(), packets[i].end());
+  return v;
+}
+
+// True if the decoded frames are exactly `in` minus the frames of the
+// packets in `dropped` (packet index, frames per packet).
+static bool matches(const Decoded &out, const std::vector<ADS1293::Samples> &in, uint8_t perPacket,
+                    const std::vector<size_t> &dropped)
+{
+  size_t k = 0;
+  for (size_t i = 0; i < in.size(); ++i)
+  {
+    bool gone = false;
+    for (size_t d = 0; d < dropped.size(); ++d)
+      gone |= i / perPacket == dropped[d];
+    if (gone)
+      continue;
+    if (k >= out.frames.size() || out.seqs[k] != static_cast<uint16_t>(i) || out.frames[k].ch1 != in[i].ch1 ||
+        out.frames[k].ch2 != in[i].ch2 || out.frames[k].ch3 != in[i].ch3)
+      return false;
+    ++k;
+  }
+  return k == out.frames.size();
+}
+
+template <typename Decoder>
+static void testDecoder(const char *name, const Packets &packets, const std::vector<ADS1293::Samples> &in,
+                        uint8_t perPacket, size_t bufferSize)
+{
+  printf("%s: %zu packets\n", name, packets.size());
+  CHECK(packets.size() >= 10);
+
+  // clean, in any chunking
+  const std::vector<uint8_t> clean = join(packets);
+  for (size_t chunk = 1; chunk <= 64; chunk *= 4)
+  {
+    const Result r = decode<Decoder>(clean, bufferSize, chunk);
+    CHECK(matches(r.out, in, perPacket, {}));
+    CHECK_EQ(r.crcErrors, 0);
+    CHECK_EQ(r.lost, 0);
+  }
+
+  // one flipped payload bit: that packet only
+  {
+    Packets p = packets;
+    p[3][p[3].size() / 2] ^= 0x10;
+    const Result r = decode<Decoder>(join(p), bufferSize, 16);
+    CHECK(matches(r.out, in, perPacket, {3}));
+    CHECK_EQ(r.crcErrors, 1);
+    CHECK_EQ(r.lost, perPacket);
+  }
+
+  // a packet cut short: its claimed length swallows the start of the next
+  // one, which must still decode once the CRC fails
+  {
+    Packets p = packets;
+    p[4].resize(p[4].size() - 5);
+    const Result r = decode<Decoder>(join(p), bufferSize, 16);
+    CHECK(matches(r.out, in, perPacket, {4}));
+    CHECK_EQ(r.crcErrors, 1);
+  }
+
+  // noise holding a plausible header right before a packet
+  {
+    Packets p = packets;
+    const std::vector<uint8_t> &real = packets[6];
+    std::vector<uint8_t> fake = {0x00, 0xA5, 0xA5, 0x5A};
+    fake.insert(fake.end(), real.begin() + 2, real.begin() + (real.size() > 8 ? 8 : real.size()));
+    fake.push_back(0xA5);
+    p[6].insert(p[6].begin(), fake.begin(), fake.end());
+    const Result r = decode<Decoder>(join(p), bufferSize, 16);
+    CHECK(matches(r.out, in, perPacket, {}));
+    CHECK(r.crcErrors >= 1);
+    CHECK_EQ(r.lost, 0);
+  }
+
+  // a lone sync pair with a header byte out of range
+  {
+    Packets p = packets;
+    p[7].insert(p[7].begin(), {0xA5, 0x5A, 0xF7, 0x00});
+    const Result r = decode<Decoder>(join(p), bufferSize, 16);
+    CHECK(matches(r.out, in, perPacket, {}));
+    CHECK_EQ(r.crcErrors, 0);
+  }
+
+  // a lost tail and a flipped bit in consecutive packets
+  {
+    Packets p = packets;
+    p[8].resize(p[8].size() / 2);
+    p[9][p[9].size() - 3] ^= 0x01;
+    const Result r = decode<Decoder>(join(p), bufferSize, 1);
+    CHECK(matches(r.out, in, perPacket, {8, 9}));
+    CHECK_EQ(r.lost, 2u * perPacket);
+  }
+}
+
+int main()
+{
+  const std::vector<ADS1293::Samples> in = frames(16 * 12);
+  testDecoder<ADS1293StreamDecoder>("stream", streamPackets(in), in, 8, ADS1293StreamEncoder::packetSize(8, 3));
+  testDecoder<ADS1293CodecDecoder>("codec", codecPackets(in), in, 16, ADS1293CodecEncoder::packetSize(16, 3));
+  return testResult("test_stream");
+}
@@ -0,0 +1,255 @@
+// Acquisition task on the pthread backend: the DRDY interrupt (raised on the
+// test's thread by the simulator) wakes the task thread, which reads each
+// frame at 1600 SPS into the ring, while a consumer thread drains it with
+// blocking read()s. No frame is lost or reordered across the threads, a
+// consumer stall shows up in queueHighWater(), and stop() hands the device
+// back in its previous read mode, also while consumers are blocked in or
+// draining through read().
+
+#include <atomic>
+#include <thread>
+
+#include "test_common.h"
+#include "protocentral_ads1293_task.h"
+
+// Wait (in real time) until the task has read the pending frame to the end
+// of its burst and, if given, the consumer has drained the ring. Virtual
+// time stands still meanwhile, so the threads keep pace with the simulated
+// device. (DRDY already rises at the first data byte; moving the clock on
+// from there would race the rest of the burst against the next frame.)
+static bool waitForTask(TestRig &rig, const ADS1293AcquisitionTask *drained = nullptr)
+{
+  const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (std::chrono::steady_clock::now() < deadline)
+  {
+    {
+      std::lock_guard<std::recursive_mutex> guard(shim::lock());
+      if (!rig.sim.drdyLow() && !shim::transactionOpen() && (!drained || drained->available() == 0))
+        return true;
+    }
+    std::this_thread::yield();
+  }
+  return false;
+}
+
+struct Consumer {
+  ADS1293AcquisitionTask *task = nullptr;
+  std::atomic<bool> done{false};
+  std::atomic<bool> stall{false};
+  uint32_t frames = 0;
+  uint32_t outOfOrder = 0;
+  bool missed = false;
+  uint32_t lastIndex = 0;
+
+  void run()
+  {
+    ADS1293::Samples out[16];
+    while (!done)
+    {
+      if (stall)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        continue;
+      }
+      bool m = false;
+      const size_t n = task->read(out, 16, 50, &m);
+      missed |= m;
+      for (size_t i = 0; i < n; ++i)
+      {
+        if (frames && out[i].index != lastIndex + 1)
+          ++outOfOrder;
+        lastIndex = out[i].index;
+        ++frames;
+      }
+    }
+  }
+};
+
+static void testTask()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  CHECK(rig.ecg.setSamplingRate(ADS1293::SamplingRate::SPS_1600));
+  shim::advanceUs(10000); // past the initial DRDY mask
+  CHECK(!rig.ecg.deferredReads());
+
+  static ADS1293::Samples ring[64];
+  ADS1293AcquisitionTask task;
+  CHECK(!task.start(rig.ecg, nullptr, 64));
+  CHECK(task.start(rig.ecg, ring, 64));
+  CHECK(task.running());
+  CHECK(!task.start(rig.ecg, ring, 64));
+  CHECK(rig.ecg.deferredReads());
+
+  Consumer consumer;
+  consumer.task = &task;
+  std::thread reader(&Consumer::run, &consumer);
+
+  // two seconds at 1600 SPS, half an output period at a time, with a
+  // 20-frame consumer stall half way. The task runs only between steps, so
+  // a whole-period step would leave a frame that arrives at the start of
+  // one waiting almost a period, and whether the next edge beats the read
+  // would depend on how long the read path takes to reach the bus.
+  // (a frame left pending from before start() is overwritten at the first
+  // edge, so take the baseline one period in)
+  shim::advanceUs(625);
+  CHECK(waitForTask(rig, &task));
+  const uint32_t edgesBefore = rig.sim.drdyEdges();
+  const uint32_t acquiredBefore = task.framesAcquired();
+  const uint32_t overwrittenBefore = rig.sim.framesOverwritten();
+  const uint64_t startNs = shim::nowNs();
+  bool kept = true;
+  for (uint16_t i = 0; i < 3200; ++i)
+  {
+    consumer.stall = i >= 1600 && i < 1620;
+    for (uint8_t half = 0; half < 2; ++half)
+    {
+      shim::advanceNs(312500);
+      kept &= waitForTask(rig, consumer.stall ? nullptr : &task);
+    }
+  }
+  consumer.stall = false;
+  const uint32_t edges = rig.sim.drdyEdges() - edgesBefore;
+  // the task's own bus and micros() time moves the virtual clock too
+  const double periods = (shim::nowNs() - startNs) / rig.sim.ecgPeriodNs(1);
+
+  // drained
+  const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (task.available() && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::yield();
+  consumer.done = true;
+  reader.join();
+
+  CHECK(kept);
+  CHECK_NEAR(edges, periods, 1);
+  CHECK_EQ(task.framesAcquired(), consumer.frames);
+  CHECK_EQ(task.framesAcquired() - acquiredBefore, edges);
+  CHECK_EQ(consumer.outOfOrder, 0);
+  CHECK(!consumer.missed);
+  CHECK_EQ(task.framesDropped(), 0);
+  CHECK_NEAR(task.queueHighWater(), 20, 1); // the stall, give or take the edge phase
+  CHECK_EQ(rig.sim.framesOverwritten() - overwrittenBefore, 0);
+  benchResult("task", "queue_high_water", task.queueHighWater(), "frames");
+
+  task.stop();
+  CHECK(!task.running());
+  CHECK(!rig.ecg.acquisitionActive());
+  CHECK(!rig.ecg.deferredReads());
+  CHECK(!shim::interruptAttached(digitalPinToInterrupt(TestRig::DRDY_PIN)));
+  ADS1293::Samples out[4];
+  CHECK_EQ(task.read(out, 4, 10), 0);
+  task.stop(); // again: no-op
+}
+
+// stop() with a consumer blocked in read(): the read returns empty, stop()
+// waits for it, and a consumer still draining while the task winds down
+// never reads the device itself (frames stay in order, none is read twice).
+static void testStopWhileReading()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  CHECK(rig.ecg.setSamplingRate(ADS1293::SamplingRate::SPS_1600));
+  shim::advanceUs(10000);
+
+  static ADS1293::Samples ring[64];
+  ADS1293AcquisitionTask task;
+  CHECK(task.start(rig.ecg, ring, 64));
+
+  // blocked: no DRDY edges while virtual time stands still
+  std::atomic<int> result{-1};
+  std::thread blocked([&] {
+    ADS1293::Samples out[4];
+    result = static_cast<int>(task.read(out, 4, 5000));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  CHECK_EQ(result.load(), -1);
+  const std::chrono::steady_clock::time_point stopStart = std::chrono::steady_clock::now();
+  task.stop();
+  const double stopMs =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stopStart).count();
+  CHECK_EQ(result.load(), 0); // returned before stop() did
+  blocked.join();
+  CHECK(stopMs < 1000.0);
+  CHECK(!task.running());
+  CHECK(!rig.ecg.deferredReads());
+
+  // draining with zero-timeout reads while edges keep coming and stop()
+  // runs on another thread; once stop() has begun the task may fall behind
+  // (gaps), but a frame is never delivered twice or out of order
+  CHECK(task.start(rig.ecg, ring, 64));
+  std::atomic<bool> draining{true};
+  std::vector<uint32_t> indices;
+  std::thread drainer([&] {
+    ADS1293::Samples out[16];
+    while (draining)
+    {
+      const size_t n = task.read(out, 16, 0);
+      for (size_t i = 0; i < n; ++i)
+        indices.push_back(out[i].index);
+    }
+  });
+  std::thread stopper;
+  for (uint16_t i = 0; i < 400; ++i)
+  {
+    if (i == 200)
+      stopper = std::thread([&] { task.stop(); });
+    shim::advanceUs(625);
+    if (i < 200)
+      CHECK(waitForTask(rig, &task));
+  }
+  stopper.join();
+  draining = false;
+  drainer.join();
+  CHECK(indices.size() >= 200);
+  uint32_t gaps = 0, backwards = 0;
+  for (size_t i = 1; i < indices.size(); ++i)
+  {
+    if (indices[i] <= indices[i - 1])
+      ++backwards;
+    else if (i < 200 && indices[i] != indices[i - 1] + 1)
+      ++gaps;
+  }
+  CHECK_EQ(gaps, 0);
+  CHECK_EQ(backwards, 0);
+  CHECK(!task.running());
+  CHECK(!rig.ecg.acquisitionActive());
+  CHECK(!rig.ecg.deferredReads());
+}
+
+// A task that falls behind loses frames to the device, not to the ring.
+static void testTaskFallsBehind()
+{
+  TestRig rig;
+  shim::advanceUs(20000);
+  CHECK(rig.ecg.begin3LeadECG());
+  CHECK(rig.ecg.setSamplingRate(ADS1293::SamplingRate::SPS_1600));
+  shim::advanceUs(10000);
+
+  static ADS1293::Samples ring[64];
+  ADS1293AcquisitionTask task;
+  CHECK(task.start(rig.ecg, ring, 64));
+  {
+    // hold the bus for five periods: the task cannot read in between
+    std::lock_guard<std::recursive_mutex> guard(shim::lock());
+    shim::advanceUs(5 * 625);
+  }
+  CHECK(waitForTask(rig));
+  ADS1293::Samples out[64];
+  bool missed = false;
+  size_t n = 0;
+  for (uint8_t tries = 0; tries < 100 && n == 0; ++tries)
+    n = task.read(out, 64, 20, &missed);
+  CHECK(n >= 1);
+  CHECK(rig.sim.framesOverwritten() >= 3);
+  task.stop();
+}
+
+int main()
+{
+  testTask();
+  testStopWhileReading();
+  testTaskFallsBehind();
+  return testResult("test_task");
+}
@@ -14,18 +14,25 @@ PROG_NAME=$(basename "$0")
 DEFAULT_FQBN_ESP32="esp32:esp32:esp32"
 DEFAULT_FQBN_UNO="arduino:avr:uno"
 
-EX1_PATH="examples/Example1-3leadECGstream-arduino-plotter"
-EX2_PATH="examples/Example2-5leadECGstream-arduino-plotter"
-EX3_PATH="examples/Example3-5leadECGstream-openview"
-
-EXAMPLES_AVAILABLE=("1" "2" "3")
+EX1_PATH="examples/Example-1-3leadECGstream-arduino-plotter"
+EX2_PATH="examples/Example-2-5leadECGstream-arduino-plotter"
+EX3_PATH="examples/Example-3-5leadECGstream-openview"
+EX4_PATH="examples/Example-4-acquisition-benchmark"
+EX5_PATH="examples/Example-5-compact-binary-stream"
+EX6_PATH="examples/Example-6-qrs-heart-rate"
+EX7_PATH="examples/Example-7-startup-time"
+EX8_PATH="examples/Example-8-lossless-compression"
+EX9_PATH="examples/Example-9-frame-dispatch"
+EX10_PATH="examples/Example-10-rtos-acquisition"
+
+EXAMPLES_AVAILABLE=("1" "2" "3" "4" "5" "6" "7" "8" "9" "10")
 
 show_help() {
   cat <<EOF
 Usage: $PROG_NAME [OPTIONS]
 
 Options:
-  --example N|all     Example to act on: 1,2,3 or all (default: 1)
+  --example N|all     Example to act on: 1-10 or all (default: 1)
   --board NAME        Shorthand board: esp32 or uno (sets a sensible default FQBN)
   --fqbn FQBN         Fully-qualified board name passed to arduino-cli (overrides --board)
   --upload            After compile, upload to device (requires --port)
@@ -38,6 +45,8 @@ Options:
 Examples:
   $PROG_NAME --example 3 --board esp32 --upload --port /dev/cu.usbserial-0001
   $PROG_NAME --example all --fqbn "arduino:avr:uno" --compile-only
+
+Host-side benchmarks (no board needed) are run by scripts/host_bench.sh.
 EOF
 }
 
@@ -89,6 +98,13 @@ run_example() {
     1) path="$EX1_PATH";;
     2) path="$EX2_PATH";;
     3) path="$EX3_PATH";;
+    4) path="$EX4_PATH";;
+    5) path="$EX5_PATH";;
+    6) path="$EX6_PATH";;
+    7) path="$EX7_PATH";;
+    8) path="$EX8_PATH";;
+    9) path="$EX9_PATH";;
+    10) path="$EX10_PATH";;
     *) echo "Unsupported example: $exnum"; return 2;;
   esac
 
@@ -0,0 +1,150 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Host benchmark runner for protocentral-ads1293-arduino
+# Builds and runs the host tests (extras/test), collects their BENCH lines into
+# a CSV and compares them against a baseline.
+#
+# Metrics measured on the simulator's virtual clock (bus time, transactions,
+# bytes, accuracy) are exact and compared tightly; host wall-clock figures
+# (unit "ns") only mean something against a baseline taken on the same
+# machine and are compared with a wider tolerance.
+#
+# Usage examples:
+#   ./scripts/host_bench.sh
+#   ./scripts/host_bench.sh --output bench.csv
+#   ./scripts/host_bench.sh --update --exact-only
+#   ./scripts/host_bench.sh --baseline my_machine.csv --update
+
+PROG_NAME=$(basename "$0")
+ROOT_DIR=$(cd "$(dirname "$0")/.." && pwd)
+
+BUILD_DIR="$ROOT_DIR/build-bench"
+BASELINE="$ROOT_DIR/extras/test/bench_baseline.csv"
+OUTPUT=""
+UPDATE=false
+EXACT_ONLY=false
+EXACT_TOL="0.1"
+WALL_TOL="25"
+
+show_help() {
+  cat <<EOF
+Usage: $PROG_NAME [OPTIONS]
+
+Options:
+  --build-dir DIR     Host test build directory (default: build-bench)
+  --baseline FILE     Baseline CSV (default: extras/test/bench_baseline.csv)
+  --output FILE       Also write this run's results as CSV
+  --update            Write this run's results to the baseline instead of comparing
+  --exact-only        Leave out host wall-clock metrics (unit "ns")
+  --exact-tol PCT     Allowed change of exact metrics, in percent (default: $EXACT_TOL)
+  --wall-tol PCT      Allowed slowdown of wall-clock metrics, in percent (default: $WALL_TOL)
+  -h, --help          Show this message
+
+Results are printed one per line as
+
+  RESULT,<benchmark>,<metric>,<baseline>,<current>,<unit>,<change %>,<status>
+
+with status ok, improved, regressed, new or missing. The exit status is 1 if a
+test failed, a metric regressed or a baseline metric is missing.
+EOF
+}
+
+while [ $# -gt 0 ]; do
+  case "$1" in
+    --build-dir)
+      BUILD_DIR="$2"; shift 2;;
+    --baseline)
+      BASELINE="$2"; shift 2;;
+    --output)
+      OUTPUT="$2"; shift 2;;
+    --update)
+      UPDATE=true; shift 1;;
+    --exact-only)
+      EXACT_ONLY=true; shift 1;;
+    --exact-tol)
+      EXACT_TOL="$2"; shift 2;;
+    --wall-tol)
+      WALL_TOL="$2"; shift 2;;
+    -h|--help)
+      show_help; exit 0;;
+    *) echo "Unknown option: $1"; show_help; exit 2;;
+  esac
+done
+
+echo "==> Building host tests in $BUILD_DIR"
+cmake -S "$ROOT_DIR/extras/test" -B "$BUILD_DIR" -DCMAKE_BUILD_TYPE=Release >/dev/null
+cmake --build "$BUILD_DIR" -j"$(nproc 2>/dev/null || echo 4)" >/dev/null
+
+# Tests run one at a time so wall-clock figures are not skewed by each other.
+echo "==> Running host tests"
+LOG=$(mktemp)
+CURRENT=$(mktemp)
+trap 'rm -f "$LOG" "$CURRENT"' EXIT
+TESTS_OK=true
+if ! ctest --test-dir "$BUILD_DIR" -V >"$LOG" 2>&1; then
+  TESTS_OK=false
+  grep -E "CHECK|Failed|\*\*\*" "$LOG" >&2 || true
+fi
+
+# ctest -V prefixes each line of test output with "<test number>: "
+echo "benchmark,metric,value,unit" >"$CURRENT"
+sed -n 's/^[0-9]*: //; /^BENCH,/s/^BENCH,//p' "$LOG" |
+  awk -F, -v exactOnly="$EXACT_ONLY" 'exactOnly != "true" || $4 != "ns"' >>"$CURRENT"
+
+if [ -n "$OUTPUT" ]; then
+  cp "$CURRENT" "$OUTPUT"
+  echo "==> Results written to $OUTPUT"
+fi
+
+if $UPDATE; then
+  cp "$CURRENT" "$BASELINE"
+  echo "==> Baseline written to $BASELINE ($(($(wc -l <"$CURRENT") - 1)) metrics)"
+  if ! $TESTS_OK; then
+    echo "==> Host tests failed"; exit 1
+  fi
+  exit 0
+fi
+
+if [ ! -f "$BASELINE" ]; then
+  echo "No baseline at $BASELINE (create one with --update)"; exit 2
+fi
+
+# Accuracy-like units ("x" ratio, "%") are better when higher, everything
+# else (time, bytes, counts, error) when lower.
+REGRESSED=0
+awk -F, -v exactTol="$EXACT_TOL" -v wallTol="$WALL_TOL" -v exactOnly="$EXACT_ONLY" '
+  function abs(v) { return v < 0 ? -v : v }
+  FNR == 1 { next }
+  NR == FNR { base[$1 "," $2] = $3; unit[$1 "," $2] = $4; order[++n] = $1 "," $2; next }
+  {
+    key = $1 "," $2
+    seen[key] = 1
+    if (!(key in base)) { printf "RESULT,%s,,%s,%s,,new\n", key, $3, $4; next }
+    b = base[key]; c = $3
+    change = b != 0 ? (c - b) * 100.0 / abs(b) : (c != 0 ? 100.0 : 0.0)
+    worse = ($4 == "x" || $4 == "%") ? -change : change
+    tol = $4 == "ns" ? wallTol : exactTol
+    status = worse > tol ? "regressed" : (worse < -tol ? "improved" : "ok")
+    if (status == "regressed") bad = 1
+    printf "RESULT,%s,%s,%s,%s,%.2f,%s\n", key, b, c, $4, change, status
+  }
+  END {
+    for (i = 1; i <= n; ++i)
+    {
+      key = order[i]
+      if (seen[key] || (exactOnly == "true" && unit[key] == "ns"))
+        continue
+      printf "RESULT,%s,%s,,%s,,missing\n", key, base[key], unit[key]
+      bad = 1
+    }
+    exit bad
+  }' "$BASELINE" "$CURRENT" || REGRESSED=1
+
+if ! $TESTS_OK; then
+  echo "==> Host tests failed"; exit 1
+fi
+if [ "$REGRESSED" -ne 0 ]; then
+  echo "==> Benchmark regression against $BASELINE"; exit 1
+fi
+echo "Done."
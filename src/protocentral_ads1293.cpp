@@ -11,14 +11,101 @@
 //////////////////////////////////////////////////////////////////////////////////////////
 
 #include "protocentral_ads1293.h"
+#include "protocentral_ads1293_filter.h"
+#include "protocentral_ads1293_profile.h"
+
+#if defined(__AVR__)
+#include <util/atomic.h>
+#endif
+
+// Interrupt handlers (and what they call) must live in IRAM on Espressif cores.
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+#define ADS1293_ISR_ATTR IRAM_ATTR
+#else
+#define ADS1293_ISR_ATTR
+#endif
+
+// Wraps the metric updates on the hot path (see ADS1293_ENABLE_METRICS);
+// expands to nothing when metrics are disabled.
+#if ADS1293_ENABLE_METRICS
+#define ADS1293_METRIC(...) __VA_ARGS__
+#else
+#define ADS1293_METRIC(...)
+#endif
+
+// Ring indices and counters are shared between the DRDY interrupt and the
+// loop. 8-bit AVR cannot load/store them in one instruction, so guard the
+// access there; everywhere else use acquire/release atomics so the slot
+// contents are visible before the index that publishes them.
+namespace {
+template <typename T>
+inline T loadShared(const volatile T &v) noexcept
+{
+#if defined(__AVR__)
+	T r;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { r = v; }
+	return r;
+#else
+	return __atomic_load_n(&v, __ATOMIC_ACQUIRE);
+#endif
+}
+
+template <typename T>
+inline void storeShared(volatile T &v, T x) noexcept
+{
+#if defined(__AVR__)
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { v = x; }
+#else
+	__atomic_store_n(&v, x, __ATOMIC_RELEASE);
+#endif
+}
+
+// Read-modify-write of a counter that the interrupt also changes.
+template <typename T>
+inline void addShared(volatile T &v, T x) noexcept
+{
+#if defined(__AVR__)
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { v = static_cast<T>(v + x); }
+#else
+	__atomic_fetch_add(&v, x, __ATOMIC_ACQ_REL);
+#endif
+}
+} // namespace
+
+ADS1293 *ADS1293::isrOwner_ = nullptr;
 
 // TODO (non-breaking): consider renaming internal helpers for clarity:
 //  - signExtend24 -> raw24_to_signed32
 //  - getRaw24 -> readRaw24 or readRawSample24
 //  - setSamplingRate -> configureSamplingRate
 
-ADS1293::ADS1293(uint8_t drdyPin, uint8_t csPin, SPIClass *spi) noexcept
-	: drdyPin_(drdyPin), csPin_(csPin), spi_(spi) {}
+// ADS1293 serial clock limit (datasheet F_SCLK max)
+static constexpr uint32_t ADS1293_MAX_SCLK = 20000000;
+
+ADS1293::ADS1293(uint8_t drdyPin, uint8_t csPin, SPIClass *spi, uint32_t spiClockHz) noexcept
+	: drdyPin_(drdyPin), csPin_(csPin), spi_(spi),
+	  spiClockHz_(spiClockHz > ADS1293_MAX_SCLK ? ADS1293_MAX_SCLK : spiClockHz),
+	  spiSettings_(spiClockHz_, MSBFIRST, SPI_MODE0) {}
+
+void ADS1293::setSPIClock(uint32_t hz)
+{
+	if (hz > ADS1293_MAX_SCLK)
+		hz = ADS1293_MAX_SCLK;
+	spiClockHz_ = hz;
+	spiSettings_ = SPISettings(hz, MSBFIRST, SPI_MODE0);
+}
+
+uint32_t ADS1293::measureFrameBusTime(uint8_t iterations)
+{
+	if (!spi_ || acquiring_ || iterations == 0)
+		return 0;
+	uint8_t buf[FRAME_BYTES];
+	const uint32_t start = micros();
+	for (uint8_t i = 0; i < iterations; ++i)
+		readBurst(static_cast<uint8_t>(Register::DATA_CH1_ECG), buf, sizeof(buf));
+	const uint32_t elapsed = micros() - start;
+	return static_cast<uint32_t>((static_cast<uint64_t>(elapsed) * 1000u) / iterations);
+}
 
 void ADS1293::begin(bool startSPI)
 {
@@ -43,107 +130,517 @@ void ADS1293::begin(uint8_t sck, uint8_t miso, uint8_t mosi)
 #if defined(ARDUINO_ARCH_ESP32)
 		spi_->begin(sck, miso, mosi);
 #else
+		(void)sck;
+		(void)miso;
+		(void)mosi;
 		spi_->begin();
 #endif
 	}
 }
 
-bool ADS1293::writeRegister(Register reg, uint8_t value) noexcept
+// Error status registers (0x18..0x1E) are read-only and sit inside the
+// configuration block; they are never cached or written from an image.
+static inline bool isReadOnlyConfigAddr(uint8_t addr) noexcept
+{
+	return addr >= 0x18 && addr <= 0x1E;
+}
+
+static inline bool isCacheable(uint8_t addr) noexcept
+{
+	return addr < ADS1293::RegisterImage::SIZE && !isReadOnlyConfigAddr(addr);
+}
+
+// START_CON write-locks REF_CN..AFE_RES and R2_RATE..MASK_DRDYB; the
+// device ignores writes to them while conversions run.
+static inline bool isStartLocked(uint8_t addr) noexcept
+{
+	return (addr >= 0x11 && addr <= 0x13) || (addr >= 0x21 && addr <= 0x29);
+}
+
+static inline bool maskTest(const uint8_t *mask, uint8_t addr) noexcept
+{
+	return mask[addr >> 3] & (1u << (addr & 7));
+}
+
+static inline void maskSet(uint8_t *mask, uint8_t addr) noexcept
 {
+	mask[addr >> 3] |= static_cast<uint8_t>(1u << (addr & 7));
+}
+
+static inline void maskClear(uint8_t *mask, uint8_t addr) noexcept
+{
+	mask[addr >> 3] &= static_cast<uint8_t>(~(1u << (addr & 7)));
+}
+
+void ADS1293::cacheStore(uint8_t addr, uint8_t value) noexcept
+{
+	if (!isCacheable(addr))
+		return;
+	shadow_[addr] = value;
+	maskSet(shadowValid_, addr);
+	maskClear(shadowDirty_, addr);
+}
+
+bool ADS1293::writeBurst(uint8_t addr, const uint8_t *values, uint8_t len) noexcept
+{
+	// Auto-incrementing write; updates the shadow for cached addresses.
 	if (!spi_)
 		return false;
-	uint8_t addr = static_cast<uint8_t>(reg) & WREG_MASK;
-	spi_->beginTransaction(SPISettings(1000000, MSBFIRST, SPI_MODE0));
+	spi_->beginTransaction(spiSettings_);
 	digitalWrite(csPin_, LOW);
-	spi_->transfer(addr);
-	spi_->transfer(value);
+	spi_->transfer(static_cast<uint8_t>(addr & WREG_MASK));
+	for (uint8_t i = 0; i < len; ++i)
+		spi_->transfer(values[i]);
 	digitalWrite(csPin_, HIGH);
 	spi_->endTransaction();
-	delayMicroseconds(10);
-	return true;
+	ADS1293_METRIC(recordBus(len + 1u);)
+	if (writeDelayUs_)
+		delayMicroseconds(writeDelayUs_);
+	cacheStats_.writes += len;
+
+	// A locked register keeps its old value, so the written one must not
+	// reach the shadow. With CONFIG unknown the lock state is too: drop
+	// those addresses from the cache and let the next read fetch them.
+	bool configKnown = maskTest(shadowValid_, 0);
+	bool started = configKnown && (shadow_[0] & static_cast<uint8_t>(GlobalConfig::Start));
+	bool ignored = false;
+	for (uint8_t i = 0; i < len; ++i)
+	{
+		const uint8_t a = static_cast<uint8_t>(addr + i);
+		if (a == 0)
+		{
+			configKnown = true;
+			started = values[i] & static_cast<uint8_t>(GlobalConfig::Start);
+		}
+		if (isStartLocked(a) && (started || !configKnown))
+		{
+			maskClear(shadowValid_, a);
+			maskClear(shadowDirty_, a);
+			ignored |= started;
+			continue;
+		}
+		cacheStore(a, values[i]);
+	}
+	return !ignored;
+}
+
+bool ADS1293::writeRegister(Register reg, uint8_t value) noexcept
+{
+	if (!spi_)
+		return false;
+	const uint8_t a = static_cast<uint8_t>(reg);
+	if (isCacheable(a) && maskTest(shadowValid_, a) && !maskTest(shadowDirty_, a) && shadow_[a] == value)
+	{
+		++cacheStats_.writesSkipped;
+		return true;
+	}
+	return writeBurst(a, &value, 1);
 }
 
 bool ADS1293::readRegister(Register reg, uint8_t &value) noexcept
 {
 	if (!spi_)
 		return false;
-	uint8_t cmd = static_cast<uint8_t>(reg) | RREG_FLAG;
-	spi_->beginTransaction(SPISettings(1000000, MSBFIRST, SPI_MODE0));
+	const uint8_t a = static_cast<uint8_t>(reg);
+	if (isCacheable(a))
+	{
+		if (maskTest(shadowValid_, a))
+		{
+			++cacheStats_.hits;
+			value = shadow_[a];
+			return true;
+		}
+		++cacheStats_.misses;
+	}
+	uint8_t cmd = a | RREG_FLAG;
+	spi_->beginTransaction(spiSettings_);
 	digitalWrite(csPin_, LOW);
 	spi_->transfer(cmd);
 	value = spi_->transfer(0x00);
 	digitalWrite(csPin_, HIGH);
 	spi_->endTransaction();
+	ADS1293_METRIC(recordBus(2);)
+	// a pending staged value wins over what the device reports
+	if (isCacheable(a) && !maskTest(shadowDirty_, a))
+		cacheStore(a, value);
 	return true;
 }
 
-int32_t ADS1293::signExtend24(uint32_t value) noexcept
+bool ADS1293::writeRegisters(Register start, const uint8_t *values, uint8_t len) noexcept
 {
-	// value is expected to be 24-bit left-aligned in LSB positions
-	value &= 0xFFFFFFu;
-	if (value & 0x800000u)
-	{ // negative
-		return static_cast<int32_t>(value | 0xFF000000u);
+	const uint8_t addr = static_cast<uint8_t>(start);
+	if (!spi_ || !values || len == 0 || addr + len > 0x50)
+		return false;
+
+	bool unchanged = true;
+	for (uint8_t i = 0; i < len && unchanged; ++i)
+	{
+		const uint8_t a = static_cast<uint8_t>(addr + i);
+		unchanged = isCacheable(a) && maskTest(shadowValid_, a) &&
+					!maskTest(shadowDirty_, a) && shadow_[a] == values[i];
 	}
-	return static_cast<int32_t>(value);
+	if (unchanged)
+	{
+		cacheStats_.writesSkipped += len;
+		return true;
+	}
+	return writeBurst(addr, values, len);
 }
 
-bool ADS1293::getECGData(int32_t &ch1, int32_t &ch2, int32_t &ch3)
+bool ADS1293::readRegisters(Register start, uint8_t *values, uint8_t len) noexcept
 {
-	// Read DATA_CH1_ECG (0x37) through DATA_CH3_ECG (0x3F) in one auto-incrementing
-	// SPI transaction. This returns 9 bytes: CH1[MSB,mid,LSB], CH2[MSB,mid,LSB], CH3[MSB,mid,LSB].
-	if (!spi_)
+	const uint8_t addr = static_cast<uint8_t>(start);
+	if (!spi_ || !values || len == 0 || addr + len > 0x50)
 		return false;
 
-	const uint8_t startAddr = 0x37;
-	uint8_t buf[9] = {0};
+	bool cached = true;
+	for (uint8_t i = 0; i < len && cached; ++i)
+	{
+		const uint8_t a = static_cast<uint8_t>(addr + i);
+		cached = isCacheable(a) && maskTest(shadowValid_, a);
+	}
+	if (cached)
+	{
+		cacheStats_.hits += len;
+		memcpy(values, &shadow_[addr], len);
+		return true;
+	}
 
-	spi_->beginTransaction(SPISettings(1000000, MSBFIRST, SPI_MODE0));
-	digitalWrite(csPin_, LOW);
-	spi_->transfer(startAddr | RREG_FLAG);
-	for (int i = 0; i < 9; ++i)
+	if (!readBurst(addr, values, len))
+		return false;
+	for (uint8_t i = 0; i < len; ++i)
+	{
+		const uint8_t a = static_cast<uint8_t>(addr + i);
+		if (!isCacheable(a))
+			continue;
+		++cacheStats_.misses;
+		if (maskTest(shadowDirty_, a))
+			values[i] = shadow_[a];
+		else
+			cacheStore(a, values[i]);
+	}
+	return true;
+}
+
+void ADS1293::RegisterImage::set(Register reg, uint8_t v) noexcept
+{
+	const uint8_t addr = static_cast<uint8_t>(reg);
+	if (addr >= SIZE || isReadOnlyConfigAddr(addr))
+		return;
+	value[addr] = v;
+	mask[addr >> 3] |= static_cast<uint8_t>(1u << (addr & 7));
+}
+
+void ADS1293::RegisterImage::clear() noexcept
+{
+	memset(value, 0, sizeof(value));
+	memset(mask, 0, sizeof(mask));
+}
+
+bool ADS1293::stageRegister(Register reg, uint8_t value) noexcept
+{
+	const uint8_t a = static_cast<uint8_t>(reg);
+	if (!isCacheable(a))
+		return false;
+	if (maskTest(shadowValid_, a) && !maskTest(shadowDirty_, a) && shadow_[a] == value)
+	{
+		++cacheStats_.writesSkipped;
+		return true;
+	}
+	shadow_[a] = value;
+	maskSet(shadowDirty_, a);
+	return true;
+}
+
+bool ADS1293::sync()
+{
+	// Largest run of clean, known registers worth rewriting to join two dirty
+	// runs into one burst. Each bridged byte costs 8 SCLKs; a new transaction
+	// costs a command byte plus CS and transaction setup.
+	const uint8_t maxBridge = 2;
+	const uint8_t size = RegisterImage::SIZE;
+	bool ok = true;
+
+	uint8_t addr = 1; // CONFIG is handled last
+	while (addr < size)
+	{
+		if (!maskTest(shadowDirty_, addr))
+		{
+			++addr;
+			continue;
+		}
+		uint8_t end = addr;
+		uint8_t next = static_cast<uint8_t>(end + 1);
+		while (next < size)
+		{
+			uint8_t gap = next;
+			while (gap < size && gap - next < maxBridge && !maskTest(shadowDirty_, gap) &&
+				   isCacheable(gap) && maskTest(shadowValid_, gap))
+				++gap;
+			if (gap >= size || !maskTest(shadowDirty_, gap))
+				break;
+			end = gap;
+			next = static_cast<uint8_t>(gap + 1);
+		}
+		ok &= writeBurst(addr, &shadow_[addr], static_cast<uint8_t>(end - addr + 1));
+		addr = static_cast<uint8_t>(end + 1);
+	}
+	if (maskTest(shadowDirty_, 0))
+		ok &= writeBurst(0x00, &shadow_[0], 1);
+	return ok;
+}
+
+bool ADS1293::verify()
+{
+	// Two bursts cover the cached block around the read-only error registers.
+	uint8_t lo[0x18];
+	uint8_t hi[RegisterImage::SIZE - 0x1F];
+	if (!readBurst(0x00, lo, sizeof(lo)) || !readBurst(0x1F, hi, sizeof(hi)))
+		return false;
+
+	bool match = true;
+	for (uint8_t a = 0; a < RegisterImage::SIZE; ++a)
 	{
-		buf[i] = spi_->transfer(0x00);
+		if (!isCacheable(a) || maskTest(shadowDirty_, a))
+			continue;
+		const uint8_t dev = a < 0x18 ? lo[a] : hi[a - 0x1F];
+		if (maskTest(shadowValid_, a) && shadow_[a] != dev)
+			match = false;
+		cacheStore(a, dev);
 	}
+	return match;
+}
+
+void ADS1293::invalidateCache() noexcept
+{
+	memset(shadowValid_, 0, sizeof(shadowValid_));
+	memset(shadowDirty_, 0, sizeof(shadowDirty_));
+}
+
+bool ADS1293::applyConfiguration(const RegisterImage &img)
+{
+	bool ok = true;
+	for (uint8_t a = 0; a < RegisterImage::SIZE; ++a)
+		if (img.isSet(a))
+			ok &= stageRegister(static_cast<Register>(a), img.value[a]);
+	return sync() && ok;
+}
+
+// Profile images live in flash, which AVR and ESP8266 do not map into the
+// data address space.
+static inline void copyFromProgmem(uint8_t *dst, const uint8_t *src, uint8_t len) noexcept
+{
+#if defined(__AVR__) || defined(ARDUINO_ARCH_ESP8266)
+	memcpy_P(dst, src, len);
+#else
+	memcpy(dst, src, len);
+#endif
+}
+
+bool ADS1293::applyProfile(const uint8_t *image)
+{
+	if (!image)
+		return false;
+	// Writing CONFIG first clears START_CON, which would otherwise keep
+	// REF_CN..AFE_RES and R2_RATE..MASK_DRDYB write-locked. The error
+	// registers, DIGO_STRENGTH and reserved 0x20 are skipped; 0x16 and
+	// 0x2B..0x2D carry their required reset values.
+	uint8_t buf[0x18];
+	copyFromProgmem(buf, image, sizeof(buf));
+	const uint8_t config = buf[0];
+	buf[0] = static_cast<uint8_t>(config & ~0x01u);
+	bool ok = writeBurst(0x00, buf, sizeof(buf));
+
+	const uint8_t hiLen = PROFILE_BYTES - 0x21;
+	copyFromProgmem(buf, image + 0x21, hiLen);
+	ok = ok && writeBurst(0x21, buf, hiLen);
+	ok = ok && writeBurst(0x00, &config, 1);
+
+	// Re-merge the readout bits the driver owns into CH_CNFG.
+	if (ok && wideFrames())
+		ok = updateLoopConfig();
+	return ok && updateRateSchedule(false);
+}
+
+bool ADS1293::startup(const uint8_t *image, Samples *settled, StartupTiming *timing, uint16_t timeoutMs)
+{
+	if (!image || acquiring_)
+		return false;
+	StartupTiming t;
+	const uint32_t startUs = micros();
+	const uint32_t startMs = millis();
+
+	// REVID reads as 0x00 or 0xFF until the serial interface is up.
+	uint8_t rev = 0;
+	while (!readRegister(Register::REVID, rev) || rev == 0x00 || rev == 0xFF)
+	{
+		if (millis() - startMs >= timeoutMs)
+			return false;
+	}
+	t.readyUs = micros() - startUs;
+
+	// The crystal needs CLOCK_START_MS before the digital clock may be
+	// enabled. It starts at power-up, or when power-down is left.
+	uint8_t profileOsc = 0, osc = 0, config = 0;
+	copyFromProgmem(&profileOsc, image + static_cast<uint8_t>(Register::OSC_CN), 1);
+	if (!(profileOsc & 0x02u) && readRegister(Register::OSC_CN, osc) && readRegister(Register::CONFIG, config))
+	{
+		if (config & static_cast<uint8_t>(GlobalConfig::PowerDown))
+		{
+			// timed in microseconds: a millis() start stamp is truncated
+			// and would cut the wait by up to 1 ms
+			writeRegister(Register::CONFIG, static_cast<uint8_t>(GlobalConfig::Standby));
+			const uint32_t clockFromUs = micros();
+			while (micros() - clockFromUs < CLOCK_START_MS * 1000UL)
+			{
+			}
+		}
+		else if (!(osc & 0x04u))
+		{
+			while (millis() < CLOCK_START_MS)
+			{
+			}
+		}
+	}
+
+	if (!applyProfile(image))
+		return false;
+	t.configuredUs = micros() - startUs;
+
+	uint8_t profileConfig = 0, maskDrdyb = 0;
+	copyFromProgmem(&profileConfig, image + static_cast<uint8_t>(Register::CONFIG), 1);
+	copyFromProgmem(&maskDrdyb, image + static_cast<uint8_t>(Register::MASK_DRDYB), 1);
+	if (profileConfig & static_cast<uint8_t>(GlobalConfig::Start))
+	{
+		// Masked (the reset default), the first DRDY is conversion
+		// DRDY_MASK_FRAMES and already settled. Unmasked, DRDY n is
+		// conversion n.
+		static_assert(DRDY_MASK_FRAMES >= SETTLE_FRAMES, "the first masked DRDY must be settled");
+		const uint8_t settledFrame = (maskDrdyb & 0x02u) ? SETTLE_FRAMES : 1;
+		for (uint8_t frame = 1;; ++frame)
+		{
+			while (digitalRead(drdyPin_) != LOW)
+			{
+				if (millis() - startMs >= timeoutMs)
+					return false;
+			}
+			const uint32_t now = micros() - startUs;
+			if (frame == 1)
+				t.firstSampleUs = now;
+			if (frame >= settledFrame)
+			{
+				t.settledSampleUs = now;
+				break;
+			}
+			uint8_t block[DATA_BLOCK_BYTES];
+			readFrame(block); // discard; the read releases DRDY
+		}
+		if (settled && readFrames(settled, 1) != 1)
+			return false;
+	}
+
+	if (timing)
+		*timing = t;
+	return true;
+}
+
+ADS1293_ISR_ATTR bool ADS1293::readBurst(uint8_t startAddr, uint8_t *buf, size_t len) noexcept
+{
+	// Auto-incrementing read. The buffer form of transfer() lets the core use
+	// its fastest path (FIFO/DMA on many targets) instead of one call per byte.
+	if (!spi_)
+		return false;
+	memset(buf, 0, len);
+	spi_->beginTransaction(spiSettings_);
+	digitalWrite(csPin_, LOW);
+	spi_->transfer(static_cast<uint8_t>(startAddr | RREG_FLAG));
+	spi_->transfer(buf, len);
 	digitalWrite(csPin_, HIGH);
 	spi_->endTransaction();
+	ADS1293_METRIC(recordBus(len + 1u);)
+	return true;
+}
+
+int32_t ADS1293::signExtend24(uint32_t value) noexcept
+{
+	// value is expected to be 24-bit left-aligned in LSB positions.
+	// Flip the sign bit and subtract it back: branch-free two's-complement
+	// extension from bit 23.
+	return static_cast<int32_t>(((value & 0xFFFFFFu) ^ 0x800000u) - 0x800000u);
+}
+
+static inline int32_t load24(const uint8_t *p) noexcept
+{
+	return static_cast<int32_t>((((static_cast<uint32_t>(p[0]) << 16) |
+								  (static_cast<uint32_t>(p[1]) << 8) |
+								  static_cast<uint32_t>(p[2])) ^ 0x800000u) - 0x800000u);
+}
+
+void ADS1293::decodeFrame(const uint8_t *buf, int32_t &ch1, int32_t &ch2, int32_t &ch3) noexcept
+{
+	// buf holds CH1[MSB,mid,LSB], CH2[MSB,mid,LSB], CH3[MSB,mid,LSB]
+	ch1 = load24(buf);
+	ch2 = load24(buf + 3);
+	ch3 = load24(buf + 6);
+}
+
+void ADS1293::decodeFrames(const uint8_t *raw, size_t frames, int32_t *ch1, int32_t *ch2, int32_t *ch3) noexcept
+{
+	// One pass per channel keeps the inner loops free of per-sample branches.
+	int32_t *out[3] = {ch1, ch2, ch3};
+	for (uint8_t c = 0; c < 3; ++c)
+	{
+		int32_t *dst = out[c];
+		if (!dst)
+			continue;
+		const uint8_t *src = raw + 3 * c;
+		for (size_t i = 0; i < frames; ++i, src += FRAME_BYTES)
+			dst[i] = load24(src);
+	}
+}
+
+void ADS1293::decodeFrames(const uint8_t *raw, size_t frames, float *ch1, float *ch2, float *ch3, float lsbVolts) noexcept
+{
+	float *out[3] = {ch1, ch2, ch3};
+	for (uint8_t c = 0; c < 3; ++c)
+	{
+		float *dst = out[c];
+		if (!dst)
+			continue;
+		const uint8_t *src = raw + 3 * c;
+		for (size_t i = 0; i < frames; ++i, src += FRAME_BYTES)
+			dst[i] = static_cast<float>(load24(src)) * lsbVolts;
+	}
+}
+
+float ADS1293::voltsPerLsb(float vref, int32_t adcFullscale, float gain) noexcept
+{
+	if (adcFullscale == 0) adcFullscale = (1 << 23) - 1;
+	return vref * gain / static_cast<float>(adcFullscale);
+}
 
-	// assemble 24-bit raw samples and sign-extend to int32
-	uint32_t raw1 = (static_cast<uint32_t>(buf[0]) << 16) |
-					(static_cast<uint32_t>(buf[1]) << 8) |
-					static_cast<uint32_t>(buf[2]);
-	uint32_t raw2 = (static_cast<uint32_t>(buf[3]) << 16) |
-					(static_cast<uint32_t>(buf[4]) << 8) |
-					static_cast<uint32_t>(buf[5]);
-	uint32_t raw3 = (static_cast<uint32_t>(buf[6]) << 16) |
-					(static_cast<uint32_t>(buf[7]) << 8) |
-					static_cast<uint32_t>(buf[8]);
-
-	ch1 = signExtend24(raw1);
-	ch2 = signExtend24(raw2);
-	ch3 = signExtend24(raw3);
+bool ADS1293::getECGData(int32_t &ch1, int32_t &ch2, int32_t &ch3)
+{
+	// Read DATA_CH1_ECG (0x37) through DATA_CH3_ECG (0x3F) in one auto-incrementing
+	// SPI transaction. This returns 9 bytes: CH1[MSB,mid,LSB], CH2[MSB,mid,LSB], CH3[MSB,mid,LSB].
+	uint8_t buf[9];
+	if (!readBurst(static_cast<uint8_t>(Register::DATA_CH1_ECG), buf, sizeof(buf)))
+		return false;
+	decodeFrame(buf, ch1, ch2, ch3);
 	return true;
 }
 
 bool ADS1293::getRaw24(uint8_t channel, uint32_t &raw24)
 {
-	if (!spi_)
-		return false;
 	if (channel < 1 || channel > 3)
 		return false;
 
 	// DATA_CHn_ECG registers start at 0x37 for channel 1 (MSB). Each channel uses 3 bytes.
 	// Compute start address as 0x37 + (channel-1)*3 so channel=1 -> 0x37
 	const uint8_t startAddr = static_cast<uint8_t>(0x37 + ((channel - 1) * 3));
-	uint8_t buf3[3] = {0};
-
-	spi_->beginTransaction(SPISettings(1000000, MSBFIRST, SPI_MODE0));
-	digitalWrite(csPin_, LOW);
-	spi_->transfer(startAddr | RREG_FLAG);
-	for (int i = 0; i < 3; ++i)
-		buf3[i] = spi_->transfer(0x00);
-	digitalWrite(csPin_, HIGH);
-	spi_->endTransaction();
+	uint8_t buf3[3];
+	if (!readBurst(startAddr, buf3, sizeof(buf3)))
+		return false;
 
 	raw24 = (static_cast<uint32_t>(buf3[0]) << 16) | (static_cast<uint32_t>(buf3[1]) << 8) | static_cast<uint32_t>(buf3[2]);
 	return true;
@@ -151,18 +648,7 @@ bool ADS1293::getRaw24(uint8_t channel, uint32_t &raw24)
 
 bool ADS1293::readSampleBytes(uint8_t outBuf[9])
 {
-	if (!spi_)
-		return false;
-	const uint8_t startAddr = 0x37;
-
-	spi_->beginTransaction(SPISettings(1000000, MSBFIRST, SPI_MODE0));
-	digitalWrite(csPin_, LOW);
-	spi_->transfer(startAddr | RREG_FLAG);
-	for (int i = 0; i < 9; ++i)
-		outBuf[i] = spi_->transfer(0x00);
-	digitalWrite(csPin_, HIGH);
-	spi_->endTransaction();
-	return true;
+	return readBurst(static_cast<uint8_t>(Register::DATA_CH1_ECG), outBuf, 9);
 }
 
 bool ADS1293::dumpDebug(Print &out)
@@ -194,31 +680,550 @@ bool ADS1293::dumpDebug(Print &out)
 			out.print('0');
 		out.print(v, HEX);
 	}
-	out.println();
-	return true;
+	out.println();
+#if ADS1293_ENABLE_METRICS
+	const Metrics m = getMetrics();
+	out.print(F("FRAMES: read="));
+	out.print(m.framesRead);
+	out.print(F(" missed="));
+	out.print(m.framesMissed);
+	out.print(F(" dropped="));
+	out.print(m.ringDrops);
+	out.print(F(" errors="));
+	out.print(m.readErrors);
+	out.print(F(" edges="));
+	out.println(m.drdyEdges);
+	out.print(F("LATENCY_US:"));
+	for (uint8_t i = 0; i < Metrics::LATENCY_BUCKETS; ++i) {
+		out.print(' ');
+		if (i + 1 < Metrics::LATENCY_BUCKETS) {
+			out.print('<');
+			out.print(8ul << i);
+		} else {
+			out.print(F(">="));
+			out.print(8ul << (i - 1));
+		}
+		out.print('=');
+		out.print(m.latency[i]);
+	}
+	out.print(F(" max="));
+	out.println(m.maxLatencyUs);
+	out.print(F("BUS: bytes="));
+	out.print(m.busBytes);
+	out.print(F(" us="));
+	out.println(m.busUs);
+	out.print(F("DECODE: frames="));
+	out.print(m.decodes);
+	out.print(F(" us="));
+	out.println(m.decodeUs);
+#endif
+	return true;
+}
+
+ADS1293::Metrics ADS1293::getMetrics() const noexcept
+{
+#if ADS1293_ENABLE_METRICS
+	Metrics m;
+#if defined(__AVR__)
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { m = metrics_; }
+#else
+	m = metrics_;
+#endif
+	return m;
+#else
+	return Metrics();
+#endif
+}
+
+void ADS1293::resetMetrics() noexcept
+{
+#if ADS1293_ENABLE_METRICS
+#if defined(__AVR__)
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { metrics_ = Metrics(); }
+#else
+	metrics_ = Metrics();
+#endif
+#endif
+}
+
+#if ADS1293_ENABLE_METRICS
+ADS1293_ISR_ATTR void ADS1293::recordLatency(uint32_t us) noexcept
+{
+	uint8_t bucket = 0;
+	while (bucket + 1 < Metrics::LATENCY_BUCKETS && us >= (8ul << bucket))
+		++bucket;
+	++metrics_.latency[bucket];
+	if (us > metrics_.maxLatencyUs)
+		metrics_.maxLatencyUs = us;
+}
+
+// The bus and frame counters are updated from the interrupt and from
+// loop() (polled reads, register access), so they take the shared adds.
+ADS1293_ISR_ATTR void ADS1293::recordBus(size_t bytes) noexcept
+{
+	addShared(metrics_.busBytes, static_cast<uint32_t>(bytes));
+}
+
+ADS1293_ISR_ATTR void ADS1293::recordFrameRead(uint32_t startUs, uint32_t endUs) noexcept
+{
+	addShared(metrics_.busUs, endUs - startUs);
+	addShared(metrics_.framesRead, static_cast<uint32_t>(1));
+}
+
+ADS1293_ISR_ATTR void ADS1293::recordDecode(uint32_t startUs) noexcept
+{
+	addShared(metrics_.decodeUs, static_cast<uint32_t>(micros() - startUs));
+	addShared(metrics_.decodes, static_cast<uint32_t>(1));
+}
+#endif
+
+	// interpretRaw24 removed: library now always interprets ADC output as
+	// two's-complement 24-bit. Use signExtend24() for conversion.
+
+	float ADS1293::rawToVoltage(int32_t signedCode, float vref, int32_t adcFullscale, float gain) noexcept
+	{
+		if (adcFullscale == 0) adcFullscale = (1 << 23) - 1;
+		return (static_cast<float>(signedCode) / static_cast<float>(adcFullscale)) * vref * gain;
+	}
+
+ADS1293::Samples ADS1293::getECGData()
+{
+	Samples s;
+	int32_t a = 0, b = 0, c = 0;
+	if (getECGData(a, b, c))
+	{
+		s.ch1 = a;
+		s.ch2 = b;
+		s.ch3 = c;
+		s.ok = true;
+	}
+	return s;
+}
+
+bool ADS1293::startAcquisition(Samples *buffer, uint16_t depth)
+{
+	if (!spi_)
+		return false;
+	if (buffer)
+	{
+		if (depth < 2 || depth > 0x8000u || (depth & (depth - 1)) != 0)
+			return false;
+	}
+	else if (!frameCb_)
+	{
+		return false;
+	}
+	int irq = digitalPinToInterrupt(drdyPin_);
+	if (irq == NOT_AN_INTERRUPT)
+		return false;
+
+	stopAcquisition();
+	if (isrOwner_)
+		isrOwner_->stopAcquisition();
+
+	ring_ = buffer;
+	ringMask_ = buffer ? static_cast<uint16_t>(depth - 1) : 0;
+	head_ = 0;
+	tail_ = 0;
+	overruns_ = 0;
+	reportedOverruns_ = 0;
+	pendingEdges_ = 0;
+	ringHighWater_ = 0;
+	rawIndex_ = 0;
+	resetSampleClock();
+	acquiring_ = true;
+	isrOwner_ = this;
+	// The handler reads over SPI: keep it out of other transactions on
+	// the same bus (loop() register access, other devices).
+#if defined(SPI_HAS_NOTUSINGINTERRUPT)
+	spi_->usingInterrupt(irq);
+#endif
+	attachInterrupt(irq, drdyISR, FALLING);
+	return true;
+}
+
+void ADS1293::stopAcquisition()
+{
+	if (!acquiring_)
+		return;
+	detachInterrupt(digitalPinToInterrupt(drdyPin_));
+#if defined(SPI_HAS_NOTUSINGINTERRUPT)
+	spi_->notUsingInterrupt(digitalPinToInterrupt(drdyPin_));
+#endif
+	if (isrOwner_ == this)
+		isrOwner_ = nullptr;
+	acquiring_ = false;
+	ring_ = nullptr;
+}
+
+bool ADS1293::setDeferredReads(bool enable, DataReadyNotify notify, void *context)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+	if (!enable)
+		return false;
+#endif
+	// Switch with the interrupt detached; edges counted in one mode are
+	// not read in the other.
+	const bool suspended = suspendDrdyInterrupt();
+	deferReads_ = enable;
+	notify_ = enable ? notify : nullptr;
+	notifyCtx_ = enable ? context : nullptr;
+	pendingEdges_ = 0;
+	resumeDrdyInterrupt(suspended);
+	return true;
+}
+
+size_t ADS1293::serviceDataReady()
+{
+	if (!acquiring_ || !deferReads_)
+		return 0;
+	const uint16_t edges = loadShared(pendingEdges_);
+	if (!edges)
+		return 0;
+	addShared(pendingEdges_, static_cast<uint16_t>(-edges));
+	if (edges > 1)
+	{
+		storeShared(overruns_, static_cast<uint32_t>(overruns_ + (edges - 1)));
+		ADS1293_METRIC(addShared(metrics_.framesMissed, static_cast<uint32_t>(edges - 1u));)
+	}
+	acquireFrame(edges);
+	return 1;
+}
+
+void ADS1293::onFrameReady(FrameReadyCallback cb, void *context)
+{
+	// Swap with the interrupt detached so the handler never sees a
+	// callback paired with the wrong context.
+	const bool suspended = suspendDrdyInterrupt();
+	frameCb_ = cb;
+	frameCtx_ = context;
+	resumeDrdyInterrupt(suspended);
+}
+
+void ADS1293::onStatusChange(StatusCallback cb, void *context)
+{
+	const bool suspended = suspendDrdyInterrupt();
+	statusCb_ = cb;
+	statusCtx_ = context;
+	resumeDrdyInterrupt(suspended);
+}
+
+bool ADS1293::suspendDrdyInterrupt() noexcept
+{
+	if (!acquiring_)
+		return false;
+	detachInterrupt(digitalPinToInterrupt(drdyPin_));
+	return true;
+}
+
+void ADS1293::resumeDrdyInterrupt(bool suspended) noexcept
+{
+	if (suspended)
+		attachInterrupt(digitalPinToInterrupt(drdyPin_), drdyISR, FALLING);
+}
+
+size_t ADS1293::available() const noexcept
+{
+	if (!ring_)
+		return 0;
+	return static_cast<uint16_t>(loadShared(head_) - tail_);
+}
+
+uint32_t ADS1293::overrunCount() const noexcept
+{
+	return loadShared(overruns_);
+}
+
+size_t ADS1293::readFrames(Samples *out, size_t maxFrames, bool *missed)
+{
+	if (missed)
+		*missed = false;
+
+	// Deferred mode without a notified reader: read the pending frame here.
+	if (!notify_)
+		serviceDataReady();
+
+	if (!out || maxFrames == 0)
+		return 0;
+
+	if (!acquiring_)
+	{
+		// polled mode: the chip holds only the latest frame
+		if (digitalRead(drdyPin_) != LOW)
+			return 0;
+		const uint32_t edgeUs = micros();
+		uint8_t block[DATA_BLOCK_BYTES];
+		if (!readFrame(block))
+		{
+			ADS1293_METRIC(addShared(metrics_.readErrors, static_cast<uint32_t>(1));)
+			return 0;
+		}
+		ADS1293_METRIC(const uint32_t readEndUs = micros(); recordFrameRead(edgeUs, readEndUs);)
+		updateStatus(block);
+		decodeBlock(block, out[0]);
+		advanceClock(edgeUs, 0);
+		stampFrame(out[0]);
+		ADS1293_METRIC(recordDecode(readEndUs);)
+		if (filter_)
+			filter_->process(out[0]);
+		return 1;
+	}
+	if (!ring_)
+		return 0;
+
+	const uint16_t tail = tail_;
+	const uint16_t head = loadShared(head_);
+	size_t n = static_cast<uint16_t>(head - tail);
+	if (n > maxFrames)
+		n = maxFrames;
+	for (size_t i = 0; i < n; ++i)
+		out[i] = ring_[static_cast<uint16_t>(tail + i) & ringMask_];
+	storeShared(tail_, static_cast<uint16_t>(tail + n));
+	if (filter_)
+		filter_->processBlock(out, n);
+
+	const uint32_t overruns = loadShared(overruns_);
+	if (missed)
+		*missed = overruns != reportedOverruns_;
+	reportedOverruns_ = overruns;
+	return n;
+}
+
+size_t ADS1293::captureFrames(Samples *out, size_t frames, uint32_t timeoutMs)
+{
+	if (!spi_ || !out || frames == 0 || acquiring_)
+		return 0;
+
+	// CH_CNFG selects which sources the DATA_LOOP read cycles through, in
+	// address order: DATA_STATUS (1 byte), CHn_PACE (2 bytes each), CHn_ECG
+	// (3 bytes each).
+	uint8_t cnfg = 0;
+	if (!readRegister(Register::CH_CNFG, cnfg))
+		return 0;
+	uint8_t skip = (cnfg & 0x01u) ? 1 : 0;
+	for (uint8_t p = 0; p < 3; ++p)
+		if (cnfg & (0x02u << p))
+			skip = static_cast<uint8_t>(skip + 2);
+	uint8_t ecgLen = 0;
+	for (uint8_t e = 0; e < 3; ++e)
+		if (cnfg & (0x10u << e))
+			ecgLen = static_cast<uint8_t>(ecgLen + 3);
+	const uint8_t frameLen = static_cast<uint8_t>(skip + ecgLen);
+	if (ecgLen == 0)
+		return 0;
+
+	uint8_t buf[16];
+	size_t n = 0;
+	const uint32_t start = millis();
+
+	spi_->beginTransaction(spiSettings_);
+	digitalWrite(csPin_, LOW);
+	spi_->transfer(static_cast<uint8_t>(Register::DATA_LOOP) | RREG_FLAG);
+	while (n < frames)
+	{
+		while (digitalRead(drdyPin_) != LOW)
+		{
+			if (millis() - start >= timeoutMs)
+				break;
+		}
+		if (digitalRead(drdyPin_) != LOW)
+			break;
+		const uint32_t edgeUs = micros();
+		for (uint8_t i = 0; i < frameLen; ++i)
+			buf[i] = spi_->transfer(0x00);
+
+		Samples &s = out[n++];
+		advanceClock(edgeUs, 0);
+		stampFrame(s);
+		uint16_t *pace[3] = {&s.pace1, &s.pace2, &s.pace3};
+		int32_t *ch[3] = {&s.ch1, &s.ch2, &s.ch3};
+		const uint8_t *p = buf + ((cnfg & 0x01u) ? 1 : 0);
+		// The error registers cannot be read inside the loop burst.
+		s.status = (cnfg & 0x01u) ? buf[0] : 0;
+		s.leadOff = 0;
+		s.errors = 0;
+		for (uint8_t e = 0; e < 3; ++e)
+		{
+			if (cnfg & (0x02u << e))
+			{
+				*pace[e] = static_cast<uint16_t>((p[0] << 8) | p[1]);
+				p += 2;
+			}
+			else
+			{
+				*pace[e] = 0;
+			}
+		}
+		for (uint8_t e = 0; e < 3; ++e)
+		{
+			if (cnfg & (0x10u << e))
+			{
+				*ch[e] = signExtend24((static_cast<uint32_t>(p[0]) << 16) |
+									  (static_cast<uint32_t>(p[1]) << 8) |
+									  static_cast<uint32_t>(p[2]));
+				p += 3;
+			}
+			else
+			{
+				*ch[e] = 0;
+			}
+		}
+		s.ok = true;
+	}
+	digitalWrite(csPin_, HIGH);
+	spi_->endTransaction();
+	// The capture holds the bus while it waits on DRDY, so only its bytes
+	// are counted, not its time.
+	ADS1293_METRIC(recordBus(1u + static_cast<size_t>(frameLen) * n); addShared(metrics_.framesRead, static_cast<uint32_t>(n));)
+	if (filter_)
+		filter_->processBlock(out, n);
+	return n;
+}
+
+ADS1293_ISR_ATTR void ADS1293::acquireFrame(uint16_t periods)
+{
+	// Clock the frame into the slot the consumer is not looking at, then
+	// publish it. The previous slot stays untouched for one more frame period.
+	const uint32_t edgeUs = edgeUs_;
+	ADS1293_METRIC(const uint32_t readStartUs = micros(); recordLatency(readStartUs - edgeUs);)
+	advanceClock(edgeUs, periods);
+	uint8_t *block = rawSlot_[rawIndex_ ^ 1u];
+	if (!readFrame(block))
+	{
+		ADS1293_METRIC(addShared(metrics_.readErrors, static_cast<uint32_t>(1)); addShared(metrics_.framesMissed, static_cast<uint32_t>(1));)
+		return;
+	}
+	ADS1293_METRIC(const uint32_t readEndUs = micros(); recordFrameRead(readStartUs, readEndUs);)
+	rawIndex_ ^= 1u;
+	updateStatus(block);
+
+	if (ring_)
+	{
+		const uint16_t head = head_;
+		const uint16_t tail = loadShared(tail_);
+		if (static_cast<uint16_t>(head - tail) > ringMask_)
+		{
+			// ring full: drop the frame (DRDY was still released by the read)
+			storeShared(overruns_, static_cast<uint32_t>(overruns_ + 1));
+			ADS1293_METRIC(++metrics_.ringDrops;)
+		}
+		else
+		{
+			decodeBlock(block, ring_[head & ringMask_]);
+			stampFrame(ring_[head & ringMask_]);
+			ADS1293_METRIC(recordDecode(readEndUs);)
+			storeShared(head_, static_cast<uint16_t>(head + 1));
+			const uint16_t level = static_cast<uint16_t>(head + 1 - tail);
+			if (level > ringHighWater_)
+				ringHighWater_ = level;
+		}
+	}
+	if (frameCb_)
+		frameCb_(block + ECG_OFFSET, frameCtx_);
 }
 
-	// interpretRaw24 removed: library now always interprets ADC output as
-	// two's-complement 24-bit. Use signExtend24() for conversion.
+ADS1293_ISR_ATTR bool ADS1293::readFrame(uint8_t *block) noexcept
+{
+	// `block` is DATA_BLOCK_BYTES long. Without pace or in-burst status
+	// readout only the ECG tail is clocked.
+	if (wideFrames())
+		return readBurst(static_cast<uint8_t>(Register::DATA_STATUS), block, DATA_BLOCK_BYTES);
+	if (scheduled_)
+	{
+		// DATA_STATUS first, then only the channels its E1..E3_DRDY flags
+		// mark as updated: one burst per contiguous run, so a channel that is
+		// not due costs no bus bytes. The others keep their held sample.
+		if (!readBurst(static_cast<uint8_t>(Register::DATA_STATUS), block, 1))
+			return false;
+		const uint8_t due = static_cast<uint8_t>((block[0] >> 5) & 0x07u);
+		for (uint8_t ch = 0; ch < 3;)
+		{
+			if (!(due & (1u << ch)))
+			{
+				++ch;
+				continue;
+			}
+			uint8_t end = static_cast<uint8_t>(ch + 1);
+			while (end < 3 && (due & (1u << end)))
+				++end;
+			if (!readBurst(static_cast<uint8_t>(static_cast<uint8_t>(Register::DATA_CH1_ECG) + 3 * ch), held_ + 3 * ch,
+						   static_cast<size_t>(3 * (end - ch))))
+				return false;
+			ch = end;
+		}
+		memset(block + 1, 0, ECG_OFFSET - 1);
+		memcpy(block + ECG_OFFSET, held_, FRAME_BYTES);
+		return true;
+	}
+	return readBurst(static_cast<uint8_t>(Register::DATA_CH1_ECG), block + ECG_OFFSET, FRAME_BYTES);
+}
 
-	float ADS1293::rawToVoltage(int32_t signedCode, float vref, int32_t adcFullscale, float gain) noexcept
+ADS1293_ISR_ATTR void ADS1293::decodeBlock(const uint8_t *block, Samples &s) const noexcept
+{
+	decodeFrame(block + ECG_OFFSET, s.ch1, s.ch2, s.ch3);
+	if (paceReadout_)
 	{
-		if (adcFullscale == 0) adcFullscale = (1 << 23) - 1;
-		return (static_cast<float>(signedCode) / static_cast<float>(adcFullscale)) * vref * gain;
+		s.pace1 = static_cast<uint16_t>((block[1] << 8) | block[2]);
+		s.pace2 = static_cast<uint16_t>((block[3] << 8) | block[4]);
+		s.pace3 = static_cast<uint16_t>((block[5] << 8) | block[6]);
+	}
+	else
+	{
+		s.pace1 = s.pace2 = s.pace3 = 0;
+	}
+	s.status = (statusMode_ != StatusMode::Off || scheduled_) ? block[0] : 0;
+	s.leadOff = leadOff_;
+	s.errors = errors_;
+	s.ok = true;
+}
+
+ADS1293_ISR_ATTR void ADS1293::updateStatus(uint8_t *block) noexcept
+{
+	if (statusMode_ == StatusMode::Off)
+		return;
+	// In pin mode DATA_STATUS was not clocked unless pace readout or the
+	// rate scheduler read it; stand in the ALARMB bit from the pin.
+	if (!wideFrames())
+	{
+		const uint8_t flags = scheduled_ ? static_cast<uint8_t>(block[0] & ~0x02u) : 0x00u;
+		block[0] = static_cast<uint8_t>(flags | ((digitalRead(alarmPin_) == LOW) ? 0x02u : 0x00u));
 	}
 
-ADS1293::Samples ADS1293::getECGData()
+	// The error registers are only worth a transaction while ALARMB is
+	// asserted; it releases once every unmasked condition has cleared.
+	uint8_t err[2] = {0, 0};
+	if ((block[0] & 0x02u) && !readBurst(static_cast<uint8_t>(Register::ERROR_LOD), err, sizeof(err)))
+		return;
+	if (err[0] == leadOff_ && err[1] == errors_)
+		return;
+	leadOff_ = err[0];
+	errors_ = err[1];
+	if (statusCb_)
+		statusCb_(leadOff_, errors_, statusCtx_);
+}
+
+ADS1293_ISR_ATTR void ADS1293::handleDataReady()
 {
-	Samples s;
-	int32_t a = 0, b = 0, c = 0;
-	if (getECGData(a, b, c))
+	if (!acquiring_)
+		return;
+	edgeUs_ = micros();
+	ADS1293_METRIC(++metrics_.drdyEdges;)
+	if (deferReads_)
 	{
-		s.ch1 = a;
-		s.ch2 = b;
-		s.ch3 = c;
-		s.ok = true;
+		addShared(pendingEdges_, static_cast<uint16_t>(1));
+		if (notify_)
+			notify_(notifyCtx_);
 	}
-	return s;
+	else
+	{
+		acquireFrame();
+	}
+}
+
+ADS1293_ISR_ATTR void ADS1293::drdyISR()
+{
+	if (isrOwner_)
+		isrOwner_->handleDataReady();
 }
 
 uint8_t ADS1293::readDeviceID()
@@ -235,31 +1240,97 @@ uint8_t ADS1293::readErrorStatus()
 	return val;
 }
 
-bool ADS1293::begin3LeadECG()
+bool ADS1293::readErrorRegisters(uint8_t *regs)
 {
-	// perform the configuration steps in a clear, datasheet-aligned order
-	if (!configureChannel1(FlexCh1Mode::Default))
-		return false;
-	if (!configureChannel2(FlexCh2Mode::Default))
-		return false;
-	if (!enableCommonModeDetection(CMDetMode::Enabled))
-		return false;
-	if (!configureRLD(RLDMode::Default))
+	if (!regs)
 		return false;
-	if (!configureOscillator(OscMode::Default))
+	return readBurst(static_cast<uint8_t>(Register::ERROR_LOD), regs, ERROR_REGISTER_COUNT);
+}
+
+bool ADS1293::configureLeadOff(LeadOffMode mode, uint8_t inputMask, uint16_t currentNa, uint8_t acLevel)
+{
+	if (acLevel > 3)
 		return false;
-	if (!configureAFEShutdown(AFEShutdownMode::Default))
+	uint16_t steps = static_cast<uint16_t>(currentNa / 8u);
+	if (steps > 0xFFu)
+		steps = 0xFFu;
+	// Program the current and inputs before taking the comparators out of
+	// shutdown, so no flags are raised with a stale setup.
+	if (!writeRegister(Register::LOD_CURRENT, static_cast<uint8_t>(steps)))
 		return false;
-	if (!configureSamplingRates(R2Rate::Rate_2, R3Rate::Rate_2, R3Rate::Rate_2))
+	if (!writeRegister(Register::LOD_EN, static_cast<uint8_t>(inputMask & 0x3Fu)))
 		return false;
-	if (!configureDRDYSource(DRDYSource::Default))
+	return writeRegister(Register::LOD_CN, static_cast<uint8_t>(static_cast<uint8_t>(mode) | acLevel));
+}
+
+bool ADS1293::setLeadOffAcDivider(uint8_t divider, bool divideBy16)
+{
+	if (divider == 0 || divider > 0x7Fu)
 		return false;
-	if (!configureChannelConfig(ChannelConfig::Default3Lead))
+	return writeRegister(Register::LOD_AC_CN, static_cast<uint8_t>(divider | (divideBy16 ? 0x80u : 0x00u)));
+}
+
+bool ADS1293::setAlarmMask(uint8_t mask)
+{
+	return writeRegister(Register::MASK_ERR, mask);
+}
+
+bool ADS1293::setAlarmFilter(uint8_t leadOffCount, uint8_t otherCount)
+{
+	if (leadOffCount > 0x0Fu || otherCount > 0x0Fu)
 		return false;
-	if (!applyGlobalConfig(GlobalConfig::Start))
+	return writeRegister(Register::ALARM_FILTER, static_cast<uint8_t>((otherCount << 4) | leadOffCount));
+}
+
+bool ADS1293::setStatusMode(StatusMode mode, uint8_t alarmPin)
+{
+	if (mode == StatusMode::AlarmPin)
+	{
+		if (alarmPin == 255)
+			return false;
+		pinMode(alarmPin, INPUT_PULLUP); // ALARMB is open drain
+	}
+
+	const bool suspended = suspendDrdyInterrupt();
+	const StatusMode previous = statusMode_;
+	statusMode_ = mode;
+	const bool ok = updateLoopConfig();
+	if (!ok)
+		statusMode_ = previous;
+	else
+	{
+		alarmPin_ = alarmPin;
+		leadOff_ = 0;
+		errors_ = 0;
+	}
+	resumeDrdyInterrupt(suspended);
+	return ok;
+}
+
+bool ADS1293::updateLoopConfig()
+{
+	// Keep DATA_LOOP (captureFrames) in step with the burst layout: status
+	// when it leads the burst, and the pace data of every enabled ECG channel.
+	uint8_t cnfg = 0;
+	if (!readRegister(Register::CH_CNFG, cnfg))
 		return false;
+	const uint8_t ecg = static_cast<uint8_t>(cnfg & 0x70u);
+	uint8_t value = ecg;
+	if (paceReadout_)
+		value = static_cast<uint8_t>(value | (ecg >> 3));
+	if (wideFrames())
+		value = static_cast<uint8_t>(value | 0x01u);
+	return writeRegister(Register::CH_CNFG, value);
+}
 
-	return true;
+bool ADS1293::begin3LeadECG()
+{
+	// Same register values the individual helpers write, from a ROM image
+	// checked at compile time.
+	static_assert(ADS1293Profiles::ThreeLead::value(Register::FLEX_CH1_CN) == static_cast<uint8_t>(FlexCh1Mode::Default) &&
+					  ADS1293Profiles::ThreeLead::value(Register::CH_CNFG) == static_cast<uint8_t>(ChannelConfig::Default3Lead),
+				  "3-lead profile out of step with the helper defaults");
+	return applyProfile<ADS1293Profiles::ThreeLead>();
 }
 
 // --- helper implementations follow ---
@@ -309,14 +1380,15 @@ bool ADS1293::configureRef(RefMode m)
 	return writeRegister(Register::REF_CN, static_cast<uint8_t>(m));
 }
 
-bool ADS1293::configureSamplingRates(R2Rate r2, R3Rate r3ch1, R3Rate r3ch2)
+bool ADS1293::configureSamplingRates(R2Rate r2, R3Rate r3ch1, R3Rate r3ch2, R3Rate r3ch3)
 {
 	// R2_RATE and R3_RATE_CHx: sampling rate related registers
 	bool ok = true;
 	ok &= writeRegister(Register::R2_RATE, static_cast<uint8_t>(r2));
 	ok &= writeRegister(Register::R3_RATE_CH1, static_cast<uint8_t>(r3ch1));
 	ok &= writeRegister(Register::R3_RATE_CH2, static_cast<uint8_t>(r3ch2));
-	return ok;
+	ok &= writeRegister(Register::R3_RATE_CH3, static_cast<uint8_t>(r3ch3));
+	return ok && updateRateSchedule(false);
 }
 
 	// namespace removed from this TU: implementation uses global symbols
@@ -324,7 +1396,7 @@ bool ADS1293::configureSamplingRates(R2Rate r2, R3Rate r3ch1, R3Rate r3ch2)
 bool ADS1293::configureDRDYSource(DRDYSource m)
 {
 	// DRDYB_SRC: data ready source selection
-	return writeRegister(Register::DRDYB_SRC, static_cast<uint8_t>(m));
+	return writeRegister(Register::DRDYB_SRC, static_cast<uint8_t>(m)) && resetSampleClock();
 }
 
 bool ADS1293::configureChannelConfig(ChannelConfig m)
@@ -336,7 +1408,7 @@ bool ADS1293::configureChannelConfig(ChannelConfig m)
 bool ADS1293::applyGlobalConfig(GlobalConfig m)
 {
 	// CONFIG: final device configuration to start conversions
-	return writeRegister(Register::CONFIG, static_cast<uint8_t>(m));
+	return writeRegister(Register::CONFIG, static_cast<uint8_t>(m)) && resetSampleClock();
 }
 
 // begin5LeadECG removed in favor of explicit helper calls in examples.
@@ -346,14 +1418,12 @@ void ADS1293::disableChannel(uint8_t channel)
 	if (channel == 1)
 	{
 		writeRegister(Register::FLEX_CH1_CN, 0x00);
-		delay(1);
-	}
+		}
 }
 
 void ADS1293::disableFilterAll()
 {
 	writeRegister(Register::DIS_EFILTER, 0x07);
-	delay(1);
 }
 
 bool ADS1293::disableFilter(uint8_t channel)
@@ -364,7 +1434,6 @@ bool ADS1293::disableFilter(uint8_t channel)
 	}
 	uint8_t mask = static_cast<uint8_t>(1u << (channel - 1));
 	writeRegister(Register::DIS_EFILTER, mask);
-	delay(1);
 	return true;
 }
 
@@ -378,7 +1447,6 @@ bool ADS1293::attachTestSignal(uint8_t channel, TestSignal sig)
 	// write to channel register addresses (FLEX_CHn_CN)
 	Register reg = static_cast<Register>(0x00 + channel);
 	writeRegister(reg, value);
-	delay(1);
 	return true;
 }
 
@@ -398,7 +1466,6 @@ bool ADS1293::setChannelGainRaw(uint8_t channel, uint8_t regValue)
 	// CH1SET @ 0x0A, CH2SET @ 0x0B, CH3SET @ 0x0C
 	Register reg = static_cast<Register>(0x0A + (channel - 1));
 	bool ok = writeRegister(reg, regValue);
-	delay(1);
 	return ok;
 }
 
@@ -407,6 +1474,574 @@ bool ADS1293::setChannelGain(uint8_t channel, ADS1293::PgaGain gain)
 	return setChannelGainRaw(channel, static_cast<uint8_t>(gain));
 }
 
+// Decimation factors encoded in the rate registers (one-hot codes). The
+// device falls back to the register default for invalid codes.
+static uint8_t decodeR2(uint8_t code) noexcept
+{
+	switch (code & 0x0Fu)
+	{
+	case 0x01: return 4;
+	case 0x02: return 5;
+	case 0x04: return 6;
+	default: return 8;
+	}
+}
+
+static uint8_t decodeR3(uint8_t code) noexcept
+{
+	switch (code)
+	{
+	case 0x01: return 4;
+	case 0x02: return 6;
+	case 0x04: return 8;
+	case 0x08: return 12;
+	case 0x10: return 16;
+	case 0x20: return 32;
+	case 0x40: return 64;
+	default: return 128;
+	}
+}
+
+float ADS1293::getPaceDataRate(uint8_t channel)
+{
+	if (channel < 1 || channel > 3)
+		return 0.0f;
+	uint8_t afeRes = 0, r1 = 0, r2 = 0;
+	if (!readRegister(Register::AFE_RES, afeRes) || !readRegister(Register::R1_RATE, r1) ||
+		!readRegister(Register::R2_RATE, r2))
+		return 0.0f;
+	const uint8_t bit = static_cast<uint8_t>(1u << (channel - 1));
+	// FS_HIGH_CHn (AFE_RES bits 3..5) doubles the modulator clock
+	const float fs = (afeRes & (bit << 3)) ? 204800.0f : 102400.0f;
+	// R1_RATE_CHn set selects R1 = 2 (double pace rate), otherwise 4
+	const uint8_t r1Factor = (r1 & bit) ? 2 : 4;
+	return fs / (static_cast<float>(r1Factor) * decodeR2(r2));
+}
+
+// One-hot R3 code for a decimation factor, 0 if there is none.
+static uint8_t encodeR3(uint16_t factor) noexcept
+{
+	for (uint8_t code = 0x01; code; code = static_cast<uint8_t>(code << 1))
+		if (decodeR3(code) == factor)
+			return code;
+	return 0;
+}
+
+bool ADS1293::setChannelSamplingRate(uint8_t channel, SamplingRate s)
+{
+	if (channel < 1 || channel > 3)
+		return false;
+	const float targetHz = samplingRateHz(s);
+	uint8_t afeRes = 0, r1 = 0, r2 = 0, shdn = 0, config = 0;
+	uint8_t flex[3], r3[3];
+	if (targetHz == 0.0f || !readRegister(Register::AFE_RES, afeRes) || !readRegister(Register::R1_RATE, r1) ||
+		!readRegister(Register::R2_RATE, r2) || !readRegisters(Register::R3_RATE_CH1, r3, sizeof(r3)) ||
+		!readRegisters(Register::FLEX_CH1_CN, flex, sizeof(flex)) || !readRegister(Register::AFE_SHDN_CN, shdn))
+		return false;
+
+	const uint8_t c = static_cast<uint8_t>(channel - 1);
+	const uint8_t bit = static_cast<uint8_t>(1u << c);
+	const float fs = (afeRes & (bit << 3)) ? 204800.0f : 102400.0f;
+	const uint8_t oldR2 = decodeR2(r2);
+
+	// R2 is shared by all channels. Keep it if this channel can reach the
+	// preset exactly with its own R1 and R3.
+	bool exact = false;
+	for (uint8_t f1 = 4; f1 >= 2 && !exact; f1 = static_cast<uint8_t>(f1 - 2))
+	{
+		for (uint8_t code = 0x01; code && !exact; code = static_cast<uint8_t>(code << 1))
+		{
+			if (fabsf(fs / (static_cast<float>(f1) * oldR2 * decodeR3(code)) - targetHz) < 0.01f)
+			{
+				exact = true;
+				r1 = static_cast<uint8_t>(f1 == 2 ? (r1 | bit) : (r1 & ~bit));
+				r3[c] = code;
+			}
+		}
+	}
+
+	// Otherwise R1 = 4 and R2 = 4, as setSamplingRate(), with the nearest
+	// R3. Every other running channel must keep its R1 * R2 * R3 at R2 = 4,
+	// or the call would retime it.
+	if (!exact)
+	{
+		float bestErr = 1e9f;
+		for (uint8_t code = 0x01; code; code = static_cast<uint8_t>(code << 1))
+		{
+			const float err = fabsf(fs / (16.0f * decodeR3(code)) - targetHz);
+			if (err < bestErr)
+			{
+				bestErr = err;
+				r3[c] = code;
+			}
+		}
+		r1 = static_cast<uint8_t>(r1 & ~bit);
+		for (uint8_t o = 0; o < 3 && oldR2 != 4; ++o)
+		{
+			if (o == c || !flex[o] || (shdn & (0x09u << o)))
+				continue;
+			const uint8_t ob = static_cast<uint8_t>(1u << o);
+			const uint16_t decimation = static_cast<uint16_t>(((r1 & ob) ? 2 : 4) * oldR2 * decodeR3(r3[o]));
+			const uint8_t as4 = encodeR3(static_cast<uint16_t>(decimation / 16));
+			const uint8_t as2 = encodeR3(static_cast<uint16_t>(decimation / 8));
+			if (decimation % 16 == 0 && as4)
+			{
+				r1 = static_cast<uint8_t>(r1 & ~ob);
+				r3[o] = as4;
+			}
+			else if (decimation % 8 == 0 && as2)
+			{
+				r1 = static_cast<uint8_t>(r1 | ob);
+				r3[o] = as2;
+			}
+			else
+			{
+				return false;
+			}
+		}
+		r2 = 0x01;
+	}
+
+	bool ok = pauseConversions(config);
+	ok &= stageRegister(Register::R1_RATE, r1);
+	ok &= stageRegister(Register::R2_RATE, r2);
+	for (uint8_t i = 0; i < 3; ++i)
+		ok &= stageRegister(static_cast<Register>(static_cast<uint8_t>(Register::R3_RATE_CH1) + i), r3[i]);
+	ok &= sync();
+	ok &= updateRateSchedule(true);
+	ok &= resumeConversions(config);
+	return ok;
+}
+
+bool ADS1293::pauseConversions(uint8_t &config) noexcept
+{
+	if (!readRegister(Register::CONFIG, config))
+		return false;
+	if (!(config & static_cast<uint8_t>(GlobalConfig::Start)))
+		return true;
+	return writeRegister(Register::CONFIG, static_cast<uint8_t>(config & ~static_cast<uint8_t>(GlobalConfig::Start)));
+}
+
+bool ADS1293::resumeConversions(uint8_t config) noexcept
+{
+	if (!(config & static_cast<uint8_t>(GlobalConfig::Start)))
+		return true;
+	return writeRegister(Register::CONFIG, config);
+}
+
+bool ADS1293::updateRateSchedule(bool selectDataReady)
+{
+	// A channel takes part when it is routed and its AFE is powered.
+	uint8_t flex[3], shdn = 0;
+	if (!readRegisters(Register::FLEX_CH1_CN, flex, sizeof(flex)) || !readRegister(Register::AFE_SHDN_CN, shdn))
+		return false;
+	float fastestHz = 0.0f, slowestHz = 0.0f;
+	uint8_t fastest = 0;
+	for (uint8_t ch = 0; ch < 3; ++ch)
+	{
+		if (!flex[ch] || (shdn & (0x09u << ch)))
+			continue;
+		const float hz = getOutputDataRate(static_cast<uint8_t>(ch + 1));
+		if (hz > fastestHz)
+		{
+			fastestHz = hz;
+			fastest = ch;
+		}
+		if (slowestHz == 0.0f || hz < slowestHz)
+			slowestHz = hz;
+	}
+
+	bool ok = true;
+	if (selectDataReady && fastestHz > 0.0f)
+	{
+		uint8_t src = 0;
+		ok = readRegister(Register::DRDYB_SRC, src);
+		if (ok && !(src & 0x07u)) // leave a pace source alone
+			ok = writeRegister(Register::DRDYB_SRC, static_cast<uint8_t>(static_cast<uint8_t>(DRDYSource::Ch1Ecg) << fastest));
+	}
+
+	const bool scheduled = fastestHz != slowestHz;
+	if (scheduled != scheduled_)
+	{
+		const bool suspended = suspendDrdyInterrupt();
+		scheduled_ = scheduled;
+		memset(held_, 0, sizeof(held_));
+		resumeDrdyInterrupt(suspended);
+	}
+	const bool clock = resetSampleClock();
+	return updateMicrovoltScale() && clock && ok;
+}
+
+bool ADS1293::resetSampleClock()
+{
+	// Nominal period of the DRDY source; 0 (unknown) lets the tracker take
+	// the first frame interval instead.
+	uint8_t src = 0;
+	const bool ok = readRegister(Register::DRDYB_SRC, src);
+	float hz = 0.0f;
+	for (uint8_t ch = 0; ok && ch < 3 && hz == 0.0f; ++ch)
+	{
+		if (src & (0x01u << ch))
+			hz = getPaceDataRate(static_cast<uint8_t>(ch + 1));
+		else if (src & (0x08u << ch))
+			hz = getOutputDataRate(static_cast<uint8_t>(ch + 1));
+	}
+	const uint32_t nominal = hz > 0.0f ? static_cast<uint32_t>(65536.0e6f / hz + 0.5f) : 0;
+
+	const bool suspended = suspendDrdyInterrupt();
+	clockNominalQ16_ = nominal;
+	clockPeriodQ16_ = nominal;
+	clockStarted_ = false;
+	clockIndex_ = 0;
+	resumeDrdyInterrupt(suspended);
+	return ok;
+}
+
+ADS1293_ISR_ATTR void ADS1293::advanceClock(uint32_t edgeUs, uint16_t periods) noexcept
+{
+	if (!clockStarted_)
+	{
+		clockStarted_ = true;
+		clockUs_ = edgeUs;
+		clockFrac_ = 0;
+		anchorUs_ = edgeUs;
+		anchorIndex_ = clockIndex_;
+		return;
+	}
+	uint32_t period = clockPeriodQ16_;
+	const uint32_t elapsed = edgeUs - clockUs_;
+	if (period == 0 && elapsed > 0 && elapsed < 0x10000ul)
+		period = elapsed << 16;
+	// Whole periods since the previous frame, at least the edges counted:
+	// also catches edges lost while interrupts were blocked. The division
+	// only runs after a gap.
+	const uint32_t periodUs = (period >> 16) ? (period >> 16) : 1;
+	const uint32_t k = elapsed < periodUs + periodUs / 2 ? 1 : (elapsed + periodUs / 2) / periodUs;
+	if (k > periods)
+		periods = static_cast<uint16_t>(k > 0xFFFFu ? 0xFFFFu : k);
+	if (periods == 0)
+		periods = 1;
+	clockIndex_ += periods;
+
+	// Predicted edge: `periods` periods after the previous one. Long gaps
+	// (stalled reads, a restart) resynchronize the phase, keeping the period.
+	uint32_t us = clockUs_;
+	uint32_t frac = clockFrac_;
+	int32_t d = 0x7FFF;
+	if (periods <= 16)
+	{
+		for (uint16_t i = 0; i < periods; ++i)
+		{
+			frac += period;
+			us += frac >> 16;
+			frac &= 0xFFFFu;
+		}
+		d = static_cast<int32_t>(edgeUs - us);
+	}
+	if (d > 16383 || d < -16383)
+	{
+		clockUs_ = edgeUs;
+		clockFrac_ = 0;
+		clockPeriodQ16_ = period;
+		return;
+	}
+	const int32_t err = d * 65536 - static_cast<int32_t>(frac); // Q16
+	const int32_t phase = static_cast<int32_t>(frac) + err / 32;
+	clockUs_ = us + static_cast<uint32_t>(phase >> 16);
+	clockFrac_ = static_cast<uint16_t>(phase & 0xFFFF);
+	period += static_cast<uint32_t>(err / periods / 2048);
+	// keep the period within 1/8 of the programmed rate
+	if (clockNominalQ16_)
+	{
+		const uint32_t span = clockNominalQ16_ / 8;
+		if (period > clockNominalQ16_ + span)
+			period = clockNominalQ16_ + span;
+		else if (period < clockNominalQ16_ - span)
+			period = clockNominalQ16_ - span;
+	}
+	clockPeriodQ16_ = period;
+	// move the baseline up before the span overflows (after ~35 minutes)
+	if (clockUs_ - anchorUs_ > 0x80000000ul)
+	{
+		anchorUs_ = clockUs_;
+		anchorIndex_ = clockIndex_;
+	}
+}
+
+float ADS1293::sampleClockHz() const noexcept
+{
+	uint32_t spanUs = 0, frames = 0, period = 0;
+#if defined(__AVR__)
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#endif
+	{
+		spanUs = clockUs_ - anchorUs_;
+		frames = clockIndex_ - anchorIndex_;
+		period = clockPeriodQ16_;
+	}
+	// Long-baseline rate once enough frames were seen (the timestamp error
+	// averages out over the span); the tracked period before that.
+	if (frames >= 256 && spanUs)
+		return static_cast<float>(frames) * 1.0e6f / static_cast<float>(spanUs);
+	return period ? 65536.0e6f / static_cast<float>(period) : 0.0f;
+}
+
+float ADS1293::sampleClockPpm() const noexcept
+{
+	const float hz = sampleClockHz();
+	if (hz == 0.0f || !clockNominalQ16_)
+		return 0.0f;
+	return (hz * static_cast<float>(clockNominalQ16_) / 65536.0e6f - 1.0f) * 1.0e6f;
+}
+
+float ADS1293::getOutputDataRate(uint8_t channel)
+{
+	const float pace = getPaceDataRate(channel);
+	if (pace == 0.0f)
+		return 0.0f;
+	uint8_t r3 = 0;
+	if (!readRegister(static_cast<Register>(static_cast<uint8_t>(Register::R3_RATE_CH1) + channel - 1), r3))
+		return 0.0f;
+	return pace / decodeR3(r3);
+}
+
+uint32_t ADS1293::ecgAdcMax(uint8_t channel)
+{
+	if (channel < 1 || channel > 3)
+		return 0;
+	uint8_t r2 = 0, r3 = 0;
+	if (!readRegister(Register::R2_RATE, r2) ||
+		!readRegister(static_cast<Register>(static_cast<uint8_t>(Register::R3_RATE_CH1) + channel - 1), r3))
+		return 0;
+	// R3 = 6 and 12 use the alternate column of the tables
+	const uint8_t r3Factor = decodeR3(r3);
+	const bool alt = r3Factor == 6 || r3Factor == 12;
+	switch (decodeR2(r2))
+	{
+	case 5: return alt ? 0xB964F0u : 0xC35000u;
+	case 6: return alt ? 0xE6A900u : 0xF30000u;
+	default: return alt ? 0xF30000u : 0x800000u; // R2 = 4 or 8
+	}
+}
+
+uint16_t ADS1293::paceAdcMax()
+{
+	uint8_t r2 = 0;
+	if (!readRegister(Register::R2_RATE, r2))
+		return 0;
+	switch (decodeR2(r2))
+	{
+	case 5: return 0xC350u;
+	case 6: return 0xF300u;
+	default: return 0x8000u; // R2 = 4 or 8
+	}
+}
+
+bool ADS1293::setReferenceVoltage(float volts)
+{
+	// 4 * VREF in microvolts must fit 24 bits for the scale computation
+	if (!(volts > 0.0f) || volts > 4.0f)
+		return false;
+	vrefUv_ = static_cast<uint32_t>(volts * 1.0e6f + 0.5f);
+	return updateMicrovoltScale();
+}
+
+bool ADS1293::updateMicrovoltScale()
+{
+	// Microvolts per code are N / D with N = 4 * VREF[uV] and D = 7 * ADC_MAX.
+	// The multiplier is N / D * 2^shift rounded up, with the largest shift
+	// that keeps it in 32 bits, by long division (no 64-bit divide). D is
+	// kept for the exact check in toMicrovolts().
+	bool ok = true;
+	for (uint8_t c = 0; c < 3; ++c)
+	{
+		const uint32_t adcMax = ecgAdcMax(static_cast<uint8_t>(c + 1));
+		uint32_t mult = 0;
+		uint8_t shift = 0;
+		if (adcMax)
+		{
+			const uint32_t n = 4u * vrefUv_;
+			const uint32_t d = 7u * adcMax;
+			uint32_t q = n / d, r = n % d;
+			while (!(q & 0x80000000ul))
+			{
+				r <<= 1;
+				q <<= 1;
+				if (r >= d)
+				{
+					r -= d;
+					q |= 1u;
+				}
+				++shift;
+			}
+			mult = (r && q != 0xFFFFFFFFul) ? q + 1u : q;
+		}
+		else
+		{
+			ok = false;
+			shift = 1; // converts to 0
+		}
+		uvZero_[c] = adcMax / 2;
+		uvDen_[c] = 7u * adcMax;
+		uvMult_[c] = mult;
+		uvShift_[c] = shift;
+	}
+	return ok;
+}
+
+inline int32_t ADS1293::scaleMicrovolts(uint8_t c, int32_t sample) const noexcept
+{
+	const uint32_t code = static_cast<uint32_t>(sample) & 0xFFFFFFu;
+	const bool negative = code < uvZero_[c];
+	const uint32_t a = negative ? uvZero_[c] - code : code - uvZero_[c];
+	const uint8_t shift = uvShift_[c];
+	const uint64_t p = static_cast<uint64_t>(a) * uvMult_[c] + (1ull << (shift - 1));
+	uint32_t uv = static_cast<uint32_t>(p >> shift);
+	// The rounded-up multiplier overshoots the exact product by less than a,
+	// so the result can only be one too high, and only when the fraction
+	// bits are below a (just past a rounding tie). Then check exactly:
+	// a * N / D < uv - 1/2  <=>  2 * a * N < (2 * uv - 1) * D.
+	if (uv && (p & ((1ull << shift) - 1u)) < a &&
+		2ull * a * (4u * vrefUv_) < (2ull * uv - 1u) * uvDen_[c])
+		--uv;
+	return negative ? -static_cast<int32_t>(uv) : static_cast<int32_t>(uv);
+}
+
+int32_t ADS1293::toMicrovolts(uint8_t channel, int32_t sample) const noexcept
+{
+	if (channel < 1 || channel > 3)
+		return 0;
+	return scaleMicrovolts(static_cast<uint8_t>(channel - 1), sample);
+}
+
+void ADS1293::toMicrovolts(uint8_t channel, const int32_t *in, int32_t *out, size_t n) const noexcept
+{
+	if (channel < 1 || channel > 3)
+	{
+		memset(out, 0, n * sizeof(*out));
+		return;
+	}
+	const uint8_t c = static_cast<uint8_t>(channel - 1);
+	for (size_t i = 0; i < n; ++i)
+		out[i] = scaleMicrovolts(c, in[i]);
+}
+
+void ADS1293::toMicrovolts(Samples *frames, size_t n) const noexcept
+{
+	for (size_t i = 0; i < n; ++i)
+	{
+		frames[i].ch1 = scaleMicrovolts(0, frames[i].ch1);
+		frames[i].ch2 = scaleMicrovolts(1, frames[i].ch2);
+		frames[i].ch3 = scaleMicrovolts(2, frames[i].ch3);
+	}
+}
+
+bool ADS1293::enablePaceReadout(bool enable)
+{
+	// Switch layouts with the interrupt detached so no frame is read with
+	// one layout and decoded with the other.
+	const bool suspended = suspendDrdyInterrupt();
+	const bool previous = paceReadout_;
+	paceReadout_ = enable;
+	const bool ok = updateLoopConfig();
+	if (!ok)
+		paceReadout_ = previous;
+	resumeDrdyInterrupt(suspended);
+	return ok;
+}
+
+bool ADS1293::readPace(uint16_t &pace1, uint16_t &pace2, uint16_t &pace3)
+{
+	uint8_t buf[6];
+	if (!readBurst(static_cast<uint8_t>(Register::DATA_CH1_PACE), buf, sizeof(buf)))
+		return false;
+	pace1 = static_cast<uint16_t>((buf[0] << 8) | buf[1]);
+	pace2 = static_cast<uint16_t>((buf[2] << 8) | buf[3]);
+	pace3 = static_cast<uint16_t>((buf[4] << 8) | buf[5]);
+	return true;
+}
+
+bool ADS1293::setDoublePaceRate(uint8_t channel, bool enable)
+{
+	if (channel < 1 || channel > 3)
+		return false;
+	uint8_t r1 = 0;
+	if (!readRegister(Register::R1_RATE, r1))
+		return false;
+	const uint8_t bit = static_cast<uint8_t>(1u << (channel - 1));
+	r1 = enable ? static_cast<uint8_t>(r1 | bit) : static_cast<uint8_t>(r1 & ~bit);
+	return writeRegister(Register::R1_RATE, r1) && resetSampleClock();
+}
+
+bool ADS1293::configurePaceChannel(uint8_t posInput, uint8_t negInput)
+{
+	if (posInput > 6 || negInput > 6)
+		return false;
+	// FLEX_PACE_CN: POS4 bits 3..5, NEG4 bits 0..2, test signal off
+	return writeRegister(Register::FLEX_PACE_CN, static_cast<uint8_t>((posInput << 3) | negInput));
+}
+
+bool ADS1293::configureAnalogPace(bool enable, bool toRldin, bool toWct)
+{
+	// AFE_PACE_CN: PACE2RLDIN bit 2, PACE2WCT bit 1, SHDN_PACE bit 0
+	uint8_t value = enable ? 0x00u : 0x01u;
+	if (toRldin)
+		value |= 0x04u;
+	if (toWct)
+		value |= 0x02u;
+	return writeRegister(Register::AFE_PACE_CN, value);
+}
+
+bool ADS1293::enableBatteryMonitor(uint8_t channel, bool enable)
+{
+	if (channel < 1 || channel > 3)
+		return false;
+	uint8_t vbat = 0, shdn = 0;
+	if (!readRegister(Register::FLEX_VBAT_CN, vbat) || !readRegister(Register::AFE_SHDN_CN, shdn))
+		return false;
+	// VBAT_MONI_CHn and SHDN_INA_CHn share bit n-1 of their registers; the
+	// channel's SDM (SHDN_SDM_CHn, bit n+2) must run to convert the supply,
+	// also on a channel a lead profile left powered down.
+	const uint8_t bit = static_cast<uint8_t>(1u << (channel - 1));
+	if (enable)
+	{
+		vbat |= bit;
+		shdn = static_cast<uint8_t>((shdn | bit) & ~(bit << 3));
+	}
+	else
+	{
+		vbat = static_cast<uint8_t>(vbat & ~bit);
+		shdn = static_cast<uint8_t>(shdn & ~bit);
+	}
+	return writeRegister(Register::AFE_SHDN_CN, shdn) && writeRegister(Register::FLEX_VBAT_CN, vbat);
+}
+
+bool ADS1293::readBatteryVoltage(uint8_t channel, float &volts, float vref)
+{
+	uint32_t code = 0;
+	const uint32_t adcMax = ecgAdcMax(channel);
+	if (adcMax == 0 || !getRaw24(channel, code))
+		return false;
+	volts = vref * (1.0f + static_cast<float>(code) / static_cast<float>(adcMax));
+	return true;
+}
+
+float ADS1293::samplingRateHz(SamplingRate s) noexcept
+{
+	switch (s)
+	{
+	case ADS1293::SamplingRate::SPS_1600: return 1600.0f;   // R3=4
+	case ADS1293::SamplingRate::SPS_1067: return 1066.6667f; // R3=6
+	case ADS1293::SamplingRate::SPS_800:  return 800.0f;    // R3=8
+	case ADS1293::SamplingRate::SPS_533:  return 533.3333f; // R3=12
+	case ADS1293::SamplingRate::SPS_400:  return 400.0f;    // R3=16
+	case ADS1293::SamplingRate::SPS_200:  return 200.0f;    // R3=32
+	case ADS1293::SamplingRate::SPS_100:  return 100.0f;    // R3=64
+	case ADS1293::SamplingRate::SPS_50:   return 50.0f;     // R3=128
+	default: return 0.0f;
+	}
+}
+
 bool ADS1293::setSamplingRate(ADS1293::SamplingRate s)
 {
 	// Implement ODR configuration by programming the decimation stages
@@ -417,33 +2052,23 @@ bool ADS1293::setSamplingRate(ADS1293::SamplingRate s)
 
 	// Determine SDM clock (fS). Default is 102.4 kHz, but if the AFE_RES
 	// register indicates high-rate mode (FS_HIGH) the SDM clock is doubled
-	// to 204.8 kHz. Read the AFE_RES register to detect this.
+	// to 204.8 kHz. Read the AFE_RES register to detect this (served from
+	// the register cache after the first call).
 	float fs = 102400.0f; // default SDM clock per-channel when FS_HIGH=0
 	uint8_t afeRes = 0;
 	if (readRegister(Register::AFE_RES, afeRes)) {
-		// Datasheet labels a bit (FS_HIGH) in AFE_RES that enables higher SDM
-		// clock. Use bit mask 0x01 here (common mapping). If your hardware
-		// uses a different bit, we can adjust once you provide the register
-		// value from `readRegister(Register::AFE_RES)`.
-		if (afeRes & 0x01u) {
+		// FS_HIGH_CH1 is AFE_RES bit 3 (bits 0..2 are EN_HIRES_CHn). All
+		// three channels share the R3 code written below, so channel 1's
+		// clock decides.
+		if (afeRes & 0x08u) {
 			fs = 204800.0f;
 		}
 	}
 
 	// numeric target ODR for each supported enum (R1=4,R2=4; vary R3)
-	float targetHz = 0.0f;
-	switch (s)
-	{
-	case ADS1293::SamplingRate::SPS_1600: targetHz = 1600.0f; break;         // R3=4
-	case ADS1293::SamplingRate::SPS_1067: targetHz = 1066.6667f; break;    // R3=6
-	case ADS1293::SamplingRate::SPS_800:  targetHz = 800.0f; break;         // R3=8
-	case ADS1293::SamplingRate::SPS_533:  targetHz = 533.3333f; break;      // R3=12
-	case ADS1293::SamplingRate::SPS_400:  targetHz = 400.0f; break;         // R3=16
-	case ADS1293::SamplingRate::SPS_200:  targetHz = 200.0f; break;         // R3=32
-	case ADS1293::SamplingRate::SPS_100:  targetHz = 100.0f; break;         // R3=64
-	case ADS1293::SamplingRate::SPS_50:   targetHz = 50.0f; break;          // R3=128
-	default: return false;
-	}
+	const float targetHz = samplingRateHz(s);
+	if (targetHz == 0.0f)
+		return false;
 
 	// Fix R1=4 and R2=4 per requirement. Only vary R3 from allowed candidates.
 	const uint8_t r1 = 4;
@@ -490,20 +2115,36 @@ bool ADS1293::setSamplingRate(ADS1293::SamplingRate s)
 	uint8_t r2Reg = r2Code(r2); // r2=4 -> 0x01
 	uint8_t r3Reg = r3Code(chosenR3);
 
-	bool ok = true;
-	ok &= writeRegister(Register::R1_RATE, r1Reg);
-	ok &= writeRegister(Register::R2_RATE, r2Reg);
-	ok &= writeRegister(Register::R3_RATE_CH1, r3Reg);
-	ok &= writeRegister(Register::R3_RATE_CH2, r3Reg);
-	ok &= writeRegister(Register::R3_RATE_CH3, r3Reg);
-	delay(1);
-
-	// Verify writes by reading back at least R2 and R3
-	uint8_t verify = 0;
-	if (!readRegister(Register::R2_RATE, verify)) return false;
-	if (verify != r2Reg) return false;
-	if (!readRegister(Register::R3_RATE_CH1, verify)) return false;
-	if (verify != r3Reg) return false;
+	// Stage all five rate registers and flush them together: R2_RATE..R1_RATE
+	// (0x21..0x25) are adjacent, so this is a single burst (or nothing at all
+	// if the rate is unchanged). START_CON locks them, so a running device is
+	// paused around the write, as in setChannelSamplingRate().
+	uint8_t config = 0;
+	bool ok = pauseConversions(config);
+	ok &= stageRegister(Register::R1_RATE, r1Reg);
+	ok &= stageRegister(Register::R2_RATE, r2Reg);
+	ok &= stageRegister(Register::R3_RATE_CH1, r3Reg);
+	ok &= stageRegister(Register::R3_RATE_CH2, r3Reg);
+	ok &= stageRegister(Register::R3_RATE_CH3, r3Reg);
+	ok &= sync();
 
+	// Read the rates back from the device (one burst) so the cache and the
+	// return value reflect what it actually runs at.
+	const uint8_t expected[5] = {r2Reg, r3Reg, r3Reg, r3Reg, r1Reg};
+	uint8_t rates[5];
+	if (ok && readBurst(static_cast<uint8_t>(Register::R2_RATE), rates, sizeof(rates)))
+	{
+		for (uint8_t i = 0; i < sizeof(rates); ++i)
+		{
+			ok &= rates[i] == expected[i];
+			cacheStore(static_cast<uint8_t>(static_cast<uint8_t>(Register::R2_RATE) + i), rates[i]);
+		}
+	}
+	else
+	{
+		ok = false;
+	}
+	ok &= updateRateSchedule(false);
+	ok &= resumeConversions(config);
 	return ok;
 }
@@ -34,6 +34,15 @@
 #include <Arduino.h>
 #include <SPI.h>
 
+// Hot-path instrumentation (see ADS1293::getMetrics()). Off by default; set
+// to 1 in the build flags (e.g. build_flags = -DADS1293_ENABLE_METRICS=1) to
+// count frames, drops, DRDY-to-read latency, bus and decode time. It changes
+// the class layout, so it must be defined for the library sources too, not
+// only in the sketch. At 0 the counters and timing calls are compiled out.
+#ifndef ADS1293_ENABLE_METRICS
+#define ADS1293_ENABLE_METRICS 0
+#endif
+
 // (no namespace) public API placed in the global namespace for compatibility
 
 // Commands used to form read/write transfer bytes.
@@ -54,13 +63,24 @@ enum class Register : uint8_t {
   CMDET_EN = 0x0A,
   CMDET_CN = 0x0B,
   RLD_CN = 0x0C,
+  WILSON_EN1 = 0x0D,
+  WILSON_EN2 = 0x0E,
+  WILSON_EN3 = 0x0F,
+  WILSON_CN = 0x10,
   REF_CN = 0x11,
   OSC_CN = 0x12,
   AFE_RES = 0x13,
   AFE_SHDN_CN = 0x14,
   AFE_FAULT_CN = 0x15,
   AFE_PACE_CN = 0x17,
+  ERROR_LOD = 0x18,
   ERR_STATUS = 0x19,
+  ERROR_RANGE1 = 0x1A,
+  ERROR_RANGE2 = 0x1B,
+  ERROR_RANGE3 = 0x1C,
+  ERROR_SYNC = 0x1D,
+  ERROR_MISC = 0x1E,
+  DIGO_STRENGTH = 0x1F,
   MASK_ERR = 0x2A,
   R2_RATE = 0x21,
   R3_RATE_CH1 = 0x22,
@@ -70,8 +90,18 @@ enum class Register : uint8_t {
   DIS_EFILTER = 0x26,
   DRDYB_SRC = 0x27,
   SYNCB_CN = 0x28,
+  MASK_DRDYB = 0x29,
+  ALARM_FILTER = 0x2E,
   CH_CNFG = 0x2F,
-  REVID = 0x40
+  DATA_STATUS = 0x30,
+  DATA_CH1_PACE = 0x31,
+  DATA_CH2_PACE = 0x33,
+  DATA_CH3_PACE = 0x35,
+  DATA_CH1_ECG = 0x37,
+  DATA_CH2_ECG = 0x3A,
+  DATA_CH3_ECG = 0x3D,
+  REVID = 0x40,
+  DATA_LOOP = 0x50
 };
 
 // Option enums for configuration helpers. Values map to register payloads used
@@ -85,9 +115,17 @@ enum class OscMode : uint8_t { Default = 0x04 };
 enum class AFEShutdownMode : uint8_t { Default = 0x24, AFE_On = 0x00 };
 enum class R2Rate : uint8_t { Rate_2 = 0x02 };
 enum class R3Rate : uint8_t { Rate_2 = 0x02 };
-enum class DRDYSource : uint8_t { Default = 0x08 };
+enum class DRDYSource : uint8_t {
+  Default = 0x08,
+  Ch1Pace = 0x01,
+  Ch2Pace = 0x02,
+  Ch3Pace = 0x04,
+  Ch1Ecg = 0x08,
+  Ch2Ecg = 0x10,
+  Ch3Ecg = 0x20
+};
 enum class ChannelConfig : uint8_t { Default3Lead = 0x30, Default5Lead = 0x70 };
-enum class GlobalConfig : uint8_t { Start = 0x01 };
+enum class GlobalConfig : uint8_t { Start = 0x01, Standby = 0x02, PowerDown = 0x04 };
 
 // FLEX_CH3 register mode (used by 5-lead example)
 enum class FlexCh3Mode : uint8_t { Default = 0x2E };
@@ -101,10 +139,14 @@ enum class TestSignal : uint8_t {
   Zero = 0x03
 };
 
+class ADS1293FilterChain; // protocentral_ads1293_filter.h
+
 class ADS1293 {
 public:
   // Construct with DRDY and CS pins. Use begin() to initialize hardware.
-  explicit ADS1293(uint8_t drdyPin, uint8_t csPin, SPIClass *spi = &SPI) noexcept;
+  // spiClockHz sets the SCLK rate used for every transaction (the ADS1293
+  // accepts up to 20 MHz; the default keeps the original 1 MHz).
+  explicit ADS1293(uint8_t drdyPin, uint8_t csPin, SPIClass *spi = &SPI, uint32_t spiClockHz = 1000000) noexcept;
 
   // Initialize pins and optionally start SPI. Must be called in setup().
   // Pass startSPI=false on platforms that need custom SPI pin setup (e.g. some ESP32 configs).
@@ -114,6 +156,28 @@ public:
   // (convenience for platforms like ESP32 where SPI.begin(sck, miso, mosi) is common).
   void begin(uint8_t sck, uint8_t miso, uint8_t mosi);
 
+  // Change the SPI clock after construction. Values above the 20 MHz
+  // datasheet maximum are clamped. The settings object is rebuilt once here
+  // and reused by every register and sample access.
+  void setSPIClock(uint32_t hz);
+  uint32_t getSPIClock() const noexcept { return spiClockHz_; }
+
+  // Bus and DRDY pin given at construction (e.g. to poll several devices
+  // on one bus, see ADS1293Group).
+  SPIClass *getSPI() const noexcept { return spi_; }
+  uint8_t getDrdyPin() const noexcept { return drdyPin_; }
+
+  // Optional pause after each register write. The datasheet places no wait
+  // requirement between register accesses, so this defaults to 0; raise it
+  // only for long or noisy wiring that needs CS settling time.
+  void setWriteDelay(uint16_t micros) noexcept { writeDelayUs_ = micros; }
+
+  // Measure the average time (ns) to read one ECG frame over the bus at the
+  // current clock, over `iterations` reads. Useful for sizing the per-frame
+  // budget at high sampling rates. Returns 0 while acquisition is running
+  // (the measurement reads would steal frames).
+  uint32_t measureFrameBusTime(uint8_t iterations = 32);
+
   // Configuration helpers
   bool begin3LeadECG();
 
@@ -129,6 +193,25 @@ public:
     int32_t ch2 = 0;
     int32_t ch3 = 0;
     bool ok = false;
+    // Signal-quality flags, filled while a status mode is set (see
+    // setStatusMode): DATA_STATUS (bit 1 = ALARMB active; in-burst mode
+    // only), ERROR_LOD (bit n = lead off on input IN(n+1)) and ERR_STATUS
+    // (CMOR, RLDRAIL, BATLOW, LEADOFF, CH1..3ERR out of range, SYNCEDGEERR).
+    uint8_t status = 0;
+    uint8_t leadOff = 0;
+    uint8_t errors = 0;
+    // Raw 16-bit pace data (DATA_CHn_PACE), filled only while pace readout
+    // is enabled (see enablePaceReadout). Zero input reads paceAdcMax() / 2.
+    uint16_t pace1 = 0;
+    uint16_t pace2 = 0;
+    uint16_t pace3 = 0;
+    // Sample clock (see sampleClockHz), filled by readFrames(), the
+    // acquisition ring and captureFrames(): `index` counts output periods
+    // since the clock was last reset (acquisition start or a rate change),
+    // so dropped or coalesced frames show up as gaps; `timestampUs` is the
+    // micros() time of the frame's DRDY edge on the drift-corrected clock.
+    uint32_t index = 0;
+    uint32_t timestampUs = 0;
   };
 
   // Convenience overload: returns a Samples struct containing the three
@@ -136,18 +219,179 @@ public:
   // where reference parameters are inconvenient.
   Samples getECGData();
 
+  // Interrupt-driven acquisition. Attaches to the DRDY falling edge and reads
+  // each frame inside the interrupt handler into a caller-provided ring of
+  // `depth` Samples (`depth` must be a power of two, 2..32768). The ring is a
+  // single-producer (interrupt) / single-consumer (loop) queue and needs no
+  // locking. Frames that arrive while the ring is full are dropped and counted
+  // in overrunCount(). Only one ADS1293 instance can own the DRDY interrupt at
+  // a time. Returns false if the buffer/depth is invalid or the DRDY pin has
+  // no interrupt.
+  // `buffer` may be nullptr (depth ignored) when only a frame callback is
+  // used, see onFrameReady().
+  //
+  // On ESP32 the SPI driver cannot be used from an interrupt, so reads are
+  // always deferred (see setDeferredReads).
+  bool startAcquisition(Samples *buffer, uint16_t depth);
+  void stopAcquisition();
+  bool acquisitionActive() const noexcept { return acquiring_; }
+
+  // Deferred reads: the DRDY interrupt only records the edge and calls
+  // `notify` (if given, from the interrupt), and the frame is read and
+  // pushed into the ring by serviceDataReady(). Without `notify` every
+  // readFrames() call services the pending edge first; with it, the
+  // notified context (e.g. an acquisition task, see
+  // protocentral_ads1293_task.h) calls serviceDataReady() and readFrames()
+  // only drains the ring, so producer and consumer can run on different
+  // cores. Edges that pile up before a read are coalesced: the data
+  // registers hold only the newest frame. Always on for ESP32, where
+  // setDeferredReads(false) returns false.
+  typedef void (*DataReadyNotify)(void *context);
+  bool setDeferredReads(bool enable, DataReadyNotify notify = nullptr, void *context = nullptr);
+  bool deferredReads() const noexcept { return deferReads_; }
+
+  // Read the frame for pending DRDY edges, if any, into the ring (and the
+  // frame callback). Returns the number of frames read (0 or 1).
+  size_t serviceDataReady();
+
+  // Size of a raw ECG frame: DATA_CH1_ECG..DATA_CH3_ECG, MSB first.
+  static constexpr uint8_t FRAME_BYTES = 9;
+
+  // Size of the full data block DATA_STATUS..DATA_CH3_ECG, read in one burst
+  // while pace readout is enabled: status, 3 x 16-bit pace, 3 x 24-bit ECG.
+  static constexpr uint8_t DATA_BLOCK_BYTES = 16;
+
+  // Completion callback for the acquisition path. Called from the DRDY
+  // interrupt once a frame has been clocked in, with a pointer to the raw
+  // 9-byte frame. Frames are double-buffered: the pointer stays valid (and
+  // unmodified) until the *second* following frame completes, so the caller
+  // can encode/transmit it from loop() while the next frame is being read,
+  // without copying. With pace readout enabled, the 7 bytes before `frame`
+  // hold DATA_STATUS and the pace data of the same burst. Pass nullptr to
+  // remove the callback.
+  typedef void (*FrameReadyCallback)(const uint8_t *frame, void *context);
+  void onFrameReady(FrameReadyCallback cb, void *context = nullptr);
+
+  // Number of frames waiting in the acquisition ring.
+  size_t available() const noexcept;
+
+  // Copy up to maxFrames available frames into `out` (oldest first) and
+  // return how many were written. With acquisition running this drains the
+  // ring; otherwise it reads the pending frame if DRDY is asserted. If
+  // `missed` is given it is set when frames were dropped since the previous
+  // call (ring overruns).
+  size_t readFrames(Samples *out, size_t maxFrames, bool *missed = nullptr);
+
+  // Blocking block capture: read `frames` consecutive frames in a single SPI
+  // transaction using the DATA_LOOP streaming mode, waiting on DRDY between
+  // frames while CS stays asserted. Only the channels enabled in CH_CNFG are
+  // clocked (disabled channels read as 0). Returns the number of frames
+  // captured before `timeoutMs` expired. Not available while acquisition is
+  // running. Holds the bus for the whole capture.
+  size_t captureFrames(Samples *out, size_t frames, uint32_t timeoutMs = 1000);
+
+  // Frames dropped because the ring was full when DRDY fired.
+  uint32_t overrunCount() const noexcept;
+
+  // Highest ring fill level seen since startAcquisition() or the last
+  // reset, in frames; equal to the depth means the ring was full.
+  uint16_t ringHighWater() const noexcept { return ringHighWater_; }
+  void resetRingHighWater() noexcept { ringHighWater_ = 0; }
+
+  // The sample clock follows the device's output clock (fS / (R1 * R2 * R3)
+  // of the DRDY source, derived from its own oscillator) on the host's
+  // micros() with an alpha-beta tracker updated once per frame: the DRDY
+  // edge time, taken in the interrupt (or on the polled read), corrects the
+  // predicted edge by 1/32 and the period by 1/2048 of the error, so
+  // timestamps carry little interrupt or loop jitter. Edges lost in between
+  // are inferred from the elapsed time. sampleClockHz() is the output rate
+  // in host time, measured over the frames since the clock was reset, and
+  // sampleClockPpm() its deviation from the programmed rate (the drift of
+  // the device oscillator against the host clock).
+  float sampleClockHz() const noexcept;
+  float sampleClockPpm() const noexcept;
+
+  // Filter the frames returned by readFrames() and captureFrames() in place,
+  // block by block, outside the interrupt. The chain is not copied and must
+  // outlive the attachment. Pass nullptr to detach.
+  void attachFilter(ADS1293FilterChain *chain) noexcept { filter_ = chain; }
+
+  // Body of the DRDY interrupt: reads one frame and pushes it into the ring.
+  // Public so that custom interrupt dispatchers (or a host test harness
+  // injecting fake DRDY edges) can drive acquisition directly.
+  void handleDataReady();
+
   // Raw access and conversion helpers
   // Read the raw 24-bit unsigned sample for channel (1..3). Returns true on success.
   bool getRaw24(uint8_t channel, uint32_t &raw24);
 
+  // Decode a raw 9-byte frame (as read by readSampleBytes() or passed to a
+  // FrameReadyCallback) into three sign-extended channel values.
+  static void decodeFrame(const uint8_t *buf, int32_t &ch1, int32_t &ch2, int32_t &ch3) noexcept;
+
+  // Block decode of `frames` raw 9-byte frames stored back to back (e.g.
+  // collected from FrameReadyCallback). Writes de-interleaved per-channel
+  // arrays; pass nullptr for a channel to skip it. The loops are branch-free
+  // per sample so the compiler can unroll/vectorize them.
+  static void decodeFrames(const uint8_t *raw, size_t frames, int32_t *ch1, int32_t *ch2, int32_t *ch3) noexcept;
+
+  // As above, but scaled to volts with one multiply per sample. Use
+  // voltsPerLsb() to precompute `lsbVolts` once per configuration.
+  static void decodeFrames(const uint8_t *raw, size_t frames, float *ch1, float *ch2, float *ch3, float lsbVolts) noexcept;
+
+  // Volts per code for the given parameters; the same scale rawToVoltage()
+  // applies, folded into one factor.
+  static float voltsPerLsb(float vref = 2.4f, int32_t adcFullscale = ((1 << 23) - 1), float gain = 1.0f) noexcept;
+
   // Read the raw sample bytes for all three channels (9 bytes: ch1[MSB..LSB], ch2[MSB..LSB], ch3[MSB..LSB]).
   // Useful for diagnostic/debug printing of the raw SPI payload.
   bool readSampleBytes(uint8_t buf[9]);
 
   // Dump a small set of diagnostic registers and the latest sample bytes to the provided Print
   // (e.g., `Serial`). This prints REVID, ERR_STATUS and the 9 sample bytes in hex.
+  // With ADS1293_ENABLE_METRICS the metrics are printed as well.
   bool dumpDebug(Print &out);
 
+  // Hot-path metrics, recorded only when built with ADS1293_ENABLE_METRICS
+  // (otherwise getMetrics() returns zeros and nothing is measured).
+  //  - drdyEdges: DRDY interrupts taken while acquisition runs.
+  //  - framesRead / readErrors: frame reads over SPI on the acquisition,
+  //    polled and capture paths.
+  //  - framesMissed: DRDY edges not followed by a read of their frame
+  //    (coalesced edges in deferred mode, failed reads); ringDrops: frames
+  //    read but dropped because the ring was full.
+  //  - latency: DRDY edge to start of the frame read, in LATENCY_BUCKETS
+  //    power-of-two buckets: bucket i counts reads below (8 << i) us, the
+  //    last one everything above. In interrupt mode this is the handler's
+  //    own overhead; in deferred mode (ESP32, tasks) it includes the wait for
+  //    readFrames().
+  //  - busBytes: bytes (command bytes included) in SPI transactions of this
+  //    driver; busUs: time spent reading frames on the acquisition and polled
+  //    paths (register access is counted in bytes only).
+  //  - decodes / decodeUs: frames decoded into Samples and the time from the
+  //    end of the frame read to the stored Sample (status handling included).
+  // Each frame costs three clock reads (two on the polled path), shared
+  // between latency, bus and decode time. Counters wrap at 2^32. Those that
+  // both the interrupt and loop() update take atomic adds (interrupts off on
+  // AVR), so no increment is lost; getMetrics() copies them one by one, so
+  // a copy taken while acquiring may be a frame apart between fields.
+  struct Metrics {
+    static constexpr uint8_t LATENCY_BUCKETS = 8;
+    uint32_t drdyEdges = 0;
+    uint32_t framesRead = 0;
+    uint32_t framesMissed = 0;
+    uint32_t ringDrops = 0;
+    uint32_t readErrors = 0;
+    uint32_t latency[LATENCY_BUCKETS] = {};
+    uint32_t maxLatencyUs = 0;
+    uint32_t busBytes = 0;
+    uint32_t busUs = 0;
+    uint32_t decodes = 0;
+    uint32_t decodeUs = 0;
+  };
+  Metrics getMetrics() const noexcept;
+  void resetMetrics() noexcept;
+
   // Convert a 24-bit unsigned raw value to signed int32 using two's-complement
   // sign-extension. This library always interprets ADC output as two's-complement
   // 24-bit by default.
@@ -156,10 +400,146 @@ public:
   // Convert a signed code to a voltage (V). adcFullscale defaults to 2^23-1.
   static float rawToVoltage(int32_t signedCode, float vref = 2.4f, int32_t adcFullscale = ((1 << 23) - 1), float gain = 1.0f) noexcept;
 
+  // Burst register access. Reads or writes `len` consecutive registers
+  // starting at `start` in a single auto-incrementing SPI transaction, e.g.
+  // FLEX_CH1_CN..RLD_CN or R2_RATE..CH_CNFG. The device stops incrementing
+  // at 0x4F, so ranges past that are rejected.
+  bool writeRegisters(Register start, const uint8_t *values, uint8_t len) noexcept;
+  bool readRegisters(Register start, uint8_t *values, uint8_t len) noexcept;
+
+  // Register image for bulk configuration of the writable block
+  // CONFIG..CH_CNFG (0x00..0x2F). Only registers marked with set() are
+  // written by applyConfiguration(). Read-only addresses are ignored.
+  struct RegisterImage {
+    static constexpr uint8_t SIZE = 0x30;
+    uint8_t value[SIZE] = {};
+    uint8_t mask[SIZE / 8] = {};
+
+    void set(Register reg, uint8_t v) noexcept;
+    bool isSet(uint8_t addr) const noexcept
+    {
+      return addr < SIZE && (mask[addr >> 3] & (1u << (addr & 7)));
+    }
+    void clear() noexcept;
+  };
+
+  // Write every register in `img` that differs from the register cache,
+  // grouping them into as few bursts as possible. CONFIG (which starts
+  // conversions) is written last so the device never runs on a half-applied
+  // configuration.
+  bool applyConfiguration(const RegisterImage &img);
+
+  // Apply a complete configuration image built at compile time (see
+  // protocentral_ads1293_profile.h). `image` points to PROFILE_BYTES bytes
+  // in program memory. Conversions are stopped by the first byte written,
+  // 0x01..0x17 and 0x21..0x2F follow in two bursts, and CONFIG is written
+  // last: always three transactions. Pace and status readout, if enabled,
+  // stay enabled.
+  static constexpr uint8_t PROFILE_BYTES = RegisterImage::SIZE;
+  bool applyProfile(const uint8_t *image);
+  template <typename Profile>
+  bool applyProfile() { return applyProfile(Profile::image()); }
+
+  // Start (or reconfigure) the device from a profile as fast as the
+  // datasheet allows, waiting on the device rather than on fixed delays:
+  //  - REVID is polled until the serial interface answers;
+  //  - with the crystal oscillator, STRTCLK is held off until
+  //    CLOCK_START_MS after power-up (taken as MCU boot) or after leaving
+  //    power-down, and not at all when the clock is already running;
+  //  - the profile is applied (three transactions);
+  //  - DRDY is polled until the first settled frame. The ECG filters settle
+  //    in SETTLE_FRAMES output periods (5 x R1 x R2 x R3 / fS). By default
+  //    the device masks DRDY for its first DRDY_MASK_FRAMES (6) conversions,
+  //    so the first DRDY, and the frame returned, is conversion 6. Profiles
+  //    with ADS1293DataReadyMasking<false> see DRDY from conversion 1;
+  //    conversions 1 to 4 are read and discarded and conversion 5 returned.
+  // The settled frame is returned in `settled` when given (otherwise left
+  // for the next read). `timing` receives the microseconds from the call to
+  // each step. Fails on timeout or while acquisition is running; profiles
+  // that do not start conversions return after the configuration step.
+  struct StartupTiming {
+    uint32_t readyUs = 0;         // REVID answered
+    uint32_t configuredUs = 0;    // profile written, conversions started
+    uint32_t firstSampleUs = 0;   // first DRDY
+    uint32_t settledSampleUs = 0; // DRDY of the first settled frame
+  };
+  static constexpr uint8_t CLOCK_START_MS = 15;
+  static constexpr uint8_t SETTLE_FRAMES = 5;
+  static constexpr uint8_t DRDY_MASK_FRAMES = 6;
+  bool startup(const uint8_t *image, Samples *settled = nullptr, StartupTiming *timing = nullptr, uint16_t timeoutMs = 250);
+  template <typename Profile>
+  bool startup(Samples *settled = nullptr, StartupTiming *timing = nullptr, uint16_t timeoutMs = 250)
+  {
+    return startup(Profile::image(), settled, timing, timeoutMs);
+  }
+
+  // Register cache. The driver keeps a shadow of the configuration block
+  // (0x00..0x2F, excluding the read-only error registers). Reads of cached
+  // registers are served from RAM, and writes of a value the device already
+  // holds are skipped. stageRegister() only updates the shadow and marks it
+  // dirty; sync() writes all dirty registers in grouped bursts. verify()
+  // reads the block back, refreshes the shadow and returns false if any
+  // clean cached value did not match the device (e.g. after a chip reset).
+  // While conversions run, the device ignores writes to REF_CN..AFE_RES and
+  // R2_RATE..MASK_DRDYB: such writes are not cached and return false.
+  struct CacheStats {
+    uint32_t hits = 0;          // reads served from the cache
+    uint32_t misses = 0;        // reads that went to the bus
+    uint32_t writesSkipped = 0; // writes dropped because the value was unchanged
+    uint32_t writes = 0;        // registers written over the bus
+  };
+  bool stageRegister(Register reg, uint8_t value) noexcept;
+  bool sync();
+  bool verify();
+  void invalidateCache() noexcept;
+  const CacheStats &getCacheStats() const noexcept { return cacheStats_; }
+  void resetCacheStats() noexcept { cacheStats_ = CacheStats(); }
+
   // Device information
   uint8_t readDeviceID();
   uint8_t readErrorStatus();
 
+  // Read ERROR_LOD..ERROR_MISC (0x18..0x1E) in one burst into `regs`.
+  static constexpr uint8_t ERROR_REGISTER_COUNT = 7;
+  bool readErrorRegisters(uint8_t *regs);
+
+  // Lead-off detection. `inputMask` enables IN1..IN6 (bit 0 = IN1); in
+  // digital AC mode it selects the phase of the current injected into each
+  // channel instead. `currentNa` is rounded down to the 8 nA steps of
+  // LOD_CURRENT (max 2040 nA); `acLevel` (0..3) is the AC comparator level.
+  enum class LeadOffMode : uint8_t {
+    Off = 0x08,       // SHDN_LOD
+    DC = 0x00,
+    DigitalAC = 0x04, // SELAC_LOD
+    AnalogAC = 0x14   // SELAC_LOD | ACAD_LOD
+  };
+  bool configureLeadOff(LeadOffMode mode, uint8_t inputMask, uint16_t currentNa, uint8_t acLevel = 0);
+
+  // AC lead-off test frequency divider (LOD_AC_CN, 1..127, optionally / 16).
+  bool setLeadOffAcDivider(uint8_t divider, bool divideBy16 = false);
+
+  // MASK_ERR: set bits keep the matching ERR_STATUS condition off ALARMB.
+  // ALARM_FILTER: consecutive counts (0..15, +1) before ALARMB asserts.
+  bool setAlarmMask(uint8_t mask);
+  bool setAlarmFilter(uint8_t leadOffCount, uint8_t otherCount);
+
+  // Status readout folded into the sample path:
+  //  - InBurst: every frame is read from DATA_STATUS (the same 16-byte
+  //    burst as pace readout); only when its ALARMB bit is set are
+  //    ERROR_LOD and ERR_STATUS read, in one extra 2-byte burst.
+  //  - AlarmPin: frames stay 9 bytes; the error registers are read only
+  //    while the ALARMB pin (`alarmPin`) is low.
+  // Each frame then carries status/leadOff/errors. captureFrames() only
+  // reports DATA_STATUS (CH_CNFG STS_EN is set for InBurst).
+  enum class StatusMode : uint8_t { Off, InBurst, AlarmPin };
+  bool setStatusMode(StatusMode mode, uint8_t alarmPin = 255);
+
+  // Called when the lead-off or error flags change (edge triggered, also
+  // when they clear), from the same context as the frame read: the DRDY
+  // interrupt, serviceDataReady() in deferred mode, or readFrames().
+  typedef void (*StatusCallback)(uint8_t leadOff, uint8_t errors, void *context);
+  void onStatusChange(StatusCallback cb, void *context = nullptr);
+
   // Channel and filter helpers
   void disableChannel(uint8_t channel);
   void disableFilterAll();
@@ -177,7 +557,8 @@ public:
   bool configureOscillator(OscMode m = OscMode::Default);
   bool configureAFEShutdown(AFEShutdownMode m = AFEShutdownMode::Default);
   bool configureRef(RefMode m = RefMode::Default);
-  bool configureSamplingRates(R2Rate r2 = R2Rate::Rate_2, R3Rate r3ch1 = R3Rate::Rate_2, R3Rate r3ch2 = R3Rate::Rate_2);
+  bool configureSamplingRates(R2Rate r2 = R2Rate::Rate_2, R3Rate r3ch1 = R3Rate::Rate_2, R3Rate r3ch2 = R3Rate::Rate_2,
+                              R3Rate r3ch3 = R3Rate::Rate_2);
   bool configureDRDYSource(DRDYSource m = DRDYSource::Default);
   bool configureChannelConfig(ChannelConfig m = ChannelConfig::Default3Lead);
   bool applyGlobalConfig(GlobalConfig m = GlobalConfig::Start);
@@ -221,14 +602,207 @@ public:
     SPS_50    // R3=128
   };
 
+  // Nominal output data rate (Hz) of a SamplingRate preset, 0 if unknown.
+  static float samplingRateHz(SamplingRate s) noexcept;
+
   // Configure R2/R3 rate registers for the requested output data rate (ODR).
-  // Returns true if all rate registers were written successfully.
+  // START_CON write-locks them, so a running device is paused around the
+  // change. Returns true once the device reads back the new rates.
   bool setSamplingRate(SamplingRate s);
 
+  // Per-channel output data rate: programs R1 and R3 of channel 1..3 for
+  // the preset. R2 is shared: it is kept when the preset can be reached
+  // exactly with the current R2, and otherwise set to 4 (as for
+  // setSamplingRate()) only if every other enabled channel can keep its
+  // rate through its own R1 and R3; if not, nothing is written and false
+  // is returned (call setSamplingRate() first). DRDYB_SRC then points at
+  // the fastest enabled ECG channel unless a pace channel drives it.
+  // START_CON write-locks the rate registers, so a running device is
+  // paused around the change.
+  //
+  // While enabled channels run at different rates, each frame read
+  // (acquisition ring, readFrames, frame callback) reads DATA_STATUS and
+  // then only the ECG channels it flags as updated, so a slower channel
+  // costs bus time only when it has new data. Channels not due keep their
+  // last value; Samples::status carries the flags (bit 5 + n-1 = new data
+  // on channel n). captureFrames() still streams every channel.
+  bool setChannelSamplingRate(uint8_t channel, SamplingRate s);
+
+  // Output data rate (Hz) of ECG channel 1..3 as currently programmed,
+  // decoded from AFE_RES (FS_HIGH_CHn), R1_RATE, R2_RATE and R3_RATE_CHn:
+  // ODR = fS / (R1 * R2 * R3). getPaceDataRate() returns fS / (R1 * R2).
+  // Register values come from the cache when known. Returns 0 on error.
+  float getOutputDataRate(uint8_t channel = 1);
+  float getPaceDataRate(uint8_t channel = 1);
+
+  // Full-scale codes for the programmed rates (datasheet tables 8-11):
+  // ADC_MAX of ECG channel 1..3 (depends on R2 and R3) and of the pace data
+  // (depends on R2). Zero input reads ADC_MAX / 2. Return 0 on error.
+  uint32_t ecgAdcMax(uint8_t channel = 1);
+  uint16_t paceAdcMax();
+
+  // Integer conversion of ECG samples to microvolts, using the datasheet
+  // transfer function with the programmed ADC_MAX of each channel:
+  //   uV = (code - ADC_MAX / 2) * 2 * VREF / (3.5 * ADC_MAX)
+  // (3.5 is the fixed INA gain; the device has no programmable gain). The
+  // scale is precomputed per channel as a 32-bit Q-format multiplier
+  // whenever the rates change (and by updateMicrovoltScale()), so a
+  // conversion is one widening multiply and a shift, with no float and no
+  // division (plus an exact integer check for values within 1 / 2^shift of
+  // a rounding tie). Results are the exact value rounded half away from
+  // zero.
+  // `sample` is a value as returned in Samples (the 24-bit code, sign
+  // extended). Battery-monitor channels are not converted correctly.
+  bool setReferenceVoltage(float volts); // VREF, 2.4 V internal reference
+  bool updateMicrovoltScale();
+  int32_t toMicrovolts(uint8_t channel, int32_t sample) const noexcept;
+  void toMicrovolts(uint8_t channel, const int32_t *in, int32_t *out, size_t n) const noexcept;
+  void toMicrovolts(Samples *frames, size_t n) const noexcept; // ch1..ch3 in place
+
+  // Pace data. Each ECG channel also produces 16-bit pace data at
+  // getPaceDataRate() (3.2 to 25.6 kHz), well above the ECG rate. With
+  // readout enabled every frame (acquisition ring, readFrames, captureFrames)
+  // is read as one DATA_STATUS..DATA_CH3_ECG burst, so the pace fields of
+  // Samples come with the ECG data in the same transaction; CH_CNFG is
+  // updated so captureFrames() streams pace too. To sample pace at its own
+  // rate while the ECG runs slower, select a pace channel as DRDY source
+  // (configureDRDYSource(DRDYSource::Ch1Pace)): frames then arrive at the
+  // pace rate and carry the latest ECG sample.
+  bool enablePaceReadout(bool enable = true);
+  bool paceReadoutEnabled() const noexcept { return paceReadout_; }
+  bool readPace(uint16_t &pace1, uint16_t &pace2, uint16_t &pace3);
+
+  // Double the pace data rate of channel 1..3 (R1 = 2 instead of 4).
+  bool setDoublePaceRate(uint8_t channel, bool enable = true);
+
+  // Analog pace channel (channel 4): route inputs IN1..IN6 to its positive
+  // and negative terminals (0 = disconnected) via FLEX_PACE_CN, and power it
+  // up with its output optionally connected to the RLDIN and/or WCT pin
+  // (AFE_PACE_CN). The analog pace output is not digitized by the device;
+  // it is meant for an external pace detector.
+  bool configurePaceChannel(uint8_t posInput, uint8_t negInput);
+  bool configureAnalogPace(bool enable, bool toRldin = false, bool toWct = false);
+
+  // Battery monitor on ECG channel 1..3: the channel measures VDD against
+  // the reference instead of its inputs (FLEX_VBAT_CN, INA shut down and
+  // SDM powered up in AFE_SHDN_CN). Only meaningful for battery supplies of
+  // 2.4 V to 4.8 V, not for a regulated 5 V supply.
+  bool enableBatteryMonitor(uint8_t channel, bool enable = true);
+
+  // Read the supply voltage from a channel in battery-monitor mode:
+  // VBAT = VREF * (1 + code / ADC_MAX), the code spanning VREF..2 * VREF.
+  bool readBatteryVoltage(uint8_t channel, float &volts, float vref = 2.4f);
+
 private:
   uint8_t drdyPin_ = 255;
   uint8_t csPin_ = 255;
   SPIClass *spi_ = nullptr;
+  uint32_t spiClockHz_ = 1000000;
+  SPISettings spiSettings_;
+  uint16_t writeDelayUs_ = 0;
+
+  // acquisition ring state (see startAcquisition). head_ is written only by
+  // the producer (interrupt), tail_ only by the consumer. Both run freely and
+  // are masked on access, so head_ - tail_ is the fill level.
+  Samples *ring_ = nullptr;
+  uint16_t ringMask_ = 0;
+  volatile uint16_t head_ = 0;
+  volatile uint16_t tail_ = 0;
+  volatile uint32_t overruns_ = 0;
+  volatile uint16_t pendingEdges_ = 0; // deferred-read mode
+  volatile uint16_t ringHighWater_ = 0;
+#if defined(ARDUINO_ARCH_ESP32)
+  bool deferReads_ = true;
+#else
+  bool deferReads_ = false;
+#endif
+  DataReadyNotify notify_ = nullptr;
+  void *notifyCtx_ = nullptr;
+  uint32_t reportedOverruns_ = 0;       // overruns already flagged by readFrames
+  volatile bool acquiring_ = false;
+
+  // double-buffered raw frames: the interrupt fills rawSlot_[rawIndex_ ^ 1]
+  // and then flips rawIndex_, so rawSlot_[rawIndex_] is the latest frame.
+  // Slots hold the full data block; ECG-only reads fill the tail, so the
+  // 9-byte ECG frame always starts at offset ECG_OFFSET.
+  static constexpr uint8_t ECG_OFFSET = DATA_BLOCK_BYTES - FRAME_BYTES;
+  uint8_t rawSlot_[2][DATA_BLOCK_BYTES] = {};
+  volatile uint8_t rawIndex_ = 0;
+  FrameReadyCallback frameCb_ = nullptr;
+  void *frameCtx_ = nullptr;
+  ADS1293FilterChain *filter_ = nullptr;
+  bool paceReadout_ = false;
+
+  // per-channel rate scheduling (see setChannelSamplingRate)
+  bool scheduled_ = false;
+  uint8_t held_[FRAME_BYTES] = {}; // last sample of each channel, as read
+
+  // status readout (see setStatusMode)
+  StatusMode statusMode_ = StatusMode::Off;
+  uint8_t alarmPin_ = 255;
+  uint8_t leadOff_ = 0;
+  uint8_t errors_ = 0;
+  StatusCallback statusCb_ = nullptr;
+  void *statusCtx_ = nullptr;
+
+  // microvolt scale (see toMicrovolts): uV = round(|code - zero| * mult / 2^shift)
+  uint32_t vrefUv_ = 2400000;
+  uint32_t uvZero_[3] = {};
+  uint32_t uvDen_[3] = {};
+  uint32_t uvMult_[3] = {};
+  uint8_t uvShift_[3] = {1, 1, 1};
+  int32_t scaleMicrovolts(uint8_t c, int32_t sample) const noexcept;
+
+  // sample clock (see sampleClockHz). The period is Q16 microseconds.
+  volatile uint32_t edgeUs_ = 0; // micros() at the last DRDY edge
+  volatile uint32_t clockPeriodQ16_ = 0;
+  uint32_t clockNominalQ16_ = 0;
+  uint32_t clockUs_ = 0;
+  uint16_t clockFrac_ = 0;
+  uint32_t clockIndex_ = 0;
+  uint32_t anchorUs_ = 0; // baseline for sampleClockHz()
+  uint32_t anchorIndex_ = 0;
+  bool clockStarted_ = false;
+  bool resetSampleClock();
+  void advanceClock(uint32_t edgeUs, uint16_t periods) noexcept;
+  void stampFrame(Samples &s) const noexcept
+  {
+    s.index = clockIndex_;
+    s.timestampUs = clockUs_;
+  }
+
+#if ADS1293_ENABLE_METRICS
+  Metrics metrics_;
+  void recordLatency(uint32_t us) noexcept;
+  void recordBus(size_t bytes) noexcept;
+  void recordFrameRead(uint32_t startUs, uint32_t endUs) noexcept;
+  void recordDecode(uint32_t startUs) noexcept;
+#endif
+
+  static ADS1293 *isrOwner_;
+  static void drdyISR();
+  void acquireFrame(uint16_t periods = 1);
+  bool readFrame(uint8_t *block) noexcept;
+  void updateStatus(uint8_t *block) noexcept;
+  void decodeBlock(const uint8_t *block, Samples &s) const noexcept;
+  bool wideFrames() const noexcept { return paceReadout_ || statusMode_ == StatusMode::InBurst; }
+  bool updateLoopConfig();
+  bool updateRateSchedule(bool selectDataReady);
+  // Clear START_CON around a change to the locked registers; `config` is
+  // the CONFIG value to restore.
+  bool pauseConversions(uint8_t &config) noexcept;
+  bool resumeConversions(uint8_t config) noexcept;
+  bool suspendDrdyInterrupt() noexcept;
+  void resumeDrdyInterrupt(bool suspended) noexcept;
+  bool readBurst(uint8_t startAddr, uint8_t *buf, size_t len) noexcept;
+  bool writeBurst(uint8_t addr, const uint8_t *values, uint8_t len) noexcept;
+
+  // shadow of the configuration block (see stageRegister/sync/verify)
+  uint8_t shadow_[RegisterImage::SIZE] = {};
+  uint8_t shadowValid_[RegisterImage::SIZE / 8] = {};
+  uint8_t shadowDirty_[RegisterImage::SIZE / 8] = {};
+  CacheStats cacheStats_;
+  void cacheStore(uint8_t addr, uint8_t value) noexcept;
 
   // low-level register access
   bool writeRegister(Register reg, uint8_t value) noexcept;
@@ -0,0 +1,437 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protocentral ADS1293 - lossless ECG compression (implementation)
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include "protocentral_ads1293_codec.h"
+#include "protocentral_ads1293_stream.h"
+
+static constexpr uint8_t K_ZERO = 31; // Rice parameter code: all residuals zero
+static constexpr uint8_t K_MAX = 27;
+static constexpr uint8_t RAW_BITS = 28;
+static constexpr uint8_t FIRST_BITS = 26;
+
+static uint8_t countChannels(uint8_t mask) noexcept
+{
+	return static_cast<uint8_t>(((mask >> 0) & 1u) + ((mask >> 1) & 1u) + ((mask >> 2) & 1u));
+}
+
+// Reference subtracted from channel `c` before prediction: 0 none, 1 ch1,
+// 2 ch2, 3 ch2 - ch1. Only references to earlier channels in the mask.
+static bool referenceUsable(uint8_t c, uint8_t ref, uint8_t mask) noexcept
+{
+	const bool has1 = c > 0 && (mask & 0x01u);
+	const bool has2 = c > 1 && (mask & 0x02u);
+	return ref == 0 || (ref == 1 && has1) || (ref == 2 && has2) || (ref == 3 && has1 && has2);
+}
+
+template <size_t N>
+static inline int32_t predicted(const int32_t (*x)[N], uint8_t c, uint8_t ref, uint8_t i) noexcept
+{
+	uint32_t v = static_cast<uint32_t>(x[c][i]);
+	if (ref == 1)
+		v -= static_cast<uint32_t>(x[0][i]);
+	else if (ref == 2)
+		v -= static_cast<uint32_t>(x[1][i]);
+	else if (ref == 3)
+		v = v - static_cast<uint32_t>(x[1][i]) + static_cast<uint32_t>(x[0][i]);
+	return static_cast<int32_t>(v);
+}
+
+static inline uint32_t magnitude(int32_t v) noexcept
+{
+	return v < 0 ? 0u - static_cast<uint32_t>(v) : static_cast<uint32_t>(v);
+}
+
+// MSB-first bit packing into a buffer sized for the worst case. `acc` holds
+// fewer than 8 pending bits between calls, so up to 24 bits fit per put().
+static inline void putBits(uint8_t *&out, uint32_t &acc, uint8_t &bits, uint32_t v, uint8_t n) noexcept
+{
+	acc = (acc << n) | (v & ((1ul << n) - 1u));
+	bits = static_cast<uint8_t>(bits + n);
+	while (bits >= 8)
+	{
+		bits = static_cast<uint8_t>(bits - 8);
+		*out++ = static_cast<uint8_t>(acc >> bits);
+	}
+}
+
+ADS1293CodecEncoder::ADS1293CodecEncoder(Print &out, uint8_t *buffer, size_t bufferSize, uint8_t channelMask) noexcept
+	: out_(out), buf_(buffer), mask_(static_cast<uint8_t>(channelMask & 0x07u))
+{
+	const uint8_t channels = countChannels(mask_);
+	if (!buf_ || channels == 0)
+		return;
+	while (capacity_ < ENCODER_FRAMES && packetSize(static_cast<uint8_t>(capacity_ + 1), channels) <= bufferSize)
+		++capacity_;
+}
+
+bool ADS1293CodecEncoder::add(const ADS1293::Samples &s)
+{
+	if (capacity_ == 0)
+		return false;
+	x_[0][count_] = ADS1293::signExtend24(static_cast<uint32_t>(s.ch1) & 0xFFFFFFu);
+	x_[1][count_] = ADS1293::signExtend24(static_cast<uint32_t>(s.ch2) & 0xFFFFFFu);
+	x_[2][count_] = ADS1293::signExtend24(static_cast<uint32_t>(s.ch3) & 0xFFFFFFu);
+	if (++count_ == capacity_)
+		flush();
+	return true;
+}
+
+size_t ADS1293CodecEncoder::add(const ADS1293::Samples *frames, size_t count)
+{
+	size_t n = 0;
+	while (n < count && add(frames[n]))
+		++n;
+	return n;
+}
+
+void ADS1293CodecEncoder::encodeChannel(uint8_t c, uint8_t *&out, uint32_t &acc, uint8_t &bits) const noexcept
+{
+	const uint8_t n = count_;
+
+	// Cost of every reference/order pair: sum of |residual| over frames
+	// 1..n-1, all three orders in one pass. |residual| < 2^27 and n <= 32,
+	// so the sums fit 32 bits.
+	uint8_t bestRef = 0, bestOrder = 0;
+	uint32_t bestCost = 0xFFFFFFFFul;
+	for (uint8_t ref = 0; ref < 4; ++ref)
+	{
+		if (!referenceUsable(c, ref, mask_))
+			continue;
+		uint32_t cost[3] = {0, 0, 0};
+		int32_t prev = predicted(x_, c, ref, 0);
+		int32_t prevDelta = 0;
+		for (uint8_t i = 1; i < n; ++i)
+		{
+			const int32_t v = predicted(x_, c, ref, i);
+			const int32_t delta = v - prev;
+			cost[0] += magnitude(v);
+			cost[1] += magnitude(delta);
+			cost[2] += magnitude(i == 1 ? delta : delta - prevDelta);
+			prev = v;
+			prevDelta = delta;
+		}
+		for (uint8_t order = 0; order < 3; ++order)
+		{
+			if (cost[order] < bestCost)
+			{
+				bestCost = cost[order];
+				bestRef = ref;
+				bestOrder = order;
+			}
+		}
+	}
+
+	// Rice parameter from the mean residual magnitude: k = floor(log2(mean)).
+	uint8_t k = K_ZERO;
+	if (bestCost)
+	{
+		const uint32_t mean = bestCost / static_cast<uint32_t>(n - 1);
+		k = 0;
+		while (k < K_MAX && (mean >> (k + 1)))
+			++k;
+	}
+
+	putBits(out, acc, bits, bestOrder, 2);
+	putBits(out, acc, bits, bestRef, 2);
+	putBits(out, acc, bits, k, 5);
+	int32_t s1 = predicted(x_, c, bestRef, 0);
+	putBits(out, acc, bits, static_cast<uint32_t>(s1) >> 13, FIRST_BITS - 13);
+	putBits(out, acc, bits, static_cast<uint32_t>(s1), 13);
+	if (k == K_ZERO)
+		return;
+
+	int32_t s2 = 0;
+	for (uint8_t i = 1; i < n; ++i)
+	{
+		const int32_t v = predicted(x_, c, bestRef, i);
+		int32_t r = v;
+		const uint8_t order = i < bestOrder ? i : bestOrder;
+		if (order == 1)
+			r = v - s1;
+		else if (order == 2)
+			r = v - 2 * s1 + s2;
+		s2 = s1;
+		s1 = v;
+
+		const uint32_t u = (static_cast<uint32_t>(r) << 1) ^ static_cast<uint32_t>(r >> 31);
+		const uint32_t q = u >> k;
+		if (q < ESCAPE)
+		{
+			// q ones and a terminating zero, then the k low bits
+			putBits(out, acc, bits, (1ul << (q + 1)) - 2u, static_cast<uint8_t>(q + 1));
+			if (k > 16)
+				putBits(out, acc, bits, u >> 16, static_cast<uint8_t>(k - 16));
+			if (k)
+				putBits(out, acc, bits, u, k > 16 ? 16 : k);
+		}
+		else
+		{
+			putBits(out, acc, bits, (1ul << ESCAPE) - 1u, ESCAPE);
+			putBits(out, acc, bits, u >> 14, RAW_BITS - 14);
+			putBits(out, acc, bits, u, 14);
+		}
+	}
+}
+
+bool ADS1293CodecEncoder::flush()
+{
+	if (count_ == 0)
+		return true;
+
+	uint8_t *p = buf_ + HEADER_BYTES;
+	uint32_t acc = 0;
+	uint8_t bits = 0;
+	for (uint8_t c = 0; c < 3; ++c)
+		if (mask_ & (1u << c))
+			encodeChannel(c, p, acc, bits);
+	if (bits)
+		*p++ = static_cast<uint8_t>(acc << (8 - bits));
+
+	const uint16_t payload = static_cast<uint16_t>(p - buf_ - HEADER_BYTES);
+	buf_[0] = SYNC1;
+	buf_[1] = SYNC2;
+	buf_[2] = static_cast<uint8_t>((VERSION << 4) | mask_);
+	buf_[3] = count_;
+	buf_[4] = static_cast<uint8_t>(seq_);
+	buf_[5] = static_cast<uint8_t>(seq_ >> 8);
+	buf_[6] = static_cast<uint8_t>(payload);
+	buf_[7] = static_cast<uint8_t>(payload >> 8);
+	const uint16_t crc = ADS1293StreamEncoder::crc16(buf_ + 2, static_cast<size_t>(p - buf_ - 2));
+	*p++ = static_cast<uint8_t>(crc);
+	*p++ = static_cast<uint8_t>(crc >> 8);
+
+	const size_t len = static_cast<size_t>(p - buf_);
+	const bool ok = out_.write(buf_, len) == len;
+	seq_ = static_cast<uint16_t>(seq_ + count_);
+	frames_ += count_;
+	bytes_ += len;
+	++packets_;
+	count_ = 0;
+	return ok;
+}
+
+void ADS1293CodecEncoder::skipFrames(uint16_t count)
+{
+	flush();
+	seq_ = static_cast<uint16_t>(seq_ + count);
+}
+
+ADS1293CodecDecoder::ADS1293CodecDecoder(uint8_t *buffer, size_t bufferSize, FrameHandler handler, void *context) noexcept
+	: buf_(buffer), size_(buffer ? bufferSize : 0), handler_(handler), ctx_(context) {}
+
+void ADS1293CodecDecoder::feed(const uint8_t *data, size_t len)
+{
+	while (len--)
+		feed(*data++);
+}
+
+void ADS1293CodecDecoder::feed(uint8_t byte)
+{
+	if (size_ < ADS1293CodecEncoder::HEADER_BYTES + ADS1293CodecEncoder::CRC_BYTES)
+		return;
+	buf_[pos_++] = byte;
+
+	// As ADS1293StreamDecoder: a rejected candidate packet is scanned again
+	// from the byte after its sync.
+	while (pos_)
+	{
+		if (buf_[0] != ADS1293CodecEncoder::SYNC1 || (pos_ > 1 && buf_[1] != ADS1293CodecEncoder::SYNC2))
+		{
+			resync();
+			continue;
+		}
+		if (pos_ < ADS1293CodecEncoder::HEADER_BYTES)
+			return;
+		if (!expected_)
+		{
+			const uint8_t channels = countChannels(buf_[2] & 0x07u);
+			const uint8_t count = buf_[3];
+			const size_t payload = static_cast<size_t>(buf_[6] | (buf_[7] << 8));
+			expected_ = ADS1293CodecEncoder::HEADER_BYTES + payload + ADS1293CodecEncoder::CRC_BYTES;
+			if ((buf_[2] >> 4) != ADS1293CodecEncoder::VERSION || channels == 0 || count == 0 ||
+				count > ADS1293CodecEncoder::MAX_FRAMES || expected_ > size_ ||
+				expected_ > ADS1293CodecEncoder::packetSize(count, channels))
+			{
+				resync();
+				continue;
+			}
+		}
+		if (pos_ < expected_)
+			return;
+		if (dispatch())
+		{
+			pos_ = 0;
+			expected_ = 0;
+		}
+		else
+		{
+			resync();
+		}
+	}
+}
+
+void ADS1293CodecDecoder::resync()
+{
+	size_t next = 1;
+	while (next < pos_ && buf_[next] != ADS1293CodecEncoder::SYNC1)
+		++next;
+	pos_ -= next;
+	memmove(buf_, buf_ + next, pos_);
+	expected_ = 0;
+}
+
+bool ADS1293CodecDecoder::dispatch()
+{
+	const size_t payloadEnd = expected_ - ADS1293CodecEncoder::CRC_BYTES;
+	const uint16_t crc = static_cast<uint16_t>(buf_[payloadEnd] | (buf_[payloadEnd + 1] << 8));
+	if (ADS1293StreamEncoder::crc16(buf_ + 2, payloadEnd - 2) != crc)
+	{
+		++crcErrors_;
+		return false;
+	}
+
+	// The CRC matched, so this was a packet: drop it whole.
+	const uint8_t mask = buf_[2] & 0x07u;
+	const uint8_t count = buf_[3];
+	if (!decodePayload(buf_ + ADS1293CodecEncoder::HEADER_BYTES, payloadEnd - ADS1293CodecEncoder::HEADER_BYTES, mask, count))
+	{
+		++formatErrors_;
+		return true;
+	}
+
+	uint16_t seq = static_cast<uint16_t>(buf_[4] | (buf_[5] << 8));
+	if (haveSeq_ && seq != nextSeq_)
+		lost_ += static_cast<uint16_t>(seq - nextSeq_);
+	haveSeq_ = true;
+	nextSeq_ = static_cast<uint16_t>(seq + count);
+
+	for (uint8_t f = 0; f < count; ++f, ++seq)
+	{
+		ADS1293::Samples s;
+		s.ch1 = x_[0][f];
+		s.ch2 = x_[1][f];
+		s.ch3 = x_[2][f];
+		s.ok = true;
+		++frames_;
+		if (handler_)
+			handler_(s, seq, ctx_);
+	}
+	return true;
+}
+
+namespace {
+// MSB-first reader with a left-aligned 32-bit window holding 25..32 valid
+// bits while input remains; bits past the end of the payload read as zero.
+struct BitReader {
+	const uint8_t *p;
+	const uint8_t *end;
+	uint32_t acc = 0;
+	int8_t bits = 0;
+	bool overrun = false;
+
+	BitReader(const uint8_t *data, size_t len) noexcept : p(data), end(data + len) { refill(); }
+
+	void refill() noexcept
+	{
+		while (bits <= 24 && p < end)
+		{
+			acc |= static_cast<uint32_t>(*p++) << (24 - bits);
+			bits = static_cast<int8_t>(bits + 8);
+		}
+	}
+
+	uint32_t get(uint8_t n) noexcept // n <= 24
+	{
+		if (n == 0)
+			return 0;
+		refill();
+		if (n > bits)
+			overrun = true;
+		const uint32_t v = acc >> (32 - n);
+		acc <<= n;
+		bits = static_cast<int8_t>(bits - n);
+		return v;
+	}
+
+	// Leading ones, at most `limit` (<= 24); consumes the terminating zero
+	// when it comes before the limit.
+	uint8_t ones(uint8_t limit) noexcept
+	{
+		refill();
+		const uint32_t inv = ~acc;
+		uint8_t q = inv ? static_cast<uint8_t>(__builtin_clzl(inv) - (sizeof(unsigned long) * 8 - 32)) : 32;
+		if (q >= limit)
+		{
+			get(limit);
+			return limit;
+		}
+		get(static_cast<uint8_t>(q + 1));
+		return q;
+	}
+};
+} // namespace
+
+bool ADS1293CodecDecoder::decodePayload(const uint8_t *p, size_t len, uint8_t mask, uint8_t count) noexcept
+{
+	BitReader in(p, len);
+	for (uint8_t c = 0; c < 3; ++c)
+	{
+		if (!(mask & (1u << c)))
+		{
+			for (uint8_t i = 0; i < count; ++i)
+				x_[c][i] = 0;
+			continue;
+		}
+		const uint8_t order = static_cast<uint8_t>(in.get(2));
+		const uint8_t ref = static_cast<uint8_t>(in.get(2));
+		const uint8_t k = static_cast<uint8_t>(in.get(5));
+		if (order > 2 || !referenceUsable(c, ref, mask) || (k > K_MAX && k != K_ZERO))
+			return false;
+
+		uint32_t first = (in.get(FIRST_BITS - 13) << 13) | in.get(13);
+		uint32_t s1 = static_cast<uint32_t>(static_cast<int32_t>(first << (32 - FIRST_BITS)) >> (32 - FIRST_BITS));
+		uint32_t s2 = 0;
+		uint32_t v = s1;
+		for (uint8_t i = 0;;)
+		{
+			// add the reference back (unsigned: wraps on corrupt input)
+			uint32_t x = v;
+			if (ref == 1)
+				x += static_cast<uint32_t>(x_[0][i]);
+			else if (ref == 2)
+				x += static_cast<uint32_t>(x_[1][i]);
+			else if (ref == 3)
+				x = x + static_cast<uint32_t>(x_[1][i]) - static_cast<uint32_t>(x_[0][i]);
+			x_[c][i] = static_cast<int32_t>(x);
+			if (++i == count)
+				break;
+
+			uint32_t u = 0;
+			if (k != K_ZERO)
+			{
+				const uint8_t q = in.ones(ADS1293CodecEncoder::ESCAPE);
+				if (q < ADS1293CodecEncoder::ESCAPE)
+				{
+					u = static_cast<uint32_t>(q) << k;
+					if (k > 16)
+						u |= in.get(static_cast<uint8_t>(k - 16)) << 16;
+					u |= in.get(k > 16 ? 16 : k);
+				}
+				else
+				{
+					u = (in.get(RAW_BITS - 14) << 14) | in.get(14);
+				}
+			}
+			const uint32_t r = (u >> 1) ^ (0u - (u & 1u));
+			const uint8_t o = i < order ? i : order;
+			v = (o == 0) ? r : (o == 1) ? r + s1 : r + 2u * s1 - s2;
+			s2 = s1;
+			s1 = v;
+		}
+	}
+	return !in.overrun;
+}
@@ -0,0 +1,161 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protocentral ADS1293 - lossless ECG compression
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//
+// Streaming lossless codec for the three 24-bit ECG channels, for logging
+// to flash/SD or sending over a radio link. Frames are collected in blocks
+// of up to MAX_FRAMES; each block is coded independently, so a lost or
+// corrupt packet costs only its own frames.
+//
+// Per block and channel the encoder picks the cheapest combination of
+//  - a reference channel subtracted first (inter-channel decorrelation):
+//    none, ch1, ch2 or ch2 - ch1. With 3-lead wiring lead III = II - I, so
+//    ch3 - (ch2 - ch1) is close to noise;
+//  - a fixed polynomial predictor of order 0, 1 (delta) or 2 (linear);
+// and codes the prediction residuals with a Rice code whose parameter is
+// derived from their mean magnitude. The search is a fixed number of passes
+// over the block and every code word is at most MAX_CODE_BITS long, so the
+// encode time per block is bounded and does not depend on the signal.
+//
+// Packets use the framing of protocentral_ads1293_stream.h with version 2
+// and a payload length (multi-byte fields little-endian):
+//
+//   offset  size        field
+//   0       1           0xA5 sync
+//   1       1           0x5A sync
+//   2       1           bits 0..2: channel mask (ch1..ch3), bits 4..7: version (2)
+//   3       1           frame count N (1..MAX_FRAMES)
+//   4       2           sequence number of the first frame in the packet
+//   6       2           payload length L
+//   8       L           coded channels, bit-packed MSB first, padded to a byte
+//   8+L     2           CRC-16/CCITT-FALSE over bytes 2 .. end of payload
+//
+// Each channel in the mask is coded as: predictor order (2 bits), reference
+// (2 bits), Rice parameter k (5 bits; 31 = all residuals zero), the first
+// predicted value as 26-bit two's complement, then N-1 residuals. Residual i
+// uses order min(order, i). A residual is zigzag-mapped to u and coded as
+// u >> k in unary (ones, then a zero) followed by the k low bits; when
+// u >> k reaches ESCAPE the code is ESCAPE ones followed by u in 28 bits.
+//
+// A simulated 3-lead ECG with a few codes of noise compresses to about 2.6-3
+// bytes per frame with 32-frame blocks and 3.6 with AVR's 16-frame blocks,
+// against 12 bytes for raw int32 triples (Example 3); see Example 8.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "protocentral_ads1293.h"
+
+class ADS1293CodecEncoder {
+public:
+  static constexpr uint8_t SYNC1 = 0xA5;
+  static constexpr uint8_t SYNC2 = 0x5A;
+  static constexpr uint8_t VERSION = 2;
+  static constexpr uint8_t HEADER_BYTES = 8;
+  static constexpr uint8_t CRC_BYTES = 2;
+
+  // Largest block the format allows, and the largest this encoder buffers
+  // (the raw block is kept in RAM: 12 bytes per frame).
+  static constexpr uint8_t MAX_FRAMES = 32;
+#if defined(__AVR__)
+  static constexpr uint8_t ENCODER_FRAMES = 16;
+#else
+  static constexpr uint8_t ENCODER_FRAMES = MAX_FRAMES;
+#endif
+
+  static constexpr uint8_t ESCAPE = 15;
+  static constexpr uint8_t CHANNEL_HEADER_BITS = 2 + 2 + 5 + 26;
+  static constexpr uint8_t MAX_CODE_BITS = ESCAPE + 28;
+
+  // Worst-case packet size for `frames` frames with `channels` channels.
+  static constexpr size_t packetSize(uint8_t frames, uint8_t channels)
+  {
+    return HEADER_BYTES +
+           (static_cast<size_t>(channels) * (CHANNEL_HEADER_BITS + (frames - 1u) * static_cast<size_t>(MAX_CODE_BITS)) + 7u) / 8u +
+           CRC_BYTES;
+  }
+
+  // `buffer` holds one coded packet; its size sets the number of frames per
+  // block (the largest whose worst case fits, up to ENCODER_FRAMES).
+  // `channelMask` selects which of ch1..ch3 are coded (bit 0 = ch1), e.g.
+  // 0x03 for 3-lead data; decorrelation only uses channels in the mask.
+  ADS1293CodecEncoder(Print &out, uint8_t *buffer, size_t bufferSize, uint8_t channelMask = 0x07) noexcept;
+
+  // Append one frame. Samples are taken as 24-bit two's complement, as read
+  // from the device. When the block is full it is coded and sent with a
+  // single Print::write(). Returns false if the encoder has no usable buffer.
+  bool add(const ADS1293::Samples &s);
+
+  // Append a block of frames; returns the number accepted.
+  size_t add(const ADS1293::Samples *frames, size_t count);
+
+  // Code and send a partially filled block, if any.
+  bool flush();
+
+  // Account for frames lost before they reached the encoder, as in
+  // ADS1293StreamEncoder::skipFrames().
+  void skipFrames(uint16_t count);
+
+  uint16_t sequence() const noexcept { return seq_; }
+  uint8_t framesPerBlock() const noexcept { return capacity_; }
+  uint32_t packetsSent() const noexcept { return packets_; }
+  uint32_t framesEncoded() const noexcept { return frames_; }
+  uint32_t bytesWritten() const noexcept { return bytes_; }
+
+private:
+  Print &out_;
+  uint8_t *buf_;
+  uint8_t mask_;
+  uint8_t capacity_ = 0;
+  uint8_t count_ = 0;
+  uint16_t seq_ = 0; // sequence number of the next frame
+  uint32_t packets_ = 0;
+  uint32_t frames_ = 0;
+  uint32_t bytes_ = 0;
+  int32_t x_[3][ENCODER_FRAMES];
+
+  void encodeChannel(uint8_t c, uint8_t *&out, uint32_t &acc, uint8_t &bits) const noexcept;
+};
+
+class ADS1293CodecDecoder {
+public:
+  // Called for each frame of a packet that passed the CRC check, as for
+  // ADS1293StreamDecoder. Channels not present in the packet are 0.
+  typedef void (*FrameHandler)(const ADS1293::Samples &s, uint16_t seq, void *context);
+
+  // `buffer` must hold the largest packet expected (see
+  // ADS1293CodecEncoder::packetSize()).
+  ADS1293CodecDecoder(uint8_t *buffer, size_t bufferSize, FrameHandler handler, void *context = nullptr) noexcept;
+
+  // Feed received bytes in any chunking. Resynchronizes after corrupt or
+  // truncated packets and false syncs the same way ADS1293StreamDecoder
+  // does, rescanning from the byte after the rejected sync.
+  void feed(uint8_t byte);
+  void feed(const uint8_t *data, size_t len);
+
+  uint32_t framesDecoded() const noexcept { return frames_; }
+  uint32_t framesLost() const noexcept { return lost_; }         // sequence gaps
+  uint32_t crcErrors() const noexcept { return crcErrors_; }
+  uint32_t formatErrors() const noexcept { return formatErrors_; } // CRC passed, payload invalid
+
+private:
+  uint8_t *buf_;
+  size_t size_;
+  FrameHandler handler_;
+  void *ctx_;
+  size_t pos_ = 0;
+  size_t expected_ = 0;
+  bool haveSeq_ = false;
+  uint16_t nextSeq_ = 0;
+  uint32_t frames_ = 0;
+  uint32_t lost_ = 0;
+  uint32_t crcErrors_ = 0;
+  uint32_t formatErrors_ = 0;
+  int32_t x_[3][ADS1293CodecEncoder::MAX_FRAMES];
+
+  bool dispatch();
+  void resync();
+  bool decodePayload(const uint8_t *p, size_t len, uint8_t mask, uint8_t count) noexcept;
+};
@@ -0,0 +1,188 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protocentral ADS1293 - frame dispatch to several consumers
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include "protocentral_ads1293_dispatch.h"
+
+ADS1293Dispatcher::ADS1293Dispatcher(ADS1293 &dev, ADS1293::Samples *buffer, uint16_t depth) noexcept
+	: dev_(dev), buf_(buffer), depth_(depth), mask_(static_cast<uint16_t>(depth - 1u))
+{
+	if (!buffer || depth < 2 || (depth & (depth - 1u)) != 0)
+	{
+		buf_ = nullptr;
+		depth_ = 0;
+		mask_ = 0;
+	}
+}
+
+int8_t ADS1293Dispatcher::subscribe(BlockHandler handler, void *context) noexcept
+{
+	if (!buf_)
+		return -1;
+	for (int8_t id = 0; id < MAX_SINKS; ++id)
+	{
+		Sink &s = sinks_[id];
+		if (s.active)
+			continue;
+		s.handler = handler;
+		s.ctx = context;
+		s.cursor = head_;
+		s.dropped = 0;
+		s.missedBase = missed_;
+		s.active = true;
+		return id;
+	}
+	return -1;
+}
+
+void ADS1293Dispatcher::unsubscribe(int8_t id) noexcept
+{
+	if (valid(id))
+		sinks_[id] = Sink();
+}
+
+uint8_t ADS1293Dispatcher::sinks() const noexcept
+{
+	uint8_t n = 0;
+	for (uint8_t id = 0; id < MAX_SINKS; ++id)
+		if (sinks_[id].active)
+			++n;
+	return n;
+}
+
+size_t ADS1293Dispatcher::poll()
+{
+	if (!buf_)
+		return 0;
+	// Read straight into the free-running slots after head_; a single call
+	// never laps the buffer, so push sinks see every frame.
+	size_t total = 0;
+	bool missed = false;
+	while (total < depth_)
+	{
+		const uint16_t slot = static_cast<uint16_t>((head_ + total) & mask_);
+		size_t span = static_cast<size_t>(depth_ - slot);
+		if (span > depth_ - total)
+			span = depth_ - total;
+		bool m = false;
+		const size_t n = dev_.readFrames(buf_ + slot, span, &m);
+		missed |= m;
+		total += n;
+		if (n < span)
+			break;
+	}
+	// counted before the handlers run, so they see it with the new frames
+	if (missed)
+		++missed_;
+	commit(total);
+	return total;
+}
+
+size_t ADS1293Dispatcher::publish(const ADS1293::Samples *frames, size_t count, bool missed)
+{
+	if (!buf_ || !frames)
+		return 0;
+	if (missed)
+		++missed_;
+	// In chunks of at most depth_, so push sinks see every frame.
+	size_t done = 0;
+	while (done < count)
+	{
+		const uint16_t slot = static_cast<uint16_t>(head_ & mask_);
+		size_t n = count - done;
+		if (n > depth_)
+			n = depth_;
+		size_t first = static_cast<size_t>(depth_ - slot);
+		if (first > n)
+			first = n;
+		memcpy(buf_ + slot, frames + done, first * sizeof(*frames));
+		memcpy(buf_, frames + done + first, (n - first) * sizeof(*frames));
+		commit(n);
+		done += n;
+	}
+	return count;
+}
+
+void ADS1293Dispatcher::commit(size_t count)
+{
+	if (count == 0)
+		return;
+	const uint32_t head = head_ + static_cast<uint32_t>(count);
+
+	// Pull sinks more than depth_ behind lose their oldest frames.
+	for (uint8_t id = 0; id < MAX_SINKS; ++id)
+	{
+		Sink &s = sinks_[id];
+		if (!s.active || s.handler)
+			continue;
+		uint32_t backlog = head - s.cursor;
+		if (backlog > depth_)
+		{
+			s.dropped += backlog - depth_;
+			s.cursor = head - depth_;
+			backlog = depth_;
+		}
+		if (backlog > maxBacklog_)
+			maxBacklog_ = static_cast<uint16_t>(backlog);
+	}
+	head_ = head;
+
+	// Push sinks are always caught up, so their new frames are the last
+	// `count` ones: one block, or two when they wrap. A handler may
+	// (un)subscribe; new sinks start at head_ and receive nothing here.
+	for (uint8_t id = 0; id < MAX_SINKS; ++id)
+	{
+		Sink &s = sinks_[id];
+		while (s.active && s.handler && s.cursor != head_)
+		{
+			const uint16_t slot = static_cast<uint16_t>(s.cursor & mask_);
+			size_t run = static_cast<size_t>(head_ - s.cursor);
+			if (run > static_cast<size_t>(depth_ - slot))
+				run = depth_ - slot;
+			s.cursor += static_cast<uint32_t>(run);
+			s.handler(buf_ + slot, run, s.ctx);
+		}
+	}
+}
+
+size_t ADS1293Dispatcher::available(int8_t id) const noexcept
+{
+	return valid(id) ? static_cast<size_t>(head_ - sinks_[id].cursor) : 0;
+}
+
+size_t ADS1293Dispatcher::peek(int8_t id, const ADS1293::Samples *&frames) const noexcept
+{
+	frames = nullptr;
+	if (!valid(id))
+		return 0;
+	const Sink &s = sinks_[id];
+	const uint16_t slot = static_cast<uint16_t>(s.cursor & mask_);
+	size_t run = static_cast<size_t>(head_ - s.cursor);
+	if (run > static_cast<size_t>(depth_ - slot))
+		run = depth_ - slot;
+	if (run)
+		frames = buf_ + slot;
+	return run;
+}
+
+void ADS1293Dispatcher::consume(int8_t id, size_t count) noexcept
+{
+	if (!valid(id))
+		return;
+	Sink &s = sinks_[id];
+	const size_t avail = static_cast<size_t>(head_ - s.cursor);
+	s.cursor += static_cast<uint32_t>(count < avail ? count : avail);
+}
+
+uint32_t ADS1293Dispatcher::dropped(int8_t id) const noexcept
+{
+	return valid(id) ? sinks_[id].dropped : 0;
+}
+
+uint32_t ADS1293Dispatcher::missed(int8_t id) const noexcept
+{
+	return valid(id) ? missed_ - sinks_[id].missedBase : 0;
+}
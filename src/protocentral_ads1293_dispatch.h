@@ -0,0 +1,102 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protocentral ADS1293 - frame dispatch to several consumers
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//
+// ADS1293Dispatcher lets several parts of a sketch (logger, radio, QRS
+// detection, display) consume the same frames without each one polling the
+// device. poll() reads whatever the device has (readFrames(), so the
+// acquisition ring, the polled path and an attached filter work as usual)
+// directly into one shared history buffer, then hands the new frames to
+// every subscribed sink. Frames are stored once; sinks see pointers into the
+// shared buffer, never per-subscriber copies.
+//
+// Each sink has its own read cursor:
+//  - push sinks register a BlockHandler and are called from poll() with the
+//    new frames as at most two contiguous blocks (the buffer wraps);
+//  - pull sinks have no handler and read at their own pace with peek() and
+//    consume(). The writer never waits for them: a pull sink that falls more
+//    than `depth` frames behind has its cursor moved to the oldest frame
+//    still held and the skipped frames counted in dropped(). Slow consumers
+//    therefore cost only themselves.
+//
+// Frames the device or the acquisition ring lost before they reached the
+// dispatcher (readFrames()' `missed`) are counted for every sink in
+// missed(), by the time its handler sees the frames after the gap; the
+// gap itself shows in Samples::index.
+//
+// Everything runs in the caller's context (typically loop()); pointers
+// returned by peek() stay valid until the next poll() or publish().
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "protocentral_ads1293.h"
+
+class ADS1293Dispatcher {
+public:
+  static constexpr uint8_t MAX_SINKS = 8;
+
+  typedef void (*BlockHandler)(const ADS1293::Samples *frames, size_t count, void *context);
+
+  // `buffer` of `depth` Samples (a power of two, 2..32768) holds the shared
+  // history. It is not copied and must outlive the dispatcher.
+  ADS1293Dispatcher(ADS1293 &dev, ADS1293::Samples *buffer, uint16_t depth) noexcept;
+
+  // Add a sink; returns its id (0..MAX_SINKS-1) or -1 when full or the
+  // buffer is invalid. A new sink starts at the next frame. With `handler`
+  // nullptr the sink is a pull sink.
+  int8_t subscribe(BlockHandler handler, void *context = nullptr) noexcept;
+  int8_t subscribe() noexcept { return subscribe(nullptr); }
+  void unsubscribe(int8_t id) noexcept;
+
+  // Read all frames the device has (at most `depth` per call), store them
+  // and dispatch them to the push sinks. Returns the number of new frames.
+  size_t poll();
+
+  // Store and dispatch frames obtained elsewhere, e.g. from captureFrames()
+  // or ADS1293Group; `missed` as for ADS1293::readFrames(), when frames
+  // were lost before these. Returns `count`.
+  size_t publish(const ADS1293::Samples *frames, size_t count, bool missed = false);
+
+  // Pull sinks: frames waiting for `id`, and the oldest contiguous run of
+  // them (sets `frames`, returns its length; call again after consume() to
+  // get the part after the wrap). consume() advances the cursor.
+  size_t available(int8_t id) const noexcept;
+  size_t peek(int8_t id, const ADS1293::Samples *&frames) const noexcept;
+  void consume(int8_t id, size_t count) noexcept;
+
+  // Frames sink `id` lost because it fell behind (pull sinks only).
+  uint32_t dropped(int8_t id) const noexcept;
+  // Losses upstream of the dispatcher (readFrames() reported `missed`)
+  // since sink `id` subscribed, push and pull sinks alike.
+  uint32_t missed(int8_t id) const noexcept;
+  // Frames stored since construction; also the position of the next frame.
+  uint32_t framesPublished() const noexcept { return head_; }
+  // Largest backlog seen on any pull sink, in frames.
+  uint16_t maxBacklog() const noexcept { return maxBacklog_; }
+  uint8_t sinks() const noexcept;
+
+private:
+  struct Sink {
+    BlockHandler handler = nullptr;
+    void *ctx = nullptr;
+    uint32_t cursor = 0;
+    uint32_t dropped = 0;
+    uint32_t missedBase = 0; // missed_ when subscribed
+    bool active = false;
+  };
+
+  ADS1293 &dev_;
+  ADS1293::Samples *buf_;
+  uint16_t depth_;
+  uint16_t mask_;
+  uint32_t head_ = 0; // free-running; buffer slot is head_ & mask_
+  uint16_t maxBacklog_ = 0;
+  uint32_t missed_ = 0;
+  Sink sinks_[MAX_SINKS];
+
+  bool valid(int8_t id) const noexcept { return id >= 0 && id < MAX_SINKS && sinks_[id].active; }
+  void commit(size_t count);
+};
@@ -0,0 +1,286 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protocentral ADS1293 - streaming digital filters (implementation)
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include "protocentral_ads1293_filter.h"
+
+static constexpr double Q30 = 1073741824.0;
+
+static int32_t toQ30(double v) noexcept
+{
+	v *= Q30;
+	return static_cast<int32_t>(v < 0 ? v - 0.5 : v + 0.5);
+}
+
+// Normalize by a0 and store in Q30.
+static void storeCoefficients(ADS1293Biquad &bq, double b0, double b1, double b2, double a0, double a1, double a2)
+{
+	bq.b0 = toQ30(b0 / a0);
+	bq.b1 = toQ30(b1 / a0);
+	bq.b2 = toQ30(b2 / a0);
+	bq.a1 = toQ30(a1 / a0);
+	bq.a2 = toQ30(a2 / a0);
+}
+
+static bool prewarp(float fs, float fc, float q, double &cw, double &alpha)
+{
+	if (fs <= 0.0f || fc <= 0.0f || fc >= fs * 0.5f || q <= 0.0f)
+		return false;
+	const double w0 = 2.0 * M_PI * fc / fs;
+	cw = cos(w0);
+	alpha = sin(w0) / (2.0 * q);
+	return true;
+}
+
+bool ADS1293Biquad::designLowPass(float fs, float fc, float q)
+{
+	double cw, alpha;
+	if (!prewarp(fs, fc, q, cw, alpha))
+		return false;
+	storeCoefficients(*this, (1.0 - cw) / 2.0, 1.0 - cw, (1.0 - cw) / 2.0, 1.0 + alpha, -2.0 * cw, 1.0 - alpha);
+	return true;
+}
+
+bool ADS1293Biquad::designHighPass(float fs, float fc, float q)
+{
+	double cw, alpha;
+	if (!prewarp(fs, fc, q, cw, alpha))
+		return false;
+	storeCoefficients(*this, (1.0 + cw) / 2.0, -(1.0 + cw), (1.0 + cw) / 2.0, 1.0 + alpha, -2.0 * cw, 1.0 - alpha);
+	return true;
+}
+
+bool ADS1293Biquad::designNotch(float fs, float f0, float q)
+{
+	double cw, alpha;
+	if (!prewarp(fs, f0, q, cw, alpha))
+		return false;
+	storeCoefficients(*this, 1.0, -2.0 * cw, 1.0, 1.0 + alpha, -2.0 * cw, 1.0 - alpha);
+	return true;
+}
+
+bool ADS1293FilterChain::configure(float fs, const ADS1293FilterConfig &cfg)
+{
+	clear();
+	ADS1293Biquad bq;
+	bool ok = true;
+	if (cfg.highPassHz > 0.0f)
+		ok &= bq.designHighPass(fs, cfg.highPassHz) && addStage(bq);
+	if (cfg.notchHz > 0.0f)
+		ok &= bq.designNotch(fs, cfg.notchHz, cfg.notchQ) && addStage(bq);
+	if (cfg.lowPassHz > 0.0f)
+		ok &= bq.designLowPass(fs, cfg.lowPassHz) && addStage(bq);
+	return ok;
+}
+
+bool ADS1293FilterChain::configure(ADS1293::SamplingRate rate, const ADS1293FilterConfig &cfg)
+{
+	return configure(ADS1293::samplingRateHz(rate), cfg);
+}
+
+bool ADS1293FilterChain::addStage(const ADS1293Biquad &bq)
+{
+	if (stages_ >= MAX_STAGES)
+		return false;
+	coef_[stages_] = bq;
+	for (uint8_t c = 0; c < 3; ++c)
+		state_[c][stages_] = State();
+	++stages_;
+	return true;
+}
+
+void ADS1293FilterChain::clear() noexcept
+{
+	stages_ = 0;
+	reset();
+}
+
+void ADS1293FilterChain::reset() noexcept
+{
+	for (uint8_t c = 0; c < 3; ++c)
+		for (uint8_t i = 0; i < MAX_STAGES; ++i)
+			state_[c][i] = State();
+}
+
+int32_t ADS1293FilterChain::process(uint8_t channel, int32_t x) noexcept
+{
+	if (channel > 2)
+		return x;
+	State *st = state_[channel];
+	for (uint8_t i = 0; i < stages_; ++i)
+	{
+		// Direct form I: the state holds plain input/output samples, so the
+		// Q30 products never feed back rounding error through the state.
+		const ADS1293Biquad &c = coef_[i];
+		State &z = st[i];
+		int64_t acc = static_cast<int64_t>(c.b0) * x +
+					  static_cast<int64_t>(c.b1) * z.x1 +
+					  static_cast<int64_t>(c.b2) * z.x2 -
+					  static_cast<int64_t>(c.a1) * z.y1 -
+					  static_cast<int64_t>(c.a2) * z.y2;
+		const int32_t y = static_cast<int32_t>((acc + (1LL << 29)) >> 30);
+		z.x2 = z.x1;
+		z.x1 = x;
+		z.y2 = z.y1;
+		z.y1 = y;
+		x = y;
+	}
+	return x;
+}
+
+void ADS1293FilterChain::process(ADS1293::Samples &s) noexcept
+{
+	s.ch1 = process(0, s.ch1);
+	s.ch2 = process(1, s.ch2);
+	s.ch3 = process(2, s.ch3);
+}
+
+void ADS1293FilterChain::processBlock(ADS1293::Samples *frames, size_t n) noexcept
+{
+	for (size_t i = 0; i < n; ++i)
+		process(frames[i]);
+}
+
+void ADS1293FilterChain::processBlock(uint8_t channel, int32_t *samples, size_t n) noexcept
+{
+	for (size_t i = 0; i < n; ++i)
+		samples[i] = process(channel, samples[i]);
+}
+
+// Hamming-windowed sinc, tap i of n, cutoff fc in cycles per sample.
+static double prototypeTap(uint16_t i, uint16_t n, double fc)
+{
+	const double t = i - (n - 1) / 2.0;
+	const double sinc = (t == 0.0) ? 2.0 * fc : sin(2.0 * M_PI * fc * t) / (M_PI * t);
+	return sinc * (0.54 - 0.46 * cos(2.0 * M_PI * i / (n - 1)));
+}
+
+bool ADS1293Resampler::configure(float inHz, uint8_t L, uint16_t M)
+{
+	l_ = 0;
+	if (inHz <= 0.0f || L == 0 || L > MAX_PHASES || M <= L || M > 1024)
+		return false;
+
+	// Prototype low-pass at the upsampled rate, cut off just below the output
+	// Nyquist frequency and scaled to a DC gain of L so that every polyphase
+	// branch has unity gain. Taps are evaluated twice (sum, then store)
+	// rather than buffered, to keep the stack small.
+	const uint16_t n = static_cast<uint16_t>(L) * TAPS;
+	const double fc = 0.45 / M;
+	double sum = 0.0;
+	for (uint16_t i = 0; i < n; ++i)
+		sum += prototypeTap(i, n, fc);
+	for (uint8_t p = 0; p < L; ++p)
+	{
+		for (uint8_t j = 0; j < TAPS; ++j)
+		{
+			double v = prototypeTap(static_cast<uint16_t>(p + j * L), n, fc) * L / sum * 32768.0;
+			v = v < 0 ? v - 0.5 : v + 0.5;
+			if (v > 32767.0)
+				v = 32767.0;
+			else if (v < -32768.0)
+				v = -32768.0;
+			coef_[p * TAPS + j] = static_cast<int16_t>(v);
+		}
+	}
+
+	l_ = L;
+	m_ = M;
+	inPeriodNs_ = static_cast<uint32_t>(1e9f / inHz + 0.5f);
+	outHz_ = inHz * L / M;
+	reset();
+	return true;
+}
+
+bool ADS1293Resampler::configure(float inHz, float outHz)
+{
+	if (inHz <= 0.0f || outHz <= 0.0f || outHz >= inHz)
+		return false;
+	uint8_t bestL = 0;
+	uint16_t bestM = 0;
+	float bestErr = 0.0f;
+	for (uint8_t L = 1; L <= MAX_PHASES; ++L)
+	{
+		const float m = inHz * L / outHz;
+		if (m > 1024.0f)
+			break;
+		const uint16_t M = static_cast<uint16_t>(m + 0.5f);
+		if (M <= L)
+			continue;
+		const float err = fabsf(inHz * L / M - outHz);
+		if (bestL == 0 || err < bestErr)
+		{
+			bestL = L;
+			bestM = M;
+			bestErr = err;
+		}
+	}
+	return bestL != 0 && configure(inHz, bestL, bestM);
+}
+
+bool ADS1293Resampler::configure(ADS1293::SamplingRate rate, float outHz)
+{
+	return configure(ADS1293::samplingRateHz(rate), outHz);
+}
+
+void ADS1293Resampler::reset() noexcept
+{
+	for (uint8_t c = 0; c < 3; ++c)
+		for (uint8_t j = 0; j < TAPS; ++j)
+			hist_[c][j] = 0;
+	pos_ = 0;
+	phase_ = 0;
+	index_ = 0;
+}
+
+size_t ADS1293Resampler::process(const ADS1293::Samples *in, size_t n, ADS1293::Samples *out) noexcept
+{
+	if (l_ == 0 || !in || !out)
+		return 0;
+
+	size_t produced = 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		hist_[0][pos_] = in[i].ch1;
+		hist_[1][pos_] = in[i].ch2;
+		hist_[2][pos_] = in[i].ch3;
+		pos_ = static_cast<uint8_t>((pos_ + 1) & (TAPS - 1));
+
+		// With L < M there is at most one output per input sample.
+		if (phase_ < l_)
+		{
+			const int16_t *h = coef_ + phase_ * TAPS;
+			int64_t acc[3] = {0, 0, 0};
+			uint8_t k = pos_;
+			for (uint8_t j = 0; j < TAPS; ++j)
+			{
+				k = static_cast<uint8_t>((k - 1) & (TAPS - 1)); // newest first
+				acc[0] += static_cast<int64_t>(h[j]) * hist_[0][k];
+				acc[1] += static_cast<int64_t>(h[j]) * hist_[1][k];
+				acc[2] += static_cast<int64_t>(h[j]) * hist_[2][k];
+			}
+			// The output sits phase_/L input periods after in[i]. Each field
+			// reads in[i] before its own write, so `out` may alias `in`.
+			ADS1293::Samples &s = out[produced++];
+			const uint32_t offsetNs = static_cast<uint32_t>(phase_) * (inPeriodNs_ / l_);
+			s.status = in[i].status;
+			s.leadOff = in[i].leadOff;
+			s.errors = in[i].errors;
+			s.pace1 = in[i].pace1;
+			s.pace2 = in[i].pace2;
+			s.pace3 = in[i].pace3;
+			s.timestampUs = in[i].timestampUs + (offsetNs + 500u) / 1000u;
+			s.index = index_++;
+			s.ch1 = static_cast<int32_t>((acc[0] + (1 << 14)) >> 15);
+			s.ch2 = static_cast<int32_t>((acc[1] + (1 << 14)) >> 15);
+			s.ch3 = static_cast<int32_t>((acc[2] + (1 << 14)) >> 15);
+			s.ok = true;
+			phase_ = static_cast<uint16_t>(phase_ + m_);
+		}
+		phase_ = static_cast<uint16_t>(phase_ - l_);
+	}
+	return produced;
+}
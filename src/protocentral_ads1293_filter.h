@@ -0,0 +1,143 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protocentral ADS1293 - streaming digital filters
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//
+// Fixed-point IIR filtering of acquired ECG samples: baseline-wander
+// high-pass, mains notch (50/60 Hz) and anti-noise low-pass, built as a
+// cascade of biquads with per-channel state. Coefficients are designed in
+// floating point once, at configuration time; per-sample processing is
+// integer only (Q30 coefficients, 64-bit accumulator) with a fixed cost and
+// no heap allocation.
+//
+// ADS1293Resampler derives a lower-rate stream (e.g. 250 or 100 SPS
+// telemetry) from the acquired high-rate stream with a polyphase FIR, so one
+// acquisition can feed consumers at several rates.
+//
+// The 64-bit multiplies are cheap on 32-bit cores (Cortex-M, ESP32, RP2040).
+// On 8-bit AVR keep the stage count and sampling rate modest.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "protocentral_ads1293.h"
+
+// One second-order section in Q30: y = b0*x + b1*x1 + b2*x2 - a1*y1 - a2*y2
+struct ADS1293Biquad {
+  int32_t b0 = 1L << 30;
+  int32_t b1 = 0;
+  int32_t b2 = 0;
+  int32_t a1 = 0;
+  int32_t a2 = 0;
+
+  // RBJ audio-EQ-cookbook designs. Return false if the corner frequency is
+  // not strictly between 0 and fs/2.
+  bool designLowPass(float fs, float fc, float q = 0.7071f);
+  bool designHighPass(float fs, float fc, float q = 0.7071f);
+  bool designNotch(float fs, float f0, float q = 30.0f);
+};
+
+struct ADS1293FilterConfig {
+  float highPassHz = 0.5f; // baseline wander removal, 0 = off
+  float lowPassHz = 40.0f; // 0 = off
+  float notchHz = 50.0f;   // mains frequency (50 or 60), 0 = off
+  float notchQ = 30.0f;
+};
+
+class ADS1293FilterChain {
+public:
+  static constexpr uint8_t MAX_STAGES = 4;
+
+  // Build the cascade for sample rate `fs` (Hz). Stages whose frequency
+  // does not fit below fs/2 are rejected and make configure() return false
+  // (e.g. a 60 Hz notch at 100 SPS). Resets the filter state.
+  bool configure(float fs, const ADS1293FilterConfig &cfg);
+
+  // Same, taking the rate from an ADS1293 sampling-rate preset.
+  bool configure(ADS1293::SamplingRate rate, const ADS1293FilterConfig &cfg);
+
+  // Append a custom section. Returns false if the cascade is full.
+  bool addStage(const ADS1293Biquad &bq);
+
+  void clear() noexcept;
+  void reset() noexcept; // clear state, keep coefficients
+  uint8_t stages() const noexcept { return stages_; }
+
+  // Filter one sample of channel 0..2.
+  int32_t process(uint8_t channel, int32_t x) noexcept;
+
+  // Filter all three channels of one frame, or a block of frames in place.
+  void process(ADS1293::Samples &s) noexcept;
+  void processBlock(ADS1293::Samples *frames, size_t n) noexcept;
+
+  // Filter a contiguous block of one channel in place.
+  void processBlock(uint8_t channel, int32_t *samples, size_t n) noexcept;
+
+private:
+  struct State {
+    int32_t x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+  };
+  ADS1293Biquad coef_[MAX_STAGES];
+  State state_[3][MAX_STAGES];
+  uint8_t stages_ = 0;
+};
+
+// Rational L/M sample-rate converter for downsampling (L <= M): conceptually
+// upsample by L, low-pass, keep every M-th sample. Only the polyphase branch
+// that produces an output is evaluated, so the cost is TAPS multiplies per
+// channel per *output* sample. All three channels share one phase, so frames
+// stay aligned.
+//
+// The filter spans TAPS input samples. Ratios above ~8:1 are better done in
+// two stages (e.g. 1600 -> 400 -> 100) by feeding one resampler's output
+// into another.
+class ADS1293Resampler {
+public:
+#if defined(__AVR__)
+  static constexpr uint8_t MAX_PHASES = 4; // largest L
+  static constexpr uint8_t TAPS = 16;      // taps per phase, power of two
+#else
+  static constexpr uint8_t MAX_PHASES = 8;
+  static constexpr uint8_t TAPS = 32;
+#endif
+
+  // Convert by exactly L/M (1 <= L <= MAX_PHASES, L < M). inHz is the input
+  // rate and only sets the reported output rate.
+  bool configure(float inHz, uint8_t L, uint16_t M);
+
+  // Pick the closest L/M for inHz -> outHz (outHz < inHz). The rate actually
+  // produced is reported by outputRateHz().
+  bool configure(float inHz, float outHz);
+
+  // Same, taking the input rate from an ADS1293 sampling-rate preset, i.e.
+  // fs / (R1 * R2 * R3). For a running device pass getOutputDataRate().
+  bool configure(ADS1293::SamplingRate rate, float outHz);
+
+  void reset() noexcept; // clear history, keep the design
+
+  // Consume `n` input frames and write the resulting output frames (at most
+  // n) to `out`. Returns the number written. `in` and `out` may alias.
+  // Output frames carry the output clock: `index` counts outputs since
+  // configure() or reset(), `timestampUs` is the instant the output stands
+  // for, between the input timestamps. The FIR delays the signal by
+  // (L * TAPS - 1) / (2 * L) input periods; the timestamp does not take
+  // that out. Status, lead-off, error and pace fields are those of the
+  // input frame nearest that instant (the one that completed the output).
+  size_t process(const ADS1293::Samples *in, size_t n, ADS1293::Samples *out) noexcept;
+
+  uint8_t interpolation() const noexcept { return l_; }
+  uint16_t decimation() const noexcept { return m_; }
+  float outputRateHz() const noexcept { return outHz_; }
+
+private:
+  int16_t coef_[MAX_PHASES * TAPS] = {}; // Q15, phase-major
+  int32_t hist_[3][TAPS] = {};
+  uint8_t pos_ = 0;    // next history slot
+  uint8_t l_ = 0;      // 0 = not configured
+  uint16_t m_ = 1;
+  uint16_t phase_ = 0; // position of the next output, in 1/L input samples
+  uint32_t index_ = 0; // outputs since reset()
+  uint32_t inPeriodNs_ = 0;
+  float outHz_ = 0.0f;
+};
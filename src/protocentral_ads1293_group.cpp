@@ -0,0 +1,188 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protocentral ADS1293 - several devices on one SPI bus (implementation)
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include "protocentral_ads1293_group.h"
+
+// OSC_CN bits
+static constexpr uint8_t OSC_STRTCLK = 0x04;
+static constexpr uint8_t OSC_SHDN_OSC = 0x02;
+static constexpr uint8_t OSC_EN_CLKOUT = 0x01;
+
+// SYNCB_CN: bit 6 DIS_SYNCBOUT, bits 3..5 select CHn ECG as SYNCB source
+static constexpr uint8_t SYNCB_INPUT = 0x40;
+static constexpr uint8_t SYNCB_SRC_ECG1 = 0x08;
+
+static inline bool writeOne(ADS1293 &dev, Register reg, uint8_t value)
+{
+	return dev.writeRegisters(reg, &value, 1);
+}
+
+bool ADS1293Group::add(ADS1293 &dev)
+{
+	if (count_ >= MAX_DEVICES || !dev.getSPI() || dev.acquisitionActive())
+		return false;
+	if (count_ && dev.getSPI() != dev_[0]->getSPI())
+		return false;
+	for (uint8_t i = 0; i < count_; ++i)
+		if (dev_[i] == &dev)
+			return false;
+	dev_[count_++] = &dev;
+	return true;
+}
+
+bool ADS1293Group::synchronize(uint8_t syncChannel, bool sharedClock)
+{
+	if (count_ == 0 || syncChannel < 1 || syncChannel > 3)
+		return false;
+
+	bool ok = true;
+	for (uint8_t i = 0; i < count_; ++i)
+		ok &= writeOne(*dev_[i], Register::CONFIG, 0x00);
+
+	ADS1293 &master = *dev_[0];
+	if (sharedClock)
+		ok &= writeOne(master, Register::OSC_CN, OSC_STRTCLK | OSC_EN_CLKOUT);
+	ok &= writeOne(master, Register::SYNCB_CN, static_cast<uint8_t>(SYNCB_SRC_ECG1 << (syncChannel - 1)));
+
+	for (uint8_t i = 1; i < count_; ++i)
+	{
+		if (sharedClock)
+		{
+			// Select the CLK pin as input before starting the clock, as the
+			// datasheet requires for a clean start.
+			ok &= writeOne(*dev_[i], Register::OSC_CN, OSC_SHDN_OSC);
+			ok &= writeOne(*dev_[i], Register::OSC_CN, OSC_STRTCLK | OSC_SHDN_OSC);
+		}
+		ok &= writeOne(*dev_[i], Register::SYNCB_CN, SYNCB_INPUT);
+	}
+
+	const float odr = master.getOutputDataRate(syncChannel);
+	periodUs_ = odr > 0.0f ? static_cast<uint32_t>(1000000.0f / odr + 0.5f) : 0;
+
+	// Slaves first, so they are running when the master starts driving SYNCB.
+	for (uint8_t i = count_; i-- > 0;)
+		ok &= dev_[i]->applyGlobalConfig(GlobalConfig::Start);
+
+	resetStats();
+	return ok;
+}
+
+uint8_t ADS1293Group::collectReady(uint8_t ready, uint32_t *seenAt) const
+{
+	const uint32_t now = micros();
+	for (uint8_t i = 0; i < count_; ++i)
+	{
+		if (!(ready & (1u << i)) && digitalRead(dev_[i]->getDrdyPin()) == LOW)
+		{
+			ready |= static_cast<uint8_t>(1u << i);
+			seenAt[i] = now;
+		}
+	}
+	return ready;
+}
+
+bool ADS1293Group::poll(Frame &frame)
+{
+	if (count_ == 0)
+		return false;
+
+	const uint8_t all = static_cast<uint8_t>((1u << count_) - 1u);
+	uint32_t seenAt[MAX_DEVICES] = {};
+	uint8_t ready = collectReady(0, seenAt);
+	if (!ready)
+		return false;
+
+	// A slave went first: the master gets the skew window to follow.
+	if (!(ready & 0x01u))
+	{
+		uint8_t lead = 1;
+		while (!(ready & (1u << lead)))
+			++lead;
+		const uint32_t leadUs = seenAt[lead];
+		while (!(ready & 0x01u) && micros() - leadUs <= windowUs_)
+			ready = collectReady(ready, seenAt);
+		if (!(ready & 0x01u))
+		{
+			// Stale: its merged frame went out without it (and counted it
+			// as missed). Read it to release DRDY, and drop it.
+			ADS1293::Samples stale;
+			for (uint8_t i = 1; i < count_; ++i)
+				if (ready & (1u << i))
+					dev_[i]->readFrames(&stale, 1);
+			return false;
+		}
+	}
+
+	// The rest get the skew window from the master's DRDY.
+	const uint32_t t0 = seenAt[0];
+	while (ready != all && micros() - t0 <= windowUs_)
+		ready = collectReady(ready, seenAt);
+
+	// Each device through its own read path, so its frame layout, status
+	// handling and filter apply. Only CS changes between devices.
+	for (uint8_t i = 0; i < count_; ++i)
+	{
+		if ((ready & (1u << i)) && dev_[i]->readFrames(&frame.device[i], 1) != 1)
+			ready = static_cast<uint8_t>(ready & ~(1u << i));
+	}
+	if (!(ready & 0x01u))
+		return false;
+
+	// Frames the whole group lost because poll() came late show up as a
+	// gap of several periods between master DRDYs.
+	uint32_t lost = 0;
+	if (periodUs_ && masterSeen_)
+	{
+		const uint32_t periods = (t0 - lastMasterUs_ + periodUs_ / 2) / periodUs_;
+		if (periods > 1)
+			lost = periods - 1;
+	}
+	lastMasterUs_ = t0;
+	masterSeen_ = true;
+
+	frame.timestampUs = t0;
+	frame.missedMask = static_cast<uint8_t>(all & ~ready);
+	for (uint8_t i = 0; i < count_; ++i)
+	{
+		missed_[i] += lost;
+		if (!(ready & (1u << i)))
+		{
+			frame.device[i] = ADS1293::Samples();
+			frame.skewUs[i] = 0;
+			++missed_[i];
+			continue;
+		}
+		const uint32_t skew = seenAt[i] - t0 < t0 - seenAt[i] ? seenAt[i] - t0 : t0 - seenAt[i];
+		frame.skewUs[i] = static_cast<uint16_t>(skew > 0xFFFFu ? 0xFFFFu : skew);
+		if (frame.skewUs[i] > maxSkew_[i])
+			maxSkew_[i] = frame.skewUs[i];
+	}
+	++frames_;
+	return true;
+}
+
+uint32_t ADS1293Group::missedFrames(uint8_t device) const noexcept
+{
+	return device < count_ ? missed_[device] : 0;
+}
+
+uint16_t ADS1293Group::maxSkewUs(uint8_t device) const noexcept
+{
+	return device < count_ ? maxSkew_[device] : 0;
+}
+
+void ADS1293Group::resetStats() noexcept
+{
+	for (uint8_t i = 0; i < MAX_DEVICES; ++i)
+	{
+		missed_[i] = 0;
+		maxSkew_[i] = 0;
+	}
+	lastMasterUs_ = 0;
+	masterSeen_ = false;
+	frames_ = 0;
+}
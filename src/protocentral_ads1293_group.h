@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protocentral ADS1293 - several devices on one SPI bus
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//
+// ADS1293Group runs up to four ADS1293s (e.g. three for 12-lead ECG) that
+// share an SPIClass, each with its own CS and DRDY pin. Conversions are
+// aligned through the SYNCB line: the first device added is the master and
+// drives SYNCB from its slowest ECG channel, the others take it as input
+// (and, optionally, the master's CLK output). poll() waits for the master's
+// DRDY, gives the slaves a skew window to follow and reads every ready
+// device back to back through its own frame read (ADS1293::readFrames), so
+// pace and status readout, per-channel rates and attached filters all
+// apply. Merged frames are anchored on the master: a slave frame that
+// misses the window is never paired with a later master frame.
+//
+// Wiring: SYNCB of all devices connected together; for sharedClock, the
+// CLK pins connected together as well.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "protocentral_ads1293.h"
+
+class ADS1293Group {
+public:
+  static constexpr uint8_t MAX_DEVICES = 4;
+
+  struct Frame {
+    ADS1293::Samples device[MAX_DEVICES]; // ok == false for missed devices
+    uint32_t timestampUs = 0;             // micros() when the master's DRDY was seen
+    uint16_t skewUs[MAX_DEVICES] = {};    // DRDY offset from the master, either way
+    uint8_t missedMask = 0;               // bit n: device n had no new frame
+  };
+
+  // Add a configured device; the first one is the master. All devices
+  // must use the same SPIClass and must not have their own acquisition
+  // running. Returns false when full or on a mismatch.
+  bool add(ADS1293 &dev);
+  uint8_t size() const noexcept { return count_; }
+
+  // Program SYNCB_CN (master drives SYNCB from ECG channel `syncChannel`,
+  // which must be its slowest one; slaves 0x40 = input) and, if
+  // `sharedClock`, OSC_CN so the slaves run from the master's CLK output.
+  // Conversions are stopped while reprogramming and restarted slaves first.
+  // Also resets the statistics.
+  bool synchronize(uint8_t syncChannel = 1, bool sharedClock = false);
+
+  // How long poll() waits for the remaining DRDY lines once one has been
+  // seen, in microseconds (default 50). Keep it well below a frame period.
+  void setSkewWindow(uint16_t us) noexcept { windowUs_ = us; }
+
+  // Once the master has DRDY asserted, wait up to the skew window (from
+  // the master's DRDY) for the slaves, read every ready device and fill
+  // `frame`. A slave that asserts DRDY first is waited on the same way; if
+  // the master does not follow within the window, that slave frame is
+  // stale (its merged frame was already returned without it) and is read
+  // and dropped. Returns false when no merged frame was ready. Call at
+  // least once per frame period.
+  bool poll(Frame &frame);
+
+  // Frames a device failed to deliver: missed the skew window, or lost by
+  // the whole group because poll() was called too late (estimated from the
+  // spacing of the master's DRDY and its output data rate).
+  uint32_t missedFrames(uint8_t device) const noexcept;
+  uint16_t maxSkewUs(uint8_t device) const noexcept;
+  uint32_t framesRead() const noexcept { return frames_; }
+  void resetStats() noexcept;
+
+private:
+  ADS1293 *dev_[MAX_DEVICES] = {};
+  uint8_t count_ = 0;
+  uint16_t windowUs_ = 50;
+  uint32_t periodUs_ = 0; // master frame period, 0 if unknown
+
+  uint32_t lastMasterUs_ = 0;
+  bool masterSeen_ = false;
+  uint32_t missed_[MAX_DEVICES] = {};
+  uint16_t maxSkew_[MAX_DEVICES] = {};
+  uint32_t frames_ = 0;
+
+  uint8_t collectReady(uint8_t ready, uint32_t *seenAt) const;
+};
@@ -0,0 +1,356 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protocentral ADS1293 - compile-time configuration profiles
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//
+// A profile is a complete image of the configuration block (0x00..0x2F),
+// built at compile time from typed register fields and stored in program
+// memory. Registers a profile does not name keep their datasheet reset
+// value, so applying a profile always leaves the device in the same state,
+// whatever ran before. ADS1293::applyProfile() writes it in three bursts.
+//
+//   typedef ADS1293Profile<
+//       ADS1293FlexChannel<1, 2, 1>,       // CH1 = IN2 - IN1
+//       ADS1293FlexChannel<2, 3, 1>,       // CH2 = IN3 - IN1
+//       ADS1293CommonModeDetect<0x07>,     // IN1..IN3
+//       ADS1293RightLegDrive<4>,           // RLD on IN4
+//       ADS1293Oscillator<>,
+//       ADS1293AfeChannels<0x03>,          // CH1 and CH2 powered
+//       ADS1293DecimationR2<5>,
+//       ADS1293DecimationR3<1, 6>,
+//       ADS1293DecimationR3<2, 6>,
+//       ADS1293DataReadySource<DRDYSource::Ch1Ecg>,
+//       ADS1293LoopReadback<0x03>,
+//       ADS1293Start<>> MyProfile;
+//
+//   ecg.applyProfile<MyProfile>();
+//
+// Field values are checked where they are declared (input numbers, one-hot
+// rate codes) and the profile as a whole is checked for combinations the
+// device cannot run: an ECG channel read back but not routed or powered,
+// a DRDY source on a dead channel, conversions started without the digital
+// clock, a register given twice, or a read-only/reserved address. Every
+// check is a static_assert, so a bad profile does not compile and a good one
+// costs no code.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "protocentral_ads1293.h"
+
+// --- register fields -------------------------------------------------------
+// Each field is a type with the register `address` and its `value`.
+
+// Raw register value, for anything without a typed field.
+template <Register R, uint8_t V>
+struct ADS1293Set {
+  static constexpr uint8_t address = static_cast<uint8_t>(R);
+  static constexpr uint8_t value = V;
+};
+
+// FLEX_CHn_CN: channel `Ch` (1..3) measures IN`Pos` - IN`Neg` (1..6).
+template <uint8_t Ch, uint8_t Pos, uint8_t Neg>
+struct ADS1293FlexChannel {
+  static_assert(Ch >= 1 && Ch <= 3, "channel must be 1..3");
+  static_assert(Pos >= 1 && Pos <= 6 && Neg >= 1 && Neg <= 6, "inputs must be IN1..IN6");
+  static_assert(Pos != Neg, "positive and negative input must differ");
+  static constexpr uint8_t address = static_cast<uint8_t>(Register::FLEX_CH1_CN) + Ch - 1;
+  static constexpr uint8_t value = static_cast<uint8_t>((Pos << 3) | Neg);
+};
+
+// FLEX_CHn_CN: channel `Ch` connected to the internal test signal.
+template <uint8_t Ch, TestSignal Sig>
+struct ADS1293TestChannel {
+  static_assert(Ch >= 1 && Ch <= 3, "channel must be 1..3");
+  static constexpr uint8_t address = static_cast<uint8_t>(Register::FLEX_CH1_CN) + Ch - 1;
+  static constexpr uint8_t value = static_cast<uint8_t>(static_cast<uint8_t>(Sig) << 6);
+};
+
+// CMDET_EN: inputs averaged for common-mode detection (bit 0 = IN1).
+template <uint8_t InputMask>
+struct ADS1293CommonModeDetect {
+  static_assert(InputMask != 0 && InputMask <= 0x3F, "input mask covers IN1..IN6");
+  static constexpr uint8_t address = static_cast<uint8_t>(Register::CMDET_EN);
+  static constexpr uint8_t value = InputMask;
+};
+
+// RLD_CN: right-leg drive output on IN`Input` (1..6), amplifier powered.
+template <uint8_t Input, uint8_t CapDrive = 0, bool HighBandwidth = false>
+struct ADS1293RightLegDrive {
+  static_assert(Input >= 1 && Input <= 6, "RLD input must be IN1..IN6");
+  static_assert(CapDrive <= 3, "cap-drive level is 0..3");
+  static constexpr uint8_t address = static_cast<uint8_t>(Register::RLD_CN);
+  static constexpr uint8_t value = static_cast<uint8_t>((HighBandwidth ? 0x40 : 0) | (CapDrive << 4) | Input);
+};
+
+// OSC_CN: digital clock from the crystal oscillator or the CLK pin.
+template <bool ExternalClock = false, bool ClockOut = false>
+struct ADS1293Oscillator {
+  static constexpr uint8_t address = static_cast<uint8_t>(Register::OSC_CN);
+  static constexpr uint8_t value = static_cast<uint8_t>(0x04 | (ExternalClock ? 0x02 : 0) | (ClockOut ? 0x01 : 0));
+};
+
+// AFE_SHDN_CN: instrumentation amplifier and modulator of each channel in
+// `ChannelMask` (bit 0 = CH1) powered, the others shut down.
+template <uint8_t ChannelMask>
+struct ADS1293AfeChannels {
+  static_assert(ChannelMask != 0 && ChannelMask <= 0x07, "channel mask covers CH1..CH3");
+  static constexpr uint8_t address = static_cast<uint8_t>(Register::AFE_SHDN_CN);
+  static constexpr uint8_t value = static_cast<uint8_t>((~ChannelMask & 0x07) * 0x09);
+};
+
+// AFE_RES: 204.8 kHz modulator clock (`FastMask`) and high-resolution
+// amplifier mode (`HighResMask`) per channel.
+template <uint8_t FastMask, uint8_t HighResMask = 0>
+struct ADS1293AfeResolution {
+  static_assert(FastMask <= 0x07 && HighResMask <= 0x07, "channel masks cover CH1..CH3");
+  static constexpr uint8_t address = static_cast<uint8_t>(Register::AFE_RES);
+  static constexpr uint8_t value = static_cast<uint8_t>((FastMask << 3) | HighResMask);
+};
+
+// R1_RATE: channels in `DoubleRateMask` run R1 = 2 instead of 4.
+template <uint8_t DoubleRateMask>
+struct ADS1293DecimationR1 {
+  static_assert(DoubleRateMask <= 0x07, "channel mask covers CH1..CH3");
+  static constexpr uint8_t address = static_cast<uint8_t>(Register::R1_RATE);
+  static constexpr uint8_t value = DoubleRateMask;
+};
+
+constexpr uint8_t ads1293R2Code(uint8_t r2)
+{
+  return r2 == 4 ? 0x01 : r2 == 5 ? 0x02 : r2 == 6 ? 0x04 : r2 == 8 ? 0x08 : 0x00;
+}
+
+constexpr uint8_t ads1293R3Code(uint8_t r3)
+{
+  return r3 == 4 ? 0x01 : r3 == 6 ? 0x02 : r3 == 8 ? 0x04 : r3 == 12 ? 0x08 :
+         r3 == 16 ? 0x10 : r3 == 32 ? 0x20 : r3 == 64 ? 0x40 : r3 == 128 ? 0x80 : 0x00;
+}
+
+template <uint8_t R2>
+struct ADS1293DecimationR2 {
+  static_assert(ads1293R2Code(R2) != 0, "R2 must be 4, 5, 6 or 8");
+  static constexpr uint8_t address = static_cast<uint8_t>(Register::R2_RATE);
+  static constexpr uint8_t value = ads1293R2Code(R2);
+};
+
+template <uint8_t Ch, uint8_t R3>
+struct ADS1293DecimationR3 {
+  static_assert(Ch >= 1 && Ch <= 3, "channel must be 1..3");
+  static_assert(ads1293R3Code(R3) != 0, "R3 must be 4, 6, 8, 12, 16, 32, 64 or 128");
+  static constexpr uint8_t address = static_cast<uint8_t>(Register::R3_RATE_CH1) + Ch - 1;
+  static constexpr uint8_t value = ads1293R3Code(R3);
+};
+
+template <DRDYSource Src>
+struct ADS1293DataReadySource {
+  static constexpr uint8_t address = static_cast<uint8_t>(Register::DRDYB_SRC);
+  static constexpr uint8_t value = static_cast<uint8_t>(Src);
+};
+
+// MASK_DRDYB: DRDY held off for the first six ECG periods after START_CON
+// (`Initial`) and after a sync error (`AfterSyncError`). Without the
+// initial mask the first frame arrives one period after start, before the
+// filters have settled (see ADS1293::startup()).
+template <bool Initial = true, bool AfterSyncError = true>
+struct ADS1293DataReadyMasking {
+  static constexpr uint8_t address = static_cast<uint8_t>(Register::MASK_DRDYB);
+  static constexpr uint8_t value = static_cast<uint8_t>((Initial ? 0 : 0x02) | (AfterSyncError ? 0 : 0x01));
+};
+
+// CH_CNFG: sources streamed by DATA_LOOP (bit 0 = CH1).
+template <uint8_t EcgMask, uint8_t PaceMask = 0, bool Status = false>
+struct ADS1293LoopReadback {
+  static_assert(EcgMask <= 0x07 && PaceMask <= 0x07, "channel masks cover CH1..CH3");
+  static constexpr uint8_t address = static_cast<uint8_t>(Register::CH_CNFG);
+  static constexpr uint8_t value = static_cast<uint8_t>((EcgMask << 4) | (PaceMask << 1) | (Status ? 0x01 : 0));
+};
+
+// CONFIG: start conversions (or leave the device in standby).
+template <bool Run = true>
+struct ADS1293Start {
+  static constexpr uint8_t address = static_cast<uint8_t>(Register::CONFIG);
+  static constexpr uint8_t value = Run ? 0x01 : 0x02;
+};
+
+// --- profile image ---------------------------------------------------------
+
+// Datasheet reset value of each configuration register (0x00..0x2F).
+constexpr uint8_t ads1293ResetValue(uint8_t a)
+{
+  return a == 0x00 ? 0x02 : a == 0x06 ? 0x08 : a == 0x17 ? 0x01 : a == 0x1F ? 0x03 :
+         a == 0x21 ? 0x08 : (a >= 0x22 && a <= 0x24) ? 0x80 : a == 0x28 ? 0x40 :
+         a == 0x2D ? 0x09 : a == 0x2E ? 0x33 : 0x00;
+}
+
+// Addresses a profile may set: the read-only error registers, DIGO_STRENGTH
+// and the reserved addresses are never written by applyProfile().
+constexpr bool ads1293ProfileWritable(uint8_t a)
+{
+  return a < ADS1293::PROFILE_BYTES && a != 0x16 && !(a >= 0x18 && a <= 0x20) && !(a >= 0x2B && a <= 0x2D);
+}
+
+template <typename... Fields>
+struct ADS1293ProfileFields;
+
+template <>
+struct ADS1293ProfileFields<> {
+  static constexpr uint8_t get(uint8_t a) { return ads1293ResetValue(a); }
+  static constexpr uint8_t count(uint8_t) { return 0; }
+  static constexpr bool writable() { return true; }
+};
+
+template <typename F, typename... Rest>
+struct ADS1293ProfileFields<F, Rest...> {
+  static constexpr uint8_t get(uint8_t a) { return F::address == a ? F::value : ADS1293ProfileFields<Rest...>::get(a); }
+  static constexpr uint8_t count(uint8_t a) { return (F::address == a ? 1 : 0) + ADS1293ProfileFields<Rest...>::count(a); }
+  static constexpr bool writable() { return ads1293ProfileWritable(F::address) && ADS1293ProfileFields<Rest...>::writable(); }
+};
+
+template <uint8_t... I>
+struct ADS1293ByteSequence {};
+
+template <uint8_t N, uint8_t... I>
+struct ADS1293MakeByteSequence : ADS1293MakeByteSequence<N - 1, N - 1, I...> {};
+
+template <uint8_t... I>
+struct ADS1293MakeByteSequence<0, I...> {
+  typedef ADS1293ByteSequence<I...> type;
+};
+
+template <typename Fields, typename Seq>
+struct ADS1293ProfileRom;
+
+template <typename Fields, uint8_t... I>
+struct ADS1293ProfileRom<Fields, ADS1293ByteSequence<I...>> {
+  static const uint8_t data[sizeof...(I)];
+};
+
+template <typename Fields, uint8_t... I>
+const uint8_t ADS1293ProfileRom<Fields, ADS1293ByteSequence<I...>>::data[sizeof...(I)] PROGMEM = {Fields::get(I)...};
+
+template <typename... Fields>
+class ADS1293Profile {
+  typedef ADS1293ProfileFields<Fields...> F;
+
+  static constexpr bool unique(uint8_t a)
+  {
+    return a >= ADS1293::PROFILE_BYTES || (F::count(a) <= 1 && unique(static_cast<uint8_t>(a + 1)));
+  }
+  static constexpr bool oneHot(uint8_t v) { return v != 0 && (v & (v - 1)) == 0; }
+  static constexpr bool routed(uint8_t ch)
+  {
+    return F::get(static_cast<uint8_t>(0x01 + ch)) != 0; // inputs or test signal
+  }
+  static constexpr bool powered(uint8_t ch)
+  {
+    return (F::get(0x14) & (0x09 << ch)) == 0;
+  }
+  static constexpr bool channelsRunnable(uint8_t ch)
+  {
+    return ch >= 3 || ((!(F::get(0x2F) & (0x10 << ch)) || (routed(ch) && powered(ch) && oneHot(F::get(static_cast<uint8_t>(0x22 + ch))))) &&
+                       channelsRunnable(static_cast<uint8_t>(ch + 1)));
+  }
+  // DRDYB_SRC bits 0..2 are the pace and 3..5 the ECG output of CH1..CH3.
+  static constexpr uint8_t drdyChannel(uint8_t src)
+  {
+    return (src & 0x09) ? 0 : (src & 0x12) ? 1 : 2;
+  }
+  static constexpr bool running() { return (F::get(0x00) & 0x01) != 0; }
+
+  static_assert(F::writable(), "profile sets a read-only, reserved or unsupported register");
+  static_assert(unique(0), "profile sets a register more than once");
+  static_assert(oneHot(F::get(0x21)) && F::get(0x21) <= 0x08, "R2_RATE must select one R2");
+  static_assert(channelsRunnable(0), "a channel in CH_CNFG is not routed, not powered or has no valid R3");
+  static_assert(!running() || (F::get(0x12) & 0x04), "conversions need STRTCLK in OSC_CN");
+  static_assert(!running() || (oneHot(F::get(0x27)) && F::get(0x27) <= 0x20), "DRDYB_SRC must select one source");
+  static_assert(!running() || (routed(drdyChannel(F::get(0x27))) && powered(drdyChannel(F::get(0x27)))),
+                "DRDYB_SRC selects a channel that is not routed or not powered");
+
+public:
+  typedef ADS1293ProfileRom<F, typename ADS1293MakeByteSequence<ADS1293::PROFILE_BYTES>::type> Rom;
+
+  // Register image in program memory, ADS1293::PROFILE_BYTES long.
+  static const uint8_t *image() noexcept { return Rom::data; }
+
+  // Value of register `a` in this profile, usable in constant expressions.
+  static constexpr uint8_t value(Register a) { return F::get(static_cast<uint8_t>(a)); }
+};
+
+// --- ready-made profiles ---------------------------------------------------
+
+struct ADS1293Profiles {
+  // Datasheet 3-lead example (the same values begin3LeadECG() writes):
+  // CH1 = IN2 - IN1, CH2 = IN3 - IN1, RLD on IN4, R2 = 5, R3 = 6 (853 SPS).
+  typedef ADS1293Profile<
+      ADS1293FlexChannel<1, 2, 1>,
+      ADS1293FlexChannel<2, 3, 1>,
+      ADS1293CommonModeDetect<0x07>,
+      ADS1293RightLegDrive<4>,
+      ADS1293Oscillator<>,
+      ADS1293AfeChannels<0x03>,
+      ADS1293DecimationR2<5>,
+      ADS1293DecimationR3<1, 6>,
+      ADS1293DecimationR3<2, 6>,
+      ADS1293DataReadySource<DRDYSource::Ch1Ecg>,
+      ADS1293LoopReadback<0x03>,
+      ADS1293Start<>>
+      ThreeLead;
+
+  // Datasheet 5-lead example: adds CH3 = IN5 - IN6 against the Wilson
+  // central terminal built from IN1..IN3.
+  typedef ADS1293Profile<
+      ADS1293FlexChannel<1, 2, 1>,
+      ADS1293FlexChannel<2, 3, 1>,
+      ADS1293FlexChannel<3, 5, 6>,
+      ADS1293CommonModeDetect<0x07>,
+      ADS1293RightLegDrive<4>,
+      ADS1293Set<Register::WILSON_EN1, 0x01>,
+      ADS1293Set<Register::WILSON_EN2, 0x02>,
+      ADS1293Set<Register::WILSON_EN3, 0x03>,
+      ADS1293Set<Register::WILSON_CN, 0x01>,
+      ADS1293Oscillator<>,
+      ADS1293DecimationR2<5>,
+      ADS1293DecimationR3<1, 6>,
+      ADS1293DecimationR3<2, 6>,
+      ADS1293DecimationR3<3, 6>,
+      ADS1293DataReadySource<DRDYSource::Ch1Ecg>,
+      ADS1293LoopReadback<0x07>,
+      ADS1293Start<>>
+      FiveLead;
+
+  // All three channels on the positive test signal, no electrodes needed.
+  typedef ADS1293Profile<
+      ADS1293TestChannel<1, TestSignal::Positive>,
+      ADS1293TestChannel<2, TestSignal::Positive>,
+      ADS1293TestChannel<3, TestSignal::Positive>,
+      ADS1293Oscillator<>,
+      ADS1293DecimationR2<5>,
+      ADS1293DecimationR3<1, 6>,
+      ADS1293DecimationR3<2, 6>,
+      ADS1293DecimationR3<3, 6>,
+      ADS1293DataReadySource<DRDYSource::Ch1Ecg>,
+      ADS1293LoopReadback<0x07>,
+      ADS1293Start<>>
+      SelfTest;
+
+  // 3-lead routing at the highest ECG rate: 204.8 kHz modulators, R1 = 2,
+  // R2 = 4, R3 = 4 (6400 SPS).
+  typedef ADS1293Profile<
+      ADS1293FlexChannel<1, 2, 1>,
+      ADS1293FlexChannel<2, 3, 1>,
+      ADS1293CommonModeDetect<0x07>,
+      ADS1293RightLegDrive<4>,
+      ADS1293Oscillator<>,
+      ADS1293AfeChannels<0x03>,
+      ADS1293AfeResolution<0x03>,
+      ADS1293DecimationR1<0x03>,
+      ADS1293DecimationR2<4>,
+      ADS1293DecimationR3<1, 4>,
+      ADS1293DecimationR3<2, 4>,
+      ADS1293DataReadySource<DRDYSource::Ch1Ecg>,
+      ADS1293LoopReadback<0x03>,
+      ADS1293Start<>>
+      HighRate;
+};
@@ -0,0 +1,265 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protocentral ADS1293 - real-time QRS detector (implementation)
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include "protocentral_ads1293_qrs.h"
+
+// Largest |derivative| whose square fits in 31 bits.
+static constexpr uint32_t SLOPE_CLAMP = 46340;
+
+// Exponential update with weight 1/8 (Pan-Tompkins SPKI/NPKI), written so
+// that values close to 2^32 do not overflow.
+static uint32_t track8(uint32_t level, uint32_t peak) noexcept
+{
+	return level - level / 8 + peak / 8;
+}
+
+bool ADS1293QrsDetector::configure(float inputHz)
+{
+	decim_ = 0;
+	if (inputHz < 150.0f || inputHz > 3200.0f)
+		return false;
+	uint8_t d = static_cast<uint8_t>(inputHz / 200.0f + 0.5f);
+	decim_ = d ? d : 1;
+	fsCentiHz_ = static_cast<uint32_t>(inputHz * 100.0f + 0.5f);
+	const uint32_t rate = fsCentiHz_ / (100u * decim_); // decimated rate, ~200 Hz
+	learnLen_ = static_cast<uint16_t>(2u * rate);
+	refractory_ = static_cast<uint16_t>(rate / 5u);
+	tWave_ = static_cast<uint16_t>(rate * 36u / 100u);
+	reset();
+	return true;
+}
+
+bool ADS1293QrsDetector::configure(ADS1293::SamplingRate rate)
+{
+	return configure(ADS1293::samplingRateHz(rate));
+}
+
+void ADS1293QrsDetector::reset() noexcept
+{
+	// Restart from a default-constructed detector, keeping the configuration
+	// and the callback.
+	ADS1293QrsDetector fresh;
+	fresh.decim_ = decim_;
+	fresh.fsCentiHz_ = fsCentiHz_;
+	fresh.learnLen_ = learnLen_;
+	fresh.refractory_ = refractory_;
+	fresh.tWave_ = tWave_;
+	fresh.beatCb_ = beatCb_;
+	fresh.beatCtx_ = beatCtx_;
+	*this = fresh;
+}
+
+bool ADS1293QrsDetector::process(int32_t x, Beat *beat) noexcept
+{
+	if (decim_ == 0)
+		return false;
+	++inputIndex_;
+	decimSum_ += x;
+	if (++decimCount_ < decim_)
+		return false;
+	const int32_t avg = decimSum_ / decim_;
+	decimSum_ = 0;
+	decimCount_ = 0;
+	return step(avg, beat);
+}
+
+size_t ADS1293QrsDetector::processBlock(const ADS1293::Samples *frames, size_t n, uint8_t channel) noexcept
+{
+	if (!frames || channel > 2)
+		return 0;
+	size_t found = 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		const int32_t x = channel == 0 ? frames[i].ch1 : (channel == 1 ? frames[i].ch2 : frames[i].ch3);
+		if (process(x))
+			++found;
+	}
+	return found;
+}
+
+uint16_t ADS1293QrsDetector::heartRate() const noexcept
+{
+	if (rrAvg8_ == 0)
+		return 0;
+	// 60 s * fs / (RR * decim), with RR in 1/8 decimated samples
+	const uint64_t num = 60ull * 8u * fsCentiHz_;
+	const uint64_t den = static_cast<uint64_t>(rrAvg8_) * decim_ * 100u;
+	return static_cast<uint16_t>((num + den / 2) / den);
+}
+
+bool ADS1293QrsDetector::step(int32_t x, Beat *beat) noexcept
+{
+	const uint32_t n = n_;
+
+	if (n == 0)
+	{
+		// Prime the high-pass with the first sample so the electrode offset
+		// does not produce a start-up transient.
+		for (uint8_t i = 0; i < HP_LEN; ++i)
+			hpX_[i] = x;
+		hpSum_ = x * static_cast<int32_t>(HP_LEN);
+	}
+
+	// High-pass: x(n-16) - mean of the last 32 samples (delay 16).
+	const uint8_t hp = static_cast<uint8_t>(n & (HP_LEN - 1));
+	hpSum_ += x - hpX_[hp];
+	hpX_[hp] = x;
+	const int32_t p = hpX_[(n + HP_LEN / 2) & (HP_LEN - 1)] - (hpSum_ >> 5);
+
+	// Low-pass: y(n) = 2y(n-1) - y(n-2) + x(n) - 2x(n-6) + x(n-12) (gain 36, delay 5).
+	const int32_t p12 = lpX_[lpPos_];
+	const int32_t p6 = lpX_[(lpPos_ + LP_LEN / 2) % LP_LEN];
+	lpX_[lpPos_] = p;
+	if (++lpPos_ == LP_LEN)
+		lpPos_ = 0;
+	const int32_t y = 2 * lpY1_ - lpY2_ + p - 2 * p6 + p12;
+	lpY2_ = lpY1_;
+	lpY1_ = y;
+	bp_[n & (BP_LEN - 1)] = y < 0 ? -y : y;
+
+	// Five-point derivative on the scaled band-passed signal.
+	const int32_t v = y >> 3;
+	const uint8_t dp = static_cast<uint8_t>(n & (DERIV_LEN - 1));
+	const int32_t d = (2 * v + derivX_[(n - 1) & (DERIV_LEN - 1)] - derivX_[(n + 1) & (DERIV_LEN - 1)] - 2 * derivX_[dp]) >> 3;
+	derivX_[dp] = v;
+
+	// Squaring and moving-window integration (150 ms).
+	uint32_t ad = static_cast<uint32_t>(d < 0 ? -d : d);
+	if (ad > SLOPE_CLAMP)
+		ad = SLOPE_CLAMP;
+	if (ad > slope_)
+		slope_ = ad;
+	const uint32_t sq = (ad * ad) >> 5;
+	mwiSum_ += sq - mwi_[mwiPos_];
+	mwi_[mwiPos_] = sq;
+	if (++mwiPos_ == MWI_LEN)
+		mwiPos_ = 0;
+	const uint32_t m = mwiSum_;
+	n_ = n + 1;
+
+	// Local maximum of the integrated signal.
+	bool peak = false;
+	const uint32_t peakValue = mwiPrev_;
+	if (m > mwiPrev_)
+	{
+		rising_ = true;
+	}
+	else if (m < mwiPrev_ && rising_)
+	{
+		rising_ = false;
+		peak = true;
+	}
+	mwiPrev_ = m;
+
+	if (n < learnLen_)
+	{
+		if (m > learnMax_)
+			learnMax_ = m;
+		learnSum_ += m >> 10;
+		if (n + 1 == learnLen_)
+		{
+			spki_ = learnMax_ / 3;
+			npki_ = (learnSum_ / learnLen_) << 9; // half the mean
+		}
+		slope_ = 0;
+		return false;
+	}
+
+	bool detected = false;
+	if (peak)
+	{
+		const uint32_t r = locateR();
+		const uint32_t slope = slope_;
+		slope_ = 0;
+		const uint32_t thr1 = spki_ > npki_ ? npki_ + (spki_ - npki_) / 4 : npki_;
+		const uint32_t since = haveQrs_ ? r - lastR_ : UINT32_MAX;
+
+		if (peakValue > thr1)
+		{
+			if (since < refractory_)
+			{
+				// same complex, already reported
+			}
+			else if (since < tWave_ && slope < lastSlope_ / 2)
+			{
+				npki_ = track8(npki_, peakValue); // T wave
+			}
+			else
+			{
+				spki_ = track8(spki_, peakValue);
+				acceptQrs(r, slope, beat);
+				detected = true;
+			}
+		}
+		else
+		{
+			npki_ = track8(npki_, peakValue);
+			if (peakValue > thr1 / 2 && since >= refractory_ && peakValue > backPeak_)
+			{
+				backPeak_ = peakValue;
+				backR_ = r;
+				backSlope_ = slope;
+			}
+		}
+	}
+
+	// Search-back: no QRS for 166% of the average RR, take the best
+	// candidate above the lower threshold.
+	if (!detected && haveQrs_ && rrAvg8_ && backPeak_ &&
+		(n - lastR_) * 8u * 100u > rrAvg8_ * 166u)
+	{
+		spki_ = spki_ - spki_ / 4 + backPeak_ / 4;
+		acceptQrs(backR_, backSlope_, beat);
+		detected = true;
+	}
+	return detected;
+}
+
+uint32_t ADS1293QrsDetector::locateR() const noexcept
+{
+	// Largest band-passed magnitude in the last BP_LEN samples, i.e. the
+	// stretch covered by the integration window that just peaked.
+	const uint32_t newest = n_ - 1;
+	uint32_t best = newest;
+	int32_t bestValue = -1;
+	for (uint8_t i = 0; i < BP_LEN; ++i)
+	{
+		const uint32_t k = newest - i;
+		const int32_t value = bp_[k & (BP_LEN - 1)];
+		if (value > bestValue)
+		{
+			bestValue = value;
+			best = k;
+		}
+	}
+	return best;
+}
+
+void ADS1293QrsDetector::acceptQrs(uint32_t r, uint32_t slope, Beat *beat) noexcept
+{
+	Beat b;
+	b.sample = (r - FILTER_DELAY) * decim_ + (decim_ - 1u) / 2u;
+	if (haveQrs_)
+	{
+		const uint32_t rr = r - lastR_;
+		b.rrSamples = rr * decim_;
+		b.rrMs = static_cast<uint16_t>((b.rrSamples * 100000ull + fsCentiHz_ / 2) / fsCentiHz_);
+		if (b.rrMs)
+			b.heartRate = static_cast<uint16_t>((60000u + b.rrMs / 2u) / b.rrMs);
+		rrAvg8_ = rrAvg8_ ? rrAvg8_ - rrAvg8_ / 8 + rr : rr * 8u;
+	}
+	haveQrs_ = true;
+	lastR_ = r;
+	lastSlope_ = slope;
+	backPeak_ = 0;
+	++beats_;
+
+	if (beat)
+		*beat = b;
+	if (beatCb_)
+		beatCb_(b, beatCtx_);
+}
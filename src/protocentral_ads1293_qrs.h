@@ -0,0 +1,128 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protocentral ADS1293 - real-time QRS detector
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//
+// Streaming Pan-Tompkins QRS detector working on one ECG channel in integer
+// arithmetic with fixed memory (about 450 bytes). Input is box-car averaged
+// down to ~200 Hz, the rate the Pan-Tompkins integer filters are designed
+// for, so the per-sample cost is one addition plus one filter/decision step
+// every 1600/200 = 8 samples at SPS_1600.
+//
+// Pipeline (at ~200 Hz): high-pass, low-pass (5-15 Hz band), five-point
+// derivative, squaring, 150 ms moving-window integration, then adaptive
+// signal/noise thresholds with a 200 ms refractory period, T-wave
+// rejection and search-back for missed beats.
+//
+// The first two seconds are used to learn the thresholds and produce no
+// beats. A beat is reported 250-400 ms after its R peak (filter delay plus
+// the integration window); search-back beats are reported later. The R-peak
+// position is resolved to one decimated sample (5 ms).
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "protocentral_ads1293.h"
+
+class ADS1293QrsDetector {
+public:
+  struct Beat {
+    uint32_t sample = 0;     // input sample index of the R peak
+    uint32_t rrSamples = 0;  // input samples since the previous R peak, 0 for the first beat
+    uint16_t rrMs = 0;
+    uint16_t heartRate = 0;  // beats per minute from this RR interval, 0 for the first beat
+  };
+
+  typedef void (*BeatCallback)(const Beat &beat, void *context);
+
+  // Prepare for an input stream at `inputHz` (150 Hz up to 3200 Hz). Resets
+  // all state. Returns false if the rate is out of range.
+  bool configure(float inputHz);
+
+  // Same, taking the rate from an ADS1293 sampling-rate preset. For a
+  // running device pass getOutputDataRate() to the float overload.
+  bool configure(ADS1293::SamplingRate rate);
+
+  void reset() noexcept;
+
+  // Called for every detected beat; pass nullptr to remove.
+  void onBeat(BeatCallback cb, void *context = nullptr) noexcept
+  {
+    beatCb_ = cb;
+    beatCtx_ = context;
+  }
+
+  // Feed one sample. Returns true if a beat was detected at this step and,
+  // if given, fills `beat`. The callback is also invoked.
+  bool process(int32_t x, Beat *beat = nullptr) noexcept;
+
+  // Feed channel 0..2 of a block of frames (for example from readFrames()).
+  // Returns the number of beats detected; beats are delivered through the
+  // callback.
+  size_t processBlock(const ADS1293::Samples *frames, size_t n, uint8_t channel = 0) noexcept;
+
+  // Heart rate averaged over the last eight RR intervals, 0 until known.
+  uint16_t heartRate() const noexcept;
+
+  uint32_t beatCount() const noexcept { return beats_; }
+  uint32_t sampleCount() const noexcept { return inputIndex_; }
+
+private:
+  static constexpr uint8_t HP_LEN = 32;
+  static constexpr uint8_t LP_LEN = 12;
+  static constexpr uint8_t DERIV_LEN = 4;
+  static constexpr uint8_t MWI_LEN = 30;
+  static constexpr uint8_t BP_LEN = 32;
+  static constexpr uint8_t FILTER_DELAY = 21; // high-pass 16 + low-pass 5
+
+  // input decimation
+  uint8_t decim_ = 0; // 0 = not configured
+  uint8_t decimCount_ = 0;
+  int32_t decimSum_ = 0;
+  uint32_t inputIndex_ = 0;
+  uint32_t fsCentiHz_ = 0;
+  uint16_t learnLen_ = 0;   // decimated samples: 2 s
+  uint16_t refractory_ = 0; // 200 ms
+  uint16_t tWave_ = 0;      // 360 ms
+
+  // filters, indexed by the decimated sample counter n_
+  uint32_t n_ = 0;
+  int32_t hpX_[HP_LEN] = {};
+  int32_t hpSum_ = 0;
+  int32_t lpX_[LP_LEN] = {};
+  uint8_t lpPos_ = 0;
+  int32_t lpY1_ = 0, lpY2_ = 0;
+  int32_t derivX_[DERIV_LEN] = {};
+  uint32_t mwi_[MWI_LEN] = {};
+  uint8_t mwiPos_ = 0;
+  uint32_t mwiSum_ = 0;
+  int32_t bp_[BP_LEN] = {}; // |band-passed| history for R-peak location
+
+  // peak picking and thresholds (integrated signal)
+  uint32_t mwiPrev_ = 0;
+  bool rising_ = false;
+  uint32_t slope_ = 0; // largest |derivative| since the last peak
+  uint32_t spki_ = 0, npki_ = 0;
+  uint32_t learnMax_ = 0;
+  uint32_t learnSum_ = 0;
+
+  // last QRS, in decimated samples
+  bool haveQrs_ = false;
+  uint32_t lastR_ = 0;
+  uint32_t lastSlope_ = 0;
+  uint32_t rrAvg8_ = 0; // 8 x average RR, 0 until two beats were seen
+  uint32_t beats_ = 0;
+
+  // best sub-threshold candidate since the last QRS (search-back)
+  uint32_t backPeak_ = 0;
+  uint32_t backR_ = 0;
+  uint32_t backSlope_ = 0;
+
+  BeatCallback beatCb_ = nullptr;
+  void *beatCtx_ = nullptr;
+
+  bool step(int32_t x, Beat *beat) noexcept;
+  uint32_t locateR() const noexcept;
+  void acceptQrs(uint32_t r, uint32_t slope, Beat *beat) noexcept;
+};
@@ -0,0 +1,194 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protocentral ADS1293 - compact binary streaming protocol (implementation)
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include "protocentral_ads1293_stream.h"
+
+static uint8_t countChannels(uint8_t mask) noexcept
+{
+	return static_cast<uint8_t>(((mask >> 0) & 1u) + ((mask >> 1) & 1u) + ((mask >> 2) & 1u));
+}
+
+uint16_t ADS1293StreamEncoder::crc16(const uint8_t *data, size_t len, uint16_t crc) noexcept
+{
+	// Bitwise form: no lookup table, which keeps flash use small on AVR.
+	while (len--)
+	{
+		crc ^= static_cast<uint16_t>(*data++) << 8;
+		for (uint8_t i = 0; i < 8; ++i)
+			crc = (crc & 0x8000u) ? static_cast<uint16_t>((crc << 1) ^ 0x1021u) : static_cast<uint16_t>(crc << 1);
+	}
+	return crc;
+}
+
+ADS1293StreamEncoder::ADS1293StreamEncoder(Print &out, uint8_t *buffer, size_t bufferSize, uint8_t channelMask) noexcept
+	: out_(out), buf_(buffer), mask_(static_cast<uint8_t>(channelMask & 0x07u)), channels_(countChannels(channelMask & 0x07u))
+{
+	if (!buf_ || channels_ == 0 || bufferSize < packetSize(1, channels_))
+		return;
+	size_t frames = (bufferSize - HEADER_BYTES - CRC_BYTES) / (3u * channels_);
+	capacity_ = static_cast<uint8_t>(frames > 255 ? 255 : frames);
+}
+
+bool ADS1293StreamEncoder::add(const ADS1293::Samples &s)
+{
+	if (capacity_ == 0)
+		return false;
+	const int32_t ch[3] = {s.ch1, s.ch2, s.ch3};
+	for (uint8_t c = 0; c < 3; ++c)
+	{
+		if (!(mask_ & (1u << c)))
+			continue;
+		const uint32_t v = static_cast<uint32_t>(ch[c]);
+		buf_[pos_++] = static_cast<uint8_t>(v);
+		buf_[pos_++] = static_cast<uint8_t>(v >> 8);
+		buf_[pos_++] = static_cast<uint8_t>(v >> 16);
+	}
+	if (++count_ == capacity_)
+		flush();
+	return true;
+}
+
+size_t ADS1293StreamEncoder::add(const ADS1293::Samples *frames, size_t count)
+{
+	size_t n = 0;
+	while (n < count && add(frames[n]))
+		++n;
+	return n;
+}
+
+bool ADS1293StreamEncoder::flush()
+{
+	if (count_ == 0)
+		return true;
+	const uint16_t first = static_cast<uint16_t>(seq_);
+	buf_[0] = SYNC1;
+	buf_[1] = SYNC2;
+	buf_[2] = static_cast<uint8_t>((VERSION << 4) | mask_);
+	buf_[3] = count_;
+	buf_[4] = static_cast<uint8_t>(first);
+	buf_[5] = static_cast<uint8_t>(first >> 8);
+	const uint16_t crc = crc16(buf_ + 2, pos_ - 2);
+	buf_[pos_++] = static_cast<uint8_t>(crc);
+	buf_[pos_++] = static_cast<uint8_t>(crc >> 8);
+
+	const size_t len = pos_;
+	const bool ok = out_.write(buf_, len) == len;
+	seq_ = static_cast<uint16_t>(seq_ + count_);
+	++packets_;
+	count_ = 0;
+	pos_ = HEADER_BYTES;
+	return ok;
+}
+
+void ADS1293StreamEncoder::skipFrames(uint16_t count)
+{
+	flush();
+	seq_ = static_cast<uint16_t>(seq_ + count);
+}
+
+ADS1293StreamDecoder::ADS1293StreamDecoder(uint8_t *buffer, size_t bufferSize, FrameHandler handler, void *context) noexcept
+	: buf_(buffer), size_(buffer ? bufferSize : 0), handler_(handler), ctx_(context) {}
+
+void ADS1293StreamDecoder::feed(const uint8_t *data, size_t len)
+{
+	while (len--)
+		feed(*data++);
+}
+
+void ADS1293StreamDecoder::feed(uint8_t byte)
+{
+	if (size_ < ADS1293StreamEncoder::packetSize(1, 1))
+		return;
+	buf_[pos_++] = byte;
+
+	// The buffer holds a candidate packet starting at a sync pair. When it
+	// turns out not to be one (bad header, CRC failure) the bytes after its
+	// first sync byte are scanned again, so a real packet that started
+	// inside the rejected one is not lost.
+	while (pos_)
+	{
+		if (buf_[0] != ADS1293StreamEncoder::SYNC1 || (pos_ > 1 && buf_[1] != ADS1293StreamEncoder::SYNC2))
+		{
+			resync();
+			continue;
+		}
+		if (pos_ < 4)
+			return;
+		if (!expected_)
+		{
+			const uint8_t channels = countChannels(buf_[2] & 0x07u);
+			expected_ = ADS1293StreamEncoder::packetSize(buf_[3], channels);
+			if ((buf_[2] >> 4) != ADS1293StreamEncoder::VERSION || channels == 0 || buf_[3] == 0 || expected_ > size_)
+			{
+				resync();
+				continue;
+			}
+		}
+		if (pos_ < expected_)
+			return;
+		if (dispatch())
+		{
+			pos_ = 0;
+			expected_ = 0;
+		}
+		else
+		{
+			resync();
+		}
+	}
+}
+
+void ADS1293StreamDecoder::resync()
+{
+	// drop the leading byte and everything up to the next possible sync
+	size_t next = 1;
+	while (next < pos_ && buf_[next] != ADS1293StreamEncoder::SYNC1)
+		++next;
+	pos_ -= next;
+	memmove(buf_, buf_ + next, pos_);
+	expected_ = 0;
+}
+
+bool ADS1293StreamDecoder::dispatch()
+{
+	const size_t payloadEnd = expected_ - ADS1293StreamEncoder::CRC_BYTES;
+	const uint16_t crc = static_cast<uint16_t>(buf_[payloadEnd] | (buf_[payloadEnd + 1] << 8));
+	if (ADS1293StreamEncoder::crc16(buf_ + 2, payloadEnd - 2) != crc)
+	{
+		++crcErrors_;
+		return false;
+	}
+
+	const uint8_t mask = buf_[2] & 0x07u;
+	const uint8_t count = buf_[3];
+	uint16_t seq = static_cast<uint16_t>(buf_[4] | (buf_[5] << 8));
+	if (haveSeq_ && seq != nextSeq_)
+		lost_ += static_cast<uint16_t>(seq - nextSeq_);
+	haveSeq_ = true;
+	nextSeq_ = static_cast<uint16_t>(seq + count);
+
+	const uint8_t *p = buf_ + ADS1293StreamEncoder::HEADER_BYTES;
+	for (uint8_t f = 0; f < count; ++f, ++seq)
+	{
+		ADS1293::Samples s;
+		int32_t *ch[3] = {&s.ch1, &s.ch2, &s.ch3};
+		for (uint8_t c = 0; c < 3; ++c)
+		{
+			if (!(mask & (1u << c)))
+				continue;
+			*ch[c] = ADS1293::signExtend24(static_cast<uint32_t>(p[0]) |
+										   (static_cast<uint32_t>(p[1]) << 8) |
+										   (static_cast<uint32_t>(p[2]) << 16));
+			p += 3;
+		}
+		s.ok = true;
+		++frames_;
+		if (handler_)
+			handler_(s, seq, ctx_);
+	}
+	return true;
+}
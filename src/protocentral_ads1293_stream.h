@@ -0,0 +1,124 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protocentral ADS1293 - compact binary streaming protocol
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//
+// Packs several ECG frames into one packet with 24-bit samples, a frame
+// sequence counter for drop detection and a CRC, and writes each packet with
+// a single Print::write() call. The decoder is plain C++ with no Arduino
+// dependencies beyond the library header, so the same file can be compiled
+// into host-side tools.
+//
+// Packet layout (multi-byte fields little-endian):
+//
+//   offset  size        field
+//   0       1           0xA5 sync
+//   1       1           0x5A sync
+//   2       1           bits 0..2: channel mask (ch1..ch3), bits 4..7: version (1)
+//   3       1           frame count N (1..255)
+//   4       2           sequence number of the first frame in the packet
+//   6       N*3*C       samples, frame by frame, channel by channel, 24-bit
+//                       two's complement (C = channels in the mask)
+//   6+N*3*C 2           CRC-16/CCITT-FALSE over bytes 2 .. end of samples
+//
+// Three channels at 16 frames per packet cost 9.5 bytes per frame (6.5 for
+// two-channel 3-lead data), against 19 bytes per frame for the OpenView
+// packet used in Example 3.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "protocentral_ads1293.h"
+
+class ADS1293StreamEncoder {
+public:
+  static constexpr uint8_t SYNC1 = 0xA5;
+  static constexpr uint8_t SYNC2 = 0x5A;
+  static constexpr uint8_t VERSION = 1;
+  static constexpr uint8_t HEADER_BYTES = 6;
+  static constexpr uint8_t CRC_BYTES = 2;
+
+  // Bytes needed for a packet of `frames` frames with `channels` channels.
+  static constexpr size_t packetSize(uint8_t frames, uint8_t channels)
+  {
+    return HEADER_BYTES + static_cast<size_t>(frames) * 3u * channels + CRC_BYTES;
+  }
+
+  // `buffer` holds one packet; its size sets the number of frames per packet
+  // (up to 255). `channelMask` selects which of ch1..ch3 are sent (bit 0 =
+  // ch1), e.g. 0x03 for 3-lead data.
+  ADS1293StreamEncoder(Print &out, uint8_t *buffer, size_t bufferSize, uint8_t channelMask = 0x07) noexcept;
+
+  // Append one frame. When the packet is full it is sent immediately.
+  // Returns false if the encoder has no usable buffer.
+  bool add(const ADS1293::Samples &s);
+
+  // Append a block of frames; returns the number accepted.
+  size_t add(const ADS1293::Samples *frames, size_t count);
+
+  // Send a partially filled packet, if any.
+  bool flush();
+
+  // Account for frames lost before they reached the encoder (for example
+  // the `missed` report from ADS1293::readFrames()). The sequence counter
+  // skips ahead so the decoder sees the gap. Flushes the pending packet
+  // first so sequence numbers stay contiguous within a packet.
+  void skipFrames(uint16_t count);
+
+  uint16_t sequence() const noexcept { return seq_; }
+  uint8_t framesPerPacket() const noexcept { return capacity_; }
+  uint32_t packetsSent() const noexcept { return packets_; }
+
+  // CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), shared with the decoder.
+  static uint16_t crc16(const uint8_t *data, size_t len, uint16_t crc = 0xFFFF) noexcept;
+
+private:
+  Print &out_;
+  uint8_t *buf_;
+  uint8_t mask_;
+  uint8_t channels_;
+  uint8_t capacity_ = 0;
+  uint8_t count_ = 0;
+  uint16_t seq_ = 0;   // sequence number of the next frame
+  uint32_t packets_ = 0;
+  size_t pos_ = HEADER_BYTES;
+};
+
+class ADS1293StreamDecoder {
+public:
+  // Called for each frame of a packet that passed the CRC check. `seq` is
+  // the frame's sequence number. Channels not present in the packet are 0.
+  typedef void (*FrameHandler)(const ADS1293::Samples &s, uint16_t seq, void *context);
+
+  // `buffer` must hold the largest packet expected (see
+  // ADS1293StreamEncoder::packetSize()).
+  ADS1293StreamDecoder(uint8_t *buffer, size_t bufferSize, FrameHandler handler, void *context = nullptr) noexcept;
+
+  // Feed received bytes in any chunking. After a corrupt or truncated
+  // packet, or sync bytes that turn out not to start one, the bytes
+  // received since are scanned again from the one after the false sync, so
+  // the next good packet is found even if it began inside the bad one.
+  void feed(uint8_t byte);
+  void feed(const uint8_t *data, size_t len);
+
+  uint32_t framesDecoded() const noexcept { return frames_; }
+  uint32_t framesLost() const noexcept { return lost_; }     // sequence gaps
+  uint32_t crcErrors() const noexcept { return crcErrors_; }
+
+private:
+  uint8_t *buf_;
+  size_t size_;
+  FrameHandler handler_;
+  void *ctx_;
+  size_t pos_ = 0;
+  size_t expected_ = 0;
+  bool haveSeq_ = false;
+  uint16_t nextSeq_ = 0;
+  uint32_t frames_ = 0;
+  uint32_t lost_ = 0;
+  uint32_t crcErrors_ = 0;
+
+  bool dispatch();
+  void resync();
+};
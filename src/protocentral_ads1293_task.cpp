@@ -0,0 +1,332 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protocentral ADS1293 - acquisition in a dedicated task
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include "protocentral_ads1293_task.h"
+
+#if ADS1293_TASK_BACKEND == ADS1293_TASK_PTHREAD
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
+bool ADS1293AcquisitionTask::start(ADS1293 &dev, ADS1293::Samples *ring, uint16_t depth)
+{
+	return start(dev, ring, depth, Config());
+}
+
+#if ADS1293_TASK_BACKEND == ADS1293_TASK_FREERTOS
+
+bool ADS1293AcquisitionTask::start(ADS1293 &dev, ADS1293::Samples *ring, uint16_t depth, const Config &cfg)
+{
+	if (dev_ || !ring)
+		return false;
+	if (!dataSem_)
+		dataSem_ = xSemaphoreCreateBinaryStatic(&dataSemBuf_);
+	if (!doneSem_)
+		doneSem_ = xSemaphoreCreateBinaryStatic(&doneSemBuf_);
+
+	dev_ = &dev;
+	stopping_ = false;
+	frames_ = 0;
+	readers_ = 0;
+	wasDeferred_ = dev.deferredReads();
+	const BaseType_t core = (cfg.core < 0 || cfg.core >= portNUM_PROCESSORS) ? tskNO_AFFINITY : cfg.core;
+	const UBaseType_t priority = cfg.priority < configMAX_PRIORITIES ? cfg.priority : configMAX_PRIORITIES - 1;
+	if (xTaskCreatePinnedToCore(taskMain, "ads1293", cfg.stackBytes, this, priority, &task_, core) != pdPASS)
+	{
+		task_ = nullptr;
+		dev_ = nullptr;
+		return false;
+	}
+	// The task exists before the interrupt can notify it.
+	if (!dev.setDeferredReads(true, onDataReady, this) || !dev.startAcquisition(ring, depth))
+	{
+		stop();
+		return false;
+	}
+	return true;
+}
+
+void ADS1293AcquisitionTask::stop()
+{
+	portENTER_CRITICAL(&mux_);
+	ADS1293 *dev = stopping_ ? nullptr : dev_;
+	stopping_ = true;
+	portEXIT_CRITICAL(&mux_);
+	if (!dev)
+		return;
+	// Let the task finish its read and exit, and wake readers until none is
+	// left inside read(). The notify hook stays installed until then, so
+	// their readFrames() calls only drain the ring and the task remains its
+	// only producer; acquisition stops and the caller's read mode comes
+	// back only after that.
+	xTaskNotifyGive(task_);
+	xSemaphoreTake(doneSem_, portMAX_DELAY);
+	task_ = nullptr;
+	for (;;)
+	{
+		portENTER_CRITICAL(&mux_);
+		const uint8_t readers = readers_;
+		portEXIT_CRITICAL(&mux_);
+		if (!readers)
+			break;
+		xSemaphoreGive(dataSem_);
+		vTaskDelay(1);
+	}
+	dev->stopAcquisition();
+	dev->setDeferredReads(wasDeferred_);
+	portENTER_CRITICAL(&mux_);
+	dev_ = nullptr;
+	portEXIT_CRITICAL(&mux_);
+}
+
+void IRAM_ATTR ADS1293AcquisitionTask::onDataReady(void *context)
+{
+	BaseType_t woken = pdFALSE;
+	vTaskNotifyGiveFromISR(static_cast<ADS1293AcquisitionTask *>(context)->task_, &woken);
+	if (woken)
+		portYIELD_FROM_ISR();
+}
+
+void ADS1293AcquisitionTask::taskMain(void *arg)
+{
+	static_cast<ADS1293AcquisitionTask *>(arg)->run();
+}
+
+void ADS1293AcquisitionTask::run()
+{
+	while (!stopping_)
+	{
+		// The timeout only bounds how long a lost notification could stall
+		// the task; normally it wakes once per DRDY edge.
+		if (!ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100)))
+			continue;
+		uint32_t n = 0;
+		while (dev_->serviceDataReady())
+			++n;
+		if (n)
+		{
+			frames_ = frames_ + n;
+			xSemaphoreGive(dataSem_);
+		}
+	}
+	xSemaphoreGive(doneSem_);
+	vTaskDelete(nullptr);
+}
+
+size_t ADS1293AcquisitionTask::read(ADS1293::Samples *out, size_t maxFrames, uint32_t timeoutMs, bool *missed)
+{
+	if (!out || maxFrames == 0)
+		return 0;
+	// Registered under the lock so stop() waits for this call to leave.
+	portENTER_CRITICAL(&mux_);
+	ADS1293 *dev = stopping_ ? nullptr : dev_;
+	if (dev)
+		++readers_;
+	portEXIT_CRITICAL(&mux_);
+	if (!dev)
+		return 0;
+
+	size_t n = dev->readFrames(out, maxFrames, missed);
+	// dataSem_ may still be given for frames already drained; retry until
+	// frames arrive, the time is up or the task stops.
+	const TickType_t start = xTaskGetTickCount();
+	const TickType_t limit = pdMS_TO_TICKS(timeoutMs);
+	while (!n && timeoutMs)
+	{
+		const TickType_t elapsed = xTaskGetTickCount() - start;
+		if (elapsed >= limit || xSemaphoreTake(dataSem_, limit - elapsed) != pdTRUE || stopping_)
+			break;
+		n = dev->readFrames(out, maxFrames, missed);
+	}
+
+	portENTER_CRITICAL(&mux_);
+	--readers_;
+	portEXIT_CRITICAL(&mux_);
+	return n;
+}
+
+uint32_t ADS1293AcquisitionTask::stackHighWater() const noexcept
+{
+	// ESP-IDF counts stack in bytes.
+	return task_ ? uxTaskGetStackHighWaterMark(task_) : 0;
+}
+
+#elif ADS1293_TASK_BACKEND == ADS1293_TASK_PTHREAD
+
+bool ADS1293AcquisitionTask::start(ADS1293 &dev, ADS1293::Samples *ring, uint16_t depth, const Config &cfg)
+{
+	if (dev_ || !ring)
+		return false;
+	dev_ = &dev;
+	stopping_ = false;
+	frames_ = 0;
+	edges_ = 0;
+	published_ = 0;
+	readers_ = 0;
+	wasDeferred_ = dev.deferredReads();
+	if (pthread_create(&thread_, nullptr, threadMain, this) != 0)
+	{
+		dev_ = nullptr;
+		return false;
+	}
+#if defined(__linux__)
+	// Best effort: pinning may be refused (e.g. restricted cpusets).
+	if (cfg.core >= 0)
+	{
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cfg.core, &set);
+		pthread_setaffinity_np(thread_, sizeof(set), &set);
+	}
+#else
+	(void)cfg;
+#endif
+	if (!dev.setDeferredReads(true, onDataReady, this) || !dev.startAcquisition(ring, depth))
+	{
+		stop();
+		return false;
+	}
+	return true;
+}
+
+void ADS1293AcquisitionTask::stop()
+{
+	// As on FreeRTOS: the notify hook stays installed until the thread has
+	// exited and no reader is left inside read(), so nothing but the thread
+	// ever services DRDY or pushes to the ring.
+	pthread_mutex_lock(&lock_);
+	ADS1293 *dev = stopping_ ? nullptr : dev_;
+	stopping_ = true;
+	pthread_cond_signal(&edgeCond_);
+	pthread_cond_broadcast(&dataCond_);
+	pthread_mutex_unlock(&lock_);
+	if (!dev)
+		return;
+	pthread_join(thread_, nullptr);
+	pthread_mutex_lock(&lock_);
+	while (readers_)
+		pthread_cond_wait(&dataCond_, &lock_);
+	pthread_mutex_unlock(&lock_);
+	dev->stopAcquisition();
+	dev->setDeferredReads(wasDeferred_);
+	pthread_mutex_lock(&lock_);
+	dev_ = nullptr;
+	pthread_mutex_unlock(&lock_);
+}
+
+void ADS1293AcquisitionTask::onDataReady(void *context)
+{
+	ADS1293AcquisitionTask *self = static_cast<ADS1293AcquisitionTask *>(context);
+	pthread_mutex_lock(&self->lock_);
+	++self->edges_;
+	pthread_cond_signal(&self->edgeCond_);
+	pthread_mutex_unlock(&self->lock_);
+}
+
+void *ADS1293AcquisitionTask::threadMain(void *arg)
+{
+	static_cast<ADS1293AcquisitionTask *>(arg)->run();
+	return nullptr;
+}
+
+void ADS1293AcquisitionTask::run()
+{
+	pthread_mutex_lock(&lock_);
+	for (;;)
+	{
+		while (edges_ == 0 && !stopping_)
+			pthread_cond_wait(&edgeCond_, &lock_);
+		if (stopping_)
+			break;
+		edges_ = 0;
+		pthread_mutex_unlock(&lock_);
+		uint32_t n = 0;
+		while (dev_->serviceDataReady())
+			++n;
+		pthread_mutex_lock(&lock_);
+		if (n)
+		{
+			frames_ = frames_ + n;
+			published_ += n;
+			pthread_cond_broadcast(&dataCond_);
+		}
+	}
+	pthread_mutex_unlock(&lock_);
+}
+
+size_t ADS1293AcquisitionTask::read(ADS1293::Samples *out, size_t maxFrames, uint32_t timeoutMs, bool *missed)
+{
+	if (!out || maxFrames == 0)
+		return 0;
+	pthread_mutex_lock(&lock_);
+	ADS1293 *dev = stopping_ ? nullptr : dev_;
+	if (dev)
+		++readers_;
+	const uint32_t seen = published_;
+	pthread_mutex_unlock(&lock_);
+	if (!dev)
+		return 0;
+	size_t n = dev->readFrames(out, maxFrames, missed);
+	if (!n && timeoutMs)
+		n = waitAndRead(dev, seen, out, maxFrames, timeoutMs, missed);
+
+	pthread_mutex_lock(&lock_);
+	if (--readers_ == 0 && stopping_)
+		pthread_cond_broadcast(&dataCond_); // stop() waits for the last reader
+	pthread_mutex_unlock(&lock_);
+	return n;
+}
+
+size_t ADS1293AcquisitionTask::waitAndRead(ADS1293 *dev, uint32_t seen, ADS1293::Samples *out, size_t maxFrames,
+										   uint32_t timeoutMs, bool *missed)
+{
+	timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += timeoutMs / 1000u;
+	deadline.tv_nsec += static_cast<long>(timeoutMs % 1000u) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000L)
+	{
+		++deadline.tv_sec;
+		deadline.tv_nsec -= 1000000000L;
+	}
+	pthread_mutex_lock(&lock_);
+	while (published_ == seen && !stopping_)
+		if (pthread_cond_timedwait(&dataCond_, &lock_, &deadline) == ETIMEDOUT)
+			break;
+	const bool stopping = stopping_;
+	pthread_mutex_unlock(&lock_);
+	return stopping ? 0 : dev->readFrames(out, maxFrames, missed);
+}
+
+uint32_t ADS1293AcquisitionTask::stackHighWater() const noexcept
+{
+	return 0;
+}
+
+#else
+
+bool ADS1293AcquisitionTask::start(ADS1293 &, ADS1293::Samples *, uint16_t, const Config &)
+{
+	return false;
+}
+
+void ADS1293AcquisitionTask::stop()
+{
+}
+
+size_t ADS1293AcquisitionTask::read(ADS1293::Samples *, size_t, uint32_t, bool *)
+{
+	return 0;
+}
+
+uint32_t ADS1293AcquisitionTask::stackHighWater() const noexcept
+{
+	return 0;
+}
+
+#endif
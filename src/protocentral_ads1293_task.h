@@ -0,0 +1,149 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Protocentral ADS1293 - acquisition in a dedicated task
+// https://github.com/Protocentral/protocentral-ads1293-arduino
+// Copyright (c) 2020 ProtoCentral
+// Licensed under the MIT License
+//
+// ADS1293AcquisitionTask moves DRDY handling and the SPI reads off loop()
+// into a high-priority task, pinned to one core on ESP32, so acquisition at
+// 1600 SPS keeps running while the other core handles WiFi, BLE or serial.
+//
+//   DRDY interrupt --notify--> acquisition task --ring--> consumer task(s)
+//
+// The interrupt only records the edge and wakes the task (deferred reads,
+// see ADS1293::setDeferredReads). The task reads the frame and pushes it
+// into the device's acquisition ring, a single-producer/single-consumer
+// queue with acquire/release indices and no locks; consumers drain it with
+// read(), which can block until frames arrive. queueHighWater() shows how
+// close the ring came to overflowing; size the ring so it stays well below
+// the depth during the longest consumer stall.
+//
+// Backends: FreeRTOS on ESP32 (the task is pinned with
+// xTaskCreatePinnedToCore), POSIX threads on Linux and macOS hosts, where a
+// test harness drives ADS1293::handleDataReady() in place of the interrupt.
+// Other targets have no backend and start() returns false. Define
+// ADS1293_TASK_BACKEND to choose explicitly.
+//
+// While the task runs it owns the bus: do not read or write device
+// registers from other tasks. Configure the device before start().
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "protocentral_ads1293.h"
+
+#define ADS1293_TASK_NONE 0
+#define ADS1293_TASK_FREERTOS 1
+#define ADS1293_TASK_PTHREAD 2
+
+#ifndef ADS1293_TASK_BACKEND
+#if defined(ARDUINO_ARCH_ESP32)
+#define ADS1293_TASK_BACKEND ADS1293_TASK_FREERTOS
+#elif defined(__linux__) || defined(__APPLE__)
+#define ADS1293_TASK_BACKEND ADS1293_TASK_PTHREAD
+#else
+#define ADS1293_TASK_BACKEND ADS1293_TASK_NONE
+#endif
+#endif
+
+#if ADS1293_TASK_BACKEND == ADS1293_TASK_FREERTOS
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#elif ADS1293_TASK_BACKEND == ADS1293_TASK_PTHREAD
+#include <pthread.h>
+#endif
+
+class ADS1293AcquisitionTask {
+public:
+  struct Config {
+    // Core the acquisition task is pinned to; -1 (or a core the chip does
+    // not have) = no pinning. Arduino-ESP32 runs loop() on core 1 and WiFi
+    // on core 0 by default; pick the one the sketch keeps free of heavy work.
+    int8_t core = 1;
+    // FreeRTOS priority (0..configMAX_PRIORITIES-1) and stack. On pthread
+    // hosts the thread keeps the default scheduling and stack.
+    uint8_t priority = 20;
+    uint16_t stackBytes = 4096;
+  };
+
+  ADS1293AcquisitionTask() noexcept = default;
+  ~ADS1293AcquisitionTask() { stop(); }
+  ADS1293AcquisitionTask(const ADS1293AcquisitionTask &) = delete;
+  ADS1293AcquisitionTask &operator=(const ADS1293AcquisitionTask &) = delete;
+
+  // Start acquisition on `dev` into `ring` (`depth` a power of two, as for
+  // startAcquisition) and create the task. Returns false if already
+  // running, there is no backend, or the task or interrupt cannot be set up.
+  bool start(ADS1293 &dev, ADS1293::Samples *ring, uint16_t depth);
+  bool start(ADS1293 &dev, ADS1293::Samples *ring, uint16_t depth, const Config &cfg);
+
+  // Stop the task and acquisition and restore the device's read mode.
+  // Readers blocked in read() return 0; stop() waits until they have left.
+  void stop();
+  bool running() const noexcept { return dev_ != nullptr; }
+
+  // Consumer side, from one task at a time: copy up to maxFrames frames
+  // (oldest first), waiting up to timeoutMs for the first one. `missed` as
+  // for ADS1293::readFrames().
+  size_t read(ADS1293::Samples *out, size_t maxFrames, uint32_t timeoutMs = 0, bool *missed = nullptr);
+  size_t available() const noexcept
+  {
+    const ADS1293 *dev = dev_;
+    return dev ? dev->available() : 0;
+  }
+
+  // Frames read by the task, edges lost because the task fell behind (the
+  // data registers hold only the newest frame) plus ring overflows, and
+  // the deepest ring fill level, in frames.
+  uint32_t framesAcquired() const noexcept { return frames_; }
+  uint32_t framesDropped() const noexcept
+  {
+    const ADS1293 *dev = dev_;
+    return dev ? dev->overrunCount() : 0;
+  }
+  uint16_t queueHighWater() const noexcept
+  {
+    const ADS1293 *dev = dev_;
+    return dev ? dev->ringHighWater() : 0;
+  }
+  void resetQueueHighWater() noexcept
+  {
+    ADS1293 *dev = dev_;
+    if (dev)
+      dev->resetRingHighWater();
+  }
+
+  // Least free stack the task has had, in bytes (FreeRTOS only, else 0).
+  uint32_t stackHighWater() const noexcept;
+
+private:
+  ADS1293 *volatile dev_ = nullptr;
+  volatile bool stopping_ = false;
+  volatile uint32_t frames_ = 0;
+  bool wasDeferred_ = false;
+  uint8_t readers_ = 0; // callers inside read(), under the lock
+
+#if ADS1293_TASK_BACKEND == ADS1293_TASK_FREERTOS
+  TaskHandle_t task_ = nullptr;
+  SemaphoreHandle_t dataSem_ = nullptr; // given per frame, for read()
+  SemaphoreHandle_t doneSem_ = nullptr; // given by the task on exit
+  StaticSemaphore_t dataSemBuf_;
+  StaticSemaphore_t doneSemBuf_;
+  portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED; // dev_, stopping_, readers_
+  static void taskMain(void *arg);
+#elif ADS1293_TASK_BACKEND == ADS1293_TASK_PTHREAD
+  pthread_t thread_;
+  pthread_mutex_t lock_ = PTHREAD_MUTEX_INITIALIZER;
+  pthread_cond_t edgeCond_ = PTHREAD_COND_INITIALIZER; // DRDY -> task
+  pthread_cond_t dataCond_ = PTHREAD_COND_INITIALIZER; // task -> read()
+  uint32_t edges_ = 0;
+  uint32_t published_ = 0;
+  static void *threadMain(void *arg);
+  size_t waitAndRead(ADS1293 *dev, uint32_t seen, ADS1293::Samples *out, size_t maxFrames, uint32_t timeoutMs,
+                     bool *missed);
+#endif
+
+  static void onDataReady(void *context);
+  void run();
+};